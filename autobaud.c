@@ -0,0 +1,134 @@
+/******************************************************************************
+ * Auto-baud bit-time estimator
+ *
+ * See autobaud.h.
+ *
+ *******************************************************************************/
+#include "autobaud.h"
+
+/* 0x55 framed 8N1: start, 1,0,1,0,1,0,1,0, stop */
+#define AUTOBAUD_SYNC_EDGES     10
+
+static const uint32_t standardRates[] =
+{
+    1200, 2400, 4800, 9600, 14400, 19200, 38400, 57600, 115200, 230400,
+    250000, 460800, 500000, 921600, 1000000, 2000000, 3000000
+};
+
+void autobaud_reset(AutoBaud *ab)
+{
+    ab->edges = 0;
+}
+
+uint32_t autobaud_edge(AutoBaud *ab, uint16_t timestamp)
+{
+    uint32_t total = 0;
+    uint32_t mean;
+    uint_fast8_t n;
+
+    if(ab->edges >= AUTOBAUD_MAX_EDGES)
+        return 0;
+
+    if(ab->edges != 0)
+        ab->run[ab->edges - 1] = (uint16_t)(timestamp - ab->last);
+    ab->last = timestamp;
+
+    if(++ab->edges != AUTOBAUD_SYNC_EDGES)
+        return 0;
+
+    for(n = 0; n < AUTOBAUD_SYNC_EDGES - 1; n++)
+        total += ab->run[n];
+    mean = total / (AUTOBAUD_SYNC_EDGES - 1);
+
+    for(n = 0; n < AUTOBAUD_SYNC_EDGES - 1; n++)
+    {
+        uint32_t d = ab->run[n] > mean ? ab->run[n] - mean : mean - ab->run[n];
+
+        if(d * AUTOBAUD_SYNC_TOLERANCE > mean)
+            return 0;
+    }
+
+    return (total << 8) / (AUTOBAUD_SYNC_EDGES - 1);
+}
+
+/* Rounds every run to whole bits of bitTicks (24.8) and returns the total
+ * time divided by the total bit count, again in 24.8 */
+static uint32_t autobaud_fit(const AutoBaud *ab, uint_fast8_t runs,
+                             uint32_t bitTicks)
+{
+    uint32_t total = 0;
+    uint32_t bits = 0;
+    uint_fast8_t n;
+
+    for(n = 0; n < runs; n++)
+    {
+        uint32_t k = (((uint32_t)ab->run[n] << 8) + bitTicks / 2) / bitTicks;
+
+        /* No 8N1 run of equal levels is longer than nine bits, except idle
+         * between characters, which carries no timing and is skipped */
+        if(k == 0 || k > 9)
+            continue;
+        total += ab->run[n];
+        bits += k;
+    }
+
+    return bits ? (total << 8) / bits : 0;
+}
+
+uint32_t autobaud_estimate(const AutoBaud *ab)
+{
+    uint_fast8_t runs = ab->edges ? ab->edges - 1 : 0;
+    uint32_t shortest = 0xFFFF;
+    uint32_t bitTicks;
+    uint32_t total;
+    uint32_t ones;
+    uint_fast8_t n;
+
+    for(n = 0; n < runs; n++)
+    {
+        if(ab->run[n] < shortest)
+            shortest = ab->run[n];
+    }
+    if(runs == 0 || shortest == 0)
+        return 0;
+
+    /* The shortest run is one bit give or take the jitter, and so is every
+     * run up to half as long again: their mean is the first guess. A
+     * second pass against the fitted estimate fixes runs that first
+     * rounded wrongly. */
+    total = 0;
+    ones = 0;
+    for(n = 0; n < runs; n++)
+    {
+        if(2 * (uint32_t)ab->run[n] < 3 * shortest)
+        {
+            total += ab->run[n];
+            ones++;
+        }
+    }
+
+    bitTicks = autobaud_fit(ab, runs, (total << 8) / ones);
+    return bitTicks ? autobaud_fit(ab, runs, bitTicks) : 0;
+}
+
+uint32_t autobaud_toBaud(uint32_t timerHz, uint32_t bitTicks)
+{
+    uint32_t baud;
+    uint_fast8_t n;
+
+    if(bitTicks == 0)
+        return 0;
+
+    baud = (uint32_t)((((uint64_t)timerHz << 8) + bitTicks / 2) / bitTicks);
+
+    for(n = 0; n < sizeof(standardRates) / sizeof(standardRates[0]); n++)
+    {
+        uint32_t rate = standardRates[n];
+        uint32_t d = baud > rate ? baud - rate : rate - baud;
+
+        if(d * AUTOBAUD_SNAP_TOLERANCE <= rate)
+            return rate;
+    }
+
+    return baud;
+}
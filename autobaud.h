@@ -0,0 +1,70 @@
+/******************************************************************************
+ * Auto-baud bit-time estimator
+ *
+ * Description: Recovers the bit time of an incoming UART stream from the
+ * timestamps of its RX line edges. Two ways to lock:
+ *
+ *  - Sync byte: 0x55 ('U') is sent as ten alternating bits, start to stop,
+ *    i.e. ten edges one bit apart. As soon as ten edges with consistent
+ *    spacing have been seen the bit time is (t9 - t0) / 9, averaging away
+ *    most of the timestamp jitter. Locks within one character.
+ *
+ *  - Any traffic: when the edge buffer fills or the line goes idle, the
+ *    mean of the intervals within half again of the shortest, the
+ *    single-bit runs, is taken as a first guess, every interval is
+ *    rounded to a whole number of such bits and the total time is divided
+ *    by the total bit count. Needs at least one single-bit run, which one
+ *    or two ordinary characters nearly always contain.
+ *
+ * Timestamps are 16-bit timer counts; only differences are used, so the
+ * timer may wrap freely as long as no single run of equal bits (up to nine
+ * for 8N1) is longer than 65535 ticks.
+ *
+ * Portable: no driverlib, the MSP432 edge capture lives in uart_autobaud.c.
+ *
+ *******************************************************************************/
+#ifndef AUTOBAUD_H_
+#define AUTOBAUD_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Edges kept for the generic estimate; two characters' worth */
+#define AUTOBAUD_MAX_EDGES      20
+
+/* Sync-byte intervals must lie within 1/AUTOBAUD_SYNC_TOLERANCE of the
+ * mean to count as 0x55 */
+#define AUTOBAUD_SYNC_TOLERANCE 5
+
+/* Snap to a standard rate within 1/AUTOBAUD_SNAP_TOLERANCE */
+#define AUTOBAUD_SNAP_TOLERANCE 33
+
+typedef struct
+{
+    uint16_t last;                  /* Timestamp of the latest edge        */
+    uint8_t  edges;                 /* Edges seen since reset              */
+    uint16_t run[AUTOBAUD_MAX_EDGES - 1];
+} AutoBaud;
+
+extern void autobaud_reset(AutoBaud *ab);
+
+/* Feeds one edge (the first must be the falling start-bit edge). Returns
+ * the bit time in 24.8 fixed-point ticks once a sync byte has been
+ * recognised, 0 otherwise. */
+extern uint32_t autobaud_edge(AutoBaud *ab, uint16_t timestamp);
+
+/* True once the edge buffer is full and autobaud_estimate() should run */
+static inline bool autobaud_full(const AutoBaud *ab)
+{
+    return ab->edges >= AUTOBAUD_MAX_EDGES;
+}
+
+/* Generic estimate from whatever edges have been collected. Returns the bit
+ * time in 24.8 fixed-point ticks, or 0 if the edges are inconsistent. */
+extern uint32_t autobaud_estimate(const AutoBaud *ab);
+
+/* Converts a 24.8 bit time to a baud rate, snapped to the nearest standard
+ * rate if one is close enough. */
+extern uint32_t autobaud_toBaud(uint32_t timerHz, uint32_t bitTicks);
+
+#endif /* AUTOBAUD_H_ */
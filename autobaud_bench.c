@@ -0,0 +1,250 @@
+/******************************************************************************
+ * Auto-baud estimator - host simulation
+ *
+ * Description: Feeds autobaud.c the edge timestamps of simulated RX
+ * traffic, the way uart_autobaud.c does, and prints one CSV line per
+ * source, rate and jitter case:
+ *
+ *     source,baud,jitter,trials,right,wrong,rejected
+ *
+ * Timestamps are a 16-bit timer at BENCH_TIMER_HZ, as Timer_A3 from SMCLK,
+ * read by an edge ISR whose latency varies by up to jitter ticks. Every
+ * trial starts at a random timer count and, as uart_autobaud.c, takes
+ * the bit time from autobaud_edge() as soon as it returns one, or from
+ * autobaud_estimate() once the edge buffer is full, turns it into a rate
+ * with autobaud_toBaud() and the divisors with uart_baud_compute(). right
+ * counts trials that end on the rate sent and its divisors, wrong those
+ * that end on anything else, rejected those left without a rate, for
+ * which the driver would start over. The sources:
+ *
+ *     sync       0x55 then random bytes: must lock on the 0x55
+ *     traffic    random bytes other than 0x55, back to back: must lock
+ *                from the estimate
+ *     notsync    as traffic, but only autobaud_edge() is asked: a sync
+ *                lock here is wrong
+ *     glitch     0x55 with one edge repeated, as a bounce would: both
+ *                autobaud_edge() and autobaud_estimate() must reject it
+ *
+ * wrong must be 0 wherever jitter stays within the fifth of a bit of
+ * interval error the sync check allows (AUTOBAUD_SYNC_TOLERANCE); beyond
+ * it most 0x55 are rejected, which the driver retries on the next
+ * character. The 460800/24 and 1000000/12 sync cases go on to half a bit
+ * to show what is left: the odd 0x55 that still passes can average more
+ * than the snap window off and locks on the unsnapped rate, as a
+ * non-standard sender would.
+ *
+ * Host only: the target build sees an empty file. Build and run with:
+ *
+ *     cc -std=gnu11 -O2 -I. autobaud_bench.c autobaud.c uart_baud.c \
+ *        -o autobaud_bench
+ *     ./autobaud_bench
+ *
+ *******************************************************************************/
+#ifndef __MSP432P401R__
+
+#include <stdio.h>
+
+#include "autobaud.h"
+#include "uart_baud.h"
+
+#define BENCH_TIMER_HZ      24000000
+#define BENCH_TRIALS        1000
+
+/* Characters generated per trial, more than the edge buffer needs */
+#define BENCH_CHARS         AUTOBAUD_MAX_EDGES
+
+#define BENCH_MAX_EDGES     (BENCH_CHARS * 10)
+
+typedef enum
+{
+    SOURCE_SYNC,
+    SOURCE_TRAFFIC,
+    SOURCE_NOTSYNC,
+    SOURCE_GLITCH
+} AutoBaudBench_Source;
+
+static const char *const sourceNames[] = { "sync", "traffic", "notsync",
+                                           "glitch" };
+
+typedef struct
+{
+    AutoBaudBench_Source source;
+    uint32_t baud;
+    uint32_t jitter;                /* ISR latency spread, ticks         */
+} AutoBaudBench_Case;
+
+static const AutoBaudBench_Case cases[] =
+{
+    { SOURCE_SYNC, 9600, 0 },
+    { SOURCE_SYNC, 9600, 24 },
+    { SOURCE_SYNC, 57600, 24 },
+    { SOURCE_SYNC, 115200, 0 },
+    { SOURCE_SYNC, 115200, 24 },
+    { SOURCE_SYNC, 460800, 4 },
+    { SOURCE_SYNC, 460800, 24 },
+    { SOURCE_SYNC, 1000000, 0 },
+    { SOURCE_SYNC, 1000000, 4 },
+    { SOURCE_SYNC, 1000000, 12 },
+    { SOURCE_TRAFFIC, 9600, 24 },
+    { SOURCE_TRAFFIC, 57600, 24 },
+    { SOURCE_TRAFFIC, 115200, 0 },
+    { SOURCE_TRAFFIC, 115200, 24 },
+    { SOURCE_TRAFFIC, 460800, 4 },
+    { SOURCE_TRAFFIC, 1000000, 0 },
+    { SOURCE_TRAFFIC, 1000000, 4 },
+    { SOURCE_NOTSYNC, 9600, 0 },
+    { SOURCE_NOTSYNC, 115200, 24 },
+    { SOURCE_NOTSYNC, 1000000, 4 },
+    { SOURCE_GLITCH, 115200, 0 },
+    { SOURCE_GLITCH, 1000000, 4 },
+};
+
+static uint32_t rng = 0x2545F491;
+
+static uint32_t bench_random(void)
+{
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return rng;
+}
+
+/* Timestamps of the edges of BENCH_CHARS back-to-back 8N1 characters,
+ * the first one first if not negative. Returns the edge count. */
+static uint_fast16_t bench_edges(uint16_t *edges, uint32_t baud,
+                                 uint32_t jitter, int first)
+{
+    /* Bit time in 24.8 ticks */
+    uint64_t bit = (((uint64_t)BENCH_TIMER_HZ << 8) + baud / 2) / baud;
+    uint64_t t = (uint64_t)(bench_random() & 0xFFFF) << 8;
+    uint_fast16_t count = 0;
+    bool level = true;
+    uint_fast8_t c;
+    uint_fast8_t k;
+
+    for(c = 0; c < BENCH_CHARS; c++)
+    {
+        uint16_t frame;
+        uint8_t byte;
+
+        if(c == 0 && first >= 0)
+            byte = (uint8_t)first;
+        else
+            do
+                byte = (uint8_t)bench_random();
+            while(first < 0 && byte == 0x55);
+
+        frame = (uint16_t)(byte << 1 | 0x200);
+        for(k = 0; k < 10; k++, frame >>= 1)
+        {
+            if((frame & 1) != level)
+            {
+                edges[count++] = (uint16_t)((t + k * bit) >> 8) +
+                                 (uint16_t)(bench_random() % (jitter + 1));
+                level = !level;
+            }
+        }
+        t += 10 * bit;
+    }
+
+    return count;
+}
+
+/* Turns a bit time into a rate and its divisors as uart_autobaud_lock()
+ * does: 1 if that is baud with its divisors, 0 if another rate, -1 if
+ * none */
+static int bench_lock(uint32_t bitTicks, uint32_t baud)
+{
+    UartBaud_Divisors div;
+    UartBaud_Divisors want;
+    uint32_t got = autobaud_toBaud(BENCH_TIMER_HZ, bitTicks);
+
+    if(!bitTicks || !uart_baud_compute(BENCH_TIMER_HZ, got, &div))
+        return -1;
+
+    uart_baud_compute(BENCH_TIMER_HZ, baud, &want);
+    return got == baud && div.brdiv == want.brdiv && div.brf == want.brf &&
+           div.brs == want.brs && div.overSampling == want.overSampling;
+}
+
+/* One trial, fed and judged as the case's source asks */
+static int bench_trial(const AutoBaudBench_Case *c)
+{
+    static uint16_t edges[BENCH_MAX_EDGES];
+    AutoBaud ab;
+    uint_fast16_t count;
+    uint_fast16_t n;
+    int estimate;
+
+    switch(c->source)
+    {
+    case SOURCE_SYNC:
+        count = bench_edges(edges, c->baud, c->jitter, 0x55);
+        break;
+
+    case SOURCE_GLITCH:
+        count = bench_edges(edges, c->baud, c->jitter, 0x55);
+        n = 1 + bench_random() % 8;
+        edges[n] = edges[n - 1];
+        break;
+
+    default:
+        count = bench_edges(edges, c->baud, c->jitter, -1);
+        break;
+    }
+
+    autobaud_reset(&ab);
+    for(n = 0; n < count; n++)
+    {
+        uint32_t bitTicks = autobaud_edge(&ab, edges[n]);
+
+        if(bitTicks)
+            return bench_lock(bitTicks, c->baud);
+        if(autobaud_full(&ab))
+            break;
+    }
+
+    switch(c->source)
+    {
+    case SOURCE_TRAFFIC:
+        return bench_lock(autobaud_estimate(&ab), c->baud);
+
+    case SOURCE_GLITCH:
+        /* The estimate must not take it either */
+        estimate = bench_lock(autobaud_estimate(&ab), c->baud);
+        return estimate < 0 ? -1 : 0;
+
+    default:
+        return -1;
+    }
+}
+
+int main(void)
+{
+    uint_fast8_t k;
+
+    printf("source,baud,jitter,trials,right,wrong,rejected\n");
+    for(k = 0; k < sizeof(cases) / sizeof(cases[0]); k++)
+    {
+        const AutoBaudBench_Case *c = &cases[k];
+        uint32_t count[3] = { 0, 0, 0 };
+        uint32_t n;
+
+        for(n = 0; n < BENCH_TRIALS; n++)
+            count[bench_trial(c) + 1]++;
+
+        /* A sync lock on anything but 0x55 is wrong whatever the rate */
+        if(c->source == SOURCE_NOTSYNC)
+        {
+            count[1] += count[2];
+            count[2] = 0;
+        }
+
+        printf("%s,%u,%u,%u,%u,%u,%u\n", sourceNames[c->source], c->baud,
+               c->jitter, BENCH_TRIALS, count[2], count[1], count[0]);
+    }
+
+    return 0;
+}
+
+#endif /* __MSP432P401R__ */
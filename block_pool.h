@@ -0,0 +1,223 @@
+/******************************************************************************
+ * Fixed-block memory pool
+ *
+ * Description: A pool of equal-sized byte blocks carved out of one static
+ * array, for buffers whose ownership moves between drivers (see bridge.h)
+ * where there is no heap: msp432p401r.cmd leaves --heap_size unset. The
+ * block count, block size and number of channels are compile-time
+ * constants of BLOCK_POOL_DEFINE(), so the pool's RAM is fixed at link
+ * time.
+ *
+ * A block is taken with block_pool_alloc() and returned with
+ * block_pool_free() by whoever owns it at the time, from thread mode or
+ * any ISR. Both are O(1) and lock-free: no interrupt is masked, an update
+ * cut short by a preempting context is simply retried.
+ *
+ * Channels: every alloc and free names the channel (a port, a route) the
+ * block is charged to. A channel is refused blocks beyond its quota, so a
+ * busy one cannot starve the rest; block_pool_setQuota() sets it, the
+ * whole pool by default. In-use counts and peaks are kept per channel and
+ * for the pool, for sizing the pool from a real run.
+ *
+ * The free blocks form a stack linked through next[], one byte per block,
+ * so a pool holds at most 254 blocks. The stack head carries a tag bumped
+ * by every push and pop, so a pop that was preempted by a pop and a push
+ * of the same block fails its compare-and-swap instead of corrupting the
+ * list.
+ *
+ * On the target the blocks go to their own .blockpool section, placed in
+ * SRAM_DATA by msp432p401r.cmd, so the link map shows the pool size on its
+ * own. The section is not zeroed at startup: block_pool_init() sets up all
+ * the state that matters.
+ *
+ *******************************************************************************/
+#ifndef BLOCK_POOL_H_
+#define BLOCK_POOL_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __MSP432P401R__
+#define BLOCK_POOL_SECTION  __attribute__((section(".blockpool"), aligned(4)))
+#else
+#define BLOCK_POOL_SECTION  __attribute__((aligned(4)))
+#endif
+
+/* Empty free list */
+#define BLOCK_POOL_END      0xFF
+
+typedef struct
+{
+    volatile uint32_t used;
+    volatile uint32_t peak;
+    uint8_t quota;
+} BlockPool_Channel;
+
+typedef struct
+{
+    uint8_t *storage;
+    uint8_t *next;                  /* Free list link of each block      */
+    BlockPool_Channel *channel;
+    volatile uint32_t head;         /* Tag << 8 | first free block       */
+    volatile uint32_t used;
+    volatile uint32_t peak;
+    uint16_t blockSize;
+    uint8_t blocks;
+    uint8_t channels;
+} BlockPool;
+
+/* Defines a pool of count blocks of size bytes shared by chans channels,
+ * with static storage. Call block_pool_init() before the first alloc. */
+#define BLOCK_POOL_DEFINE(name, count, size, chans)                           \
+    _Static_assert((count) > 0 && (count) < BLOCK_POOL_END,                   \
+                   #name ": 1 to 254 blocks");                                \
+    _Static_assert((size) > 0 && (size) <= 65535,                             \
+                   #name ": block size 1 to 65535 bytes");                    \
+    _Static_assert((chans) > 0 && (chans) <= 255,                             \
+                   #name ": 1 to 255 channels");                              \
+    static uint8_t name##_storage[(count) * (size)] BLOCK_POOL_SECTION;       \
+    static uint8_t name##_next[count];                                        \
+    static BlockPool_Channel name##_channel[chans];                           \
+    BlockPool name = { name##_storage, name##_next, name##_channel,           \
+                       BLOCK_POOL_END, 0, 0, (size), (count), (chans) }
+
+/* Sets *word to desired if it still holds expected. May fail spuriously
+ * on the target, where an interrupt between the load and the store
+ * clears the exclusive monitor; callers loop. */
+static inline bool block_pool_cas(volatile uint32_t *word, uint32_t expected,
+                                  uint32_t desired)
+{
+#if defined(__TI_COMPILER_VERSION__) && !defined(__clang__)
+    if(__ldrex((void *)word) != expected)
+        return false;
+    return __strex(desired, (void *)word) == 0;
+#else
+    return __atomic_compare_exchange_n(word, &expected, desired, false,
+                                       __ATOMIC_SEQ_CST, __ATOMIC_RELAXED);
+#endif
+}
+
+static inline void block_pool_raise(volatile uint32_t *peak, uint32_t level)
+{
+    uint32_t seen;
+
+    while((seen = *peak) < level && !block_pool_cas(peak, seen, level))
+        ;
+}
+
+/* Adds delta to *count, unless the result would exceed limit. Returns the
+ * new count, 0 if refused. */
+static inline uint32_t block_pool_count(volatile uint32_t *count,
+                                        int32_t delta, uint32_t limit)
+{
+    uint32_t now;
+
+    do
+    {
+        now = *count;
+        if(delta > 0 && now >= limit)
+            return 0;
+    } while(!block_pool_cas(count, now, now + (uint32_t)delta));
+
+    return now + (uint32_t)delta;
+}
+
+/* Marks every block free, sets every quota to the whole pool and clears
+ * the statistics. Not safe while the pool is in use. */
+static inline void block_pool_init(BlockPool *pool)
+{
+    uint_fast8_t n;
+
+    for(n = 0; n < pool->blocks; n++)
+        pool->next[n] = (uint8_t)(n + 1 < pool->blocks ? n + 1 : BLOCK_POOL_END);
+    pool->head = 0;
+    pool->used = 0;
+    pool->peak = 0;
+
+    for(n = 0; n < pool->channels; n++)
+    {
+        pool->channel[n].used = 0;
+        pool->channel[n].peak = 0;
+        pool->channel[n].quota = pool->blocks;
+    }
+}
+
+/* Most blocks channel may hold at once */
+static inline void block_pool_setQuota(BlockPool *pool, uint_fast8_t channel,
+                                       uint8_t quota)
+{
+    pool->channel[channel].quota = quota;
+}
+
+/* Returns a block of pool->blockSize bytes charged to channel, or NULL if
+ * the channel is at its quota or the pool is empty */
+static inline uint8_t *block_pool_alloc(BlockPool *pool, uint_fast8_t channel)
+{
+    BlockPool_Channel *ch = &pool->channel[channel];
+    uint32_t head;
+    uint32_t index;
+    uint32_t chUsed;
+
+    chUsed = block_pool_count(&ch->used, 1, ch->quota);
+    if(chUsed == 0)
+        return 0;
+
+    do
+    {
+        head = pool->head;
+        index = head & 0xFF;
+        if(index == BLOCK_POOL_END)
+        {
+            block_pool_count(&ch->used, -1, 0);
+            return 0;
+        }
+    } while(!block_pool_cas(&pool->head, head,
+                            ((head + 0x100) & ~0xFFu) | pool->next[index]));
+
+    block_pool_raise(&ch->peak, chUsed);
+    block_pool_raise(&pool->peak, block_pool_count(&pool->used, 1, UINT32_MAX));
+    return pool->storage + index * pool->blockSize;
+}
+
+/* Returns a block taken from the same pool for the same channel */
+static inline void block_pool_free(BlockPool *pool, uint_fast8_t channel,
+                                   uint8_t *block)
+{
+    uint32_t index = (uint32_t)(block - pool->storage) / pool->blockSize;
+    uint32_t head;
+
+    do
+    {
+        head = pool->head;
+        pool->next[index] = (uint8_t)head;
+    } while(!block_pool_cas(&pool->head, head,
+                            ((head + 0x100) & ~0xFFu) | index));
+
+    block_pool_count(&pool->used, -1, 0);
+    block_pool_count(&pool->channel[channel].used, -1, 0);
+}
+
+/* Blocks in use, and the most ever in use since block_pool_init() */
+static inline uint8_t block_pool_used(const BlockPool *pool)
+{
+    return (uint8_t)pool->used;
+}
+
+static inline uint8_t block_pool_peak(const BlockPool *pool)
+{
+    return (uint8_t)pool->peak;
+}
+
+static inline uint8_t block_pool_channelUsed(const BlockPool *pool,
+                                             uint_fast8_t channel)
+{
+    return (uint8_t)pool->channel[channel].used;
+}
+
+static inline uint8_t block_pool_channelPeak(const BlockPool *pool,
+                                             uint_fast8_t channel)
+{
+    return (uint8_t)pool->channel[channel].peak;
+}
+
+#endif /* BLOCK_POOL_H_ */
@@ -0,0 +1,120 @@
+/******************************************************************************
+ * UART-to-UART forwarding
+ *
+ * See bridge.h. A route's block being filled is handed over either by its
+ * source ISR (block full, destination empty) or by its destination ISR
+ * (a block returned), which is safe because the two cannot preempt each
+ * other. The destination finds its route, and so the pool channel the
+ * block is charged to, by a scan of at most BRIDGE_ROUTES_MAX entries.
+ *
+ *******************************************************************************/
+#include "uart_driver.h"
+
+#if UART_TX_BLOCKS
+
+#include "bridge.h"
+#include "ramfunc.h"
+
+BLOCK_POOL_DEFINE(bridgePool, BRIDGE_BLOCKS, BRIDGE_BLOCK_SIZE,
+                  BRIDGE_ROUTES_MAX);
+
+static Bridge_Route *routes[BRIDGE_ROUTES_MAX];
+static uint_fast8_t routeCount = 0;
+
+/* Lends the block being filled to the destination, or drops it */
+RAMFUNC static void bridge_handoff(Bridge_Route *route)
+{
+    uint8_t *block = route->block;
+    uint16_t fill = route->fill;
+
+    route->block = 0;
+
+    if(uart_writeBlock(route->to, block, fill))
+    {
+        route->stats.bytes += fill;
+        route->stats.blocks++;
+    }
+    else
+    {
+        block_pool_free(&bridgePool, route->channel, block);
+        route->stats.queueFull += fill;
+    }
+}
+
+/* Block callback of every destination: a block is back */
+RAMFUNC static void bridge_txBlockDone(Uart *uart, uint8_t *block)
+{
+    uint_fast8_t n;
+
+    for(n = 0; n < routeCount; n++)
+    {
+        Bridge_Route *route = routes[n];
+
+        if(route->to != uart)
+            continue;
+
+        block_pool_free(&bridgePool, route->channel, block);
+        if(route->block && uart_txBlocks(uart) == 0)
+            bridge_handoff(route);
+        return;
+    }
+}
+
+void bridge_init(void)
+{
+    block_pool_init(&bridgePool);
+    routeCount = 0;
+}
+
+bool bridge_start(Bridge_Route *route, Uart *from)
+{
+    uint_fast8_t n;
+
+    if(routeCount == BRIDGE_ROUTES_MAX)
+        return false;
+
+    for(n = 0; n < routeCount; n++)
+    {
+        if(routes[n]->to == route->to)
+            return false;
+    }
+
+    route->block = 0;
+    route->fill = 0;
+    route->channel = (uint8_t)routeCount;
+    route->stats.bytes = 0;
+    route->stats.blocks = 0;
+    route->stats.noBlock = 0;
+    route->stats.queueFull = 0;
+    block_pool_setQuota(&bridgePool, route->channel, BRIDGE_ROUTE_QUOTA);
+
+    routes[routeCount++] = route;
+    uart_setTxBlockCallback(route->to, bridge_txBlockDone);
+    uart_setRxHandler(from, route->rxHandler);
+    return true;
+}
+
+RAMFUNC void bridge_rxByte(Bridge_Route *route, uint8_t byte)
+{
+    uint8_t *block = route->block;
+
+    if(!block)
+    {
+        block = block_pool_alloc(&bridgePool, route->channel);
+        if(!block)
+        {
+            route->stats.noBlock++;
+            return;
+        }
+
+        route->block = block;
+        route->fill = 0;
+    }
+
+    block[route->fill++] = byte;
+
+    if(route->fill == BRIDGE_BLOCK_SIZE || uart_txBlocks(route->to) == 0)
+        bridge_handoff(route);
+}
+
+#endif /* UART_TX_BLOCKS */
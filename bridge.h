@@ -0,0 +1,113 @@
+/******************************************************************************
+ * UART-to-UART forwarding
+ *
+ * Description: Routes every byte received on one eUSCI_A UART to the TX
+ * of another without copying it. The RX ISR stores each byte straight
+ * into a block from a fixed-block pool (block_pool.h), the block is lent
+ * to the destination with uart_writeBlock(), its TX ISR feeds TXBUF
+ * from it, and the block callback puts it back in the pool. A byte is
+ * touched twice: once by each ISR.
+ *
+ * A block is handed over as soon as it is full or the destination has no
+ * block left to send, and again whenever the destination returns one. An
+ * idle link then forwards each byte at once, and a destination that falls
+ * behind gets whole blocks, so the per-block cost is spread over more
+ * bytes the busier it is. Bytes arriving while the pool is empty or the
+ * route has used up its quota, or while the destination already holds
+ * UART_TX_BLOCKS blocks, are dropped and counted.
+ *
+ * Each route is a channel of bridgePool with a quota of
+ * BRIDGE_ROUTE_QUOTA blocks, so a route whose destination stalls cannot
+ * take the blocks another route needs. The pool's per-route and overall
+ * peaks (block_pool.h) tell how many blocks a given load really needs.
+ *
+ * Routes are defined at compile time with BRIDGE_ROUTE_DEFINE(), which
+ * also generates the route's RX handler, and started with
+ * bridge_start(). A bidirectional bridge is two routes. Each destination
+ * takes one route, the only producer of its blocks.
+ *
+ * Everything runs in the eUSCI ISRs, which must share one NVIC priority
+ * (IRQ_PRIO_UART in irq_priority.h) so that a route's source and
+ * destination never preempt each other. Other
+ * sources, e.g. a software GPIO UART polled by the main loop, can feed a
+ * route through bridge_rxByte() with interrupts masked.
+ *
+ * Needs UART_TX_BLOCKS > 0; bridge.c compiles to nothing otherwise.
+ *
+ *******************************************************************************/
+#ifndef BRIDGE_H_
+#define BRIDGE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "uart_driver.h"
+#include "block_pool.h"
+
+#if !UART_TX_BLOCKS
+#error "bridge.h needs UART_TX_BLOCKS > 0"
+#endif
+
+/* Pool shared by all routes */
+#ifndef BRIDGE_BLOCK_SIZE
+#define BRIDGE_BLOCK_SIZE   64
+#endif
+
+#ifndef BRIDGE_BLOCKS
+#define BRIDGE_BLOCKS       16
+#endif
+
+#define BRIDGE_ROUTES_MAX   4
+
+/* Blocks one route may hold, filling and lent. It never needs more than
+ * UART_TX_BLOCKS + 1. */
+#ifndef BRIDGE_ROUTE_QUOTA
+#define BRIDGE_ROUTE_QUOTA  (BRIDGE_BLOCKS / 2)
+#endif
+
+/* Per route statistics, wrap-around */
+typedef struct
+{
+    uint32_t bytes;                 /* Lent to the destination           */
+    uint16_t blocks;
+    uint16_t noBlock;               /* Bytes dropped, no block to fill   */
+    uint16_t queueFull;             /* Bytes dropped, destination full   */
+} Bridge_Stats;
+
+typedef struct
+{
+    Uart *to;
+    Uart_RxHandler rxHandler;
+
+    uint8_t *block;                 /* Being filled, NULL if none        */
+    uint16_t fill;
+    uint8_t channel;                /* In bridgePool                     */
+
+    volatile Bridge_Stats stats;
+} Bridge_Route;
+
+/* Defines a route into the UART object dest and its RX handler */
+#define BRIDGE_ROUTE_DEFINE(name, dest)                                       \
+    static void name##_rx(uint8_t byte);                                      \
+    Bridge_Route name = { .to = &(dest), .rxHandler = name##_rx };            \
+    static void name##_rx(uint8_t byte)                                       \
+    {                                                                         \
+        bridge_rxByte(&name, byte);                                           \
+    }
+
+/* Empties the pool and forgets every route. Call before bridge_start(). */
+extern void bridge_init(void);
+
+/* Forwards from's received bytes along route, taking over from's RX
+ * handler and route->to's block callback. Both UARTs must be initialised.
+ * Returns false if BRIDGE_ROUTES_MAX routes run already or route->to has
+ * one. */
+extern bool bridge_start(Bridge_Route *route, Uart *from);
+
+/* Queues one byte on route, from the source ISR or with interrupts masked */
+extern void bridge_rxByte(Bridge_Route *route, uint8_t byte);
+
+/* Blocks of all routes; route->channel is a route's own usage */
+extern BlockPool bridgePool;
+
+#endif /* BRIDGE_H_ */
@@ -0,0 +1,202 @@
+/******************************************************************************
+ * UART bridge benchmark - host simulation
+ *
+ * Description: Runs a bidirectional bridge between two simulated eUSCI_A
+ * ports, A0 <-> A2, with both sources transmitting back-to-back frames, and
+ * prints one CSV line per route and rate pair:
+ *
+ *     route,src_baud,dst_baud,bytes_in,bytes_out,bytes_per_s,line_pct,
+ *     blocks,bytes_per_block,peak_blocks,no_block,queue_full,seq_breaks,
+ *     interrupts_per_byte
+ *
+ * bytes_per_s is what left the destination over the time its first to its
+ * last byte took, line_pct that against the destination's line rate.
+ * seq_breaks counts breaks in the byte sequence seen at the destination:
+ * each run of dropped bytes makes one, anything else is a fault.
+ * interrupts_per_byte is every eUSCI interrupt on both ports per forwarded
+ * byte. With unequal rates only A0 -> A2 runs, towards the slower side.
+ *
+ * Host only: the target build sees an empty file. Build and run with:
+ *
+ *     cc -std=gnu11 -O2 -I. -DUART_MODULES=0x5 -DUART_TX_BLOCKS=8 \
+ *        bridge_bench.c bridge.c uart_driver.c uart_baud.c cycle_stats.c \
+ *        hal_host.c -o bridge_bench
+ *     ./bridge_bench
+ *
+ *******************************************************************************/
+#ifndef __MSP432P401R__
+
+#include <stdio.h>
+
+#include "bridge.h"
+#include "hal.h"
+
+#if !(UART_MODULES & (1u << 0)) || !(UART_MODULES & (1u << 2))
+#error "bridge_bench.c needs UART_MODULES with EUSCI_A0 and EUSCI_A2"
+#endif
+
+/* Bytes each source sends per run */
+#define BRIDGE_BENCH_BYTES      20000
+
+typedef struct
+{
+    uint32_t srcBaud;
+    uint32_t dstBaud;
+} BridgeBench_Case;
+
+static const BridgeBench_Case cases[] =
+{
+    { 115200, 115200 },
+    { 921600, 921600 },
+    { 3000000, 3000000 },
+    { 921600, 460800 },             /* Destination falls behind          */
+};
+
+/* One direction: what its source sends and its destination receives */
+typedef struct
+{
+    uint32_t sent;
+    uint8_t  expect;
+    uint32_t received;
+    uint32_t breaks;
+    uint64_t first;
+    uint64_t last;
+} BridgeBench_Flow;
+
+static BridgeBench_Flow flowAB;     /* In on A0, out on A2 */
+static BridgeBench_Flow flowBA;     /* In on A2, out on A0 */
+
+BRIDGE_ROUTE_DEFINE(routeAB, uartA2);
+BRIDGE_ROUTE_DEFINE(routeBA, uartA0);
+
+static bool bridge_bench_feed(BridgeBench_Flow *flow, uint8_t *byte,
+                              uint32_t *gap)
+{
+    if(flow->sent == BRIDGE_BENCH_BYTES)
+        return false;
+
+    *byte = (uint8_t)flow->sent++;
+    *gap = 0;
+    return true;
+}
+
+static bool bridge_bench_feedAB(uint8_t *byte, uint32_t *gap)
+{
+    return bridge_bench_feed(&flowAB, byte, gap);
+}
+
+static bool bridge_bench_feedBA(uint8_t *byte, uint32_t *gap)
+{
+    return bridge_bench_feed(&flowBA, byte, gap);
+}
+
+static void bridge_bench_out(BridgeBench_Flow *flow, uint8_t byte)
+{
+    uint64_t now = hal_host_now();
+
+    if(flow->received++ == 0)
+        flow->first = now;
+    flow->last = now;
+
+    if(flow->received > 1 && byte != flow->expect)
+        flow->breaks++;
+    flow->expect = byte + 1;
+}
+
+static void bridge_bench_outAB(uint8_t byte)
+{
+    bridge_bench_out(&flowAB, byte);
+}
+
+static void bridge_bench_outBA(uint8_t byte)
+{
+    bridge_bench_out(&flowBA, byte);
+}
+
+static void bridge_bench_report(const char *name, const BridgeBench_Case *c,
+                                const BridgeBench_Flow *flow,
+                                const Bridge_Route *route,
+                                uint32_t interrupts, uint32_t forwarded)
+{
+    uint64_t span = flow->last - flow->first;
+    double bytesPerS = 0.0;
+
+    if(flow->received > 1 && span)
+        bytesPerS = (double)(flow->received - 1) * hal_clock_smclkHz() / span;
+
+    printf("%s,%u,%u,%u,%u,%.0f,%.1f,%u,%.1f,%u,%u,%u,%u,%.2f\n",
+           name, c->srcBaud, c->dstBaud, flow->sent, flow->received,
+           bytesPerS, 100.0 * bytesPerS * 10 / c->dstBaud,
+           route->stats.blocks,
+           route->stats.blocks ?
+               (double)route->stats.bytes / route->stats.blocks : 0.0,
+           block_pool_channelPeak(&bridgePool, route->channel),
+           route->stats.noBlock,
+           route->stats.queueFull, flow->breaks,
+           forwarded ? (double)interrupts / forwarded : 0.0);
+}
+
+static void bridge_bench_run(const BridgeBench_Case *c)
+{
+    static const BridgeBench_Flow idle;
+    uint32_t interrupts;
+    uint64_t frameCycles;
+
+    flowAB = idle;
+    flowBA = idle;
+
+    uart_setBaudRate(&uartA0, c->srcBaud, 0);
+    uart_setBaudRate(&uartA2, c->dstBaud, 0);
+
+    bridge_init();
+    bridge_start(&routeAB, &uartA0);
+    bridge_start(&routeBA, &uartA2);
+
+    interrupts = halHostUartStats[HAL_UART_A0].interrupts +
+                 halHostUartStats[HAL_UART_A2].interrupts;
+
+    hal_host_uartFeed(HAL_UART_A0, bridge_bench_feedAB);
+    if(c->srcBaud == c->dstBaud)
+        hal_host_uartFeed(HAL_UART_A2, bridge_bench_feedBA);
+
+    /* Long enough for every byte at the slower rate, plus slack */
+    frameCycles = (uint64_t)10 * hal_clock_smclkHz() /
+                  (c->srcBaud < c->dstBaud ? c->srcBaud : c->dstBaud);
+    hal_host_run(frameCycles * (BRIDGE_BENCH_BYTES + 1000));
+
+    interrupts = halHostUartStats[HAL_UART_A0].interrupts +
+                 halHostUartStats[HAL_UART_A2].interrupts - interrupts;
+
+    bridge_bench_report("A0->A2", c, &flowAB, &routeAB, interrupts,
+                        flowAB.received + flowBA.received);
+    if(c->srcBaud == c->dstBaud)
+        bridge_bench_report("A2->A0", c, &flowBA, &routeBA, interrupts,
+                            flowAB.received + flowBA.received);
+}
+
+int main(void)
+{
+    const Hal_UartConfig config = UART_CONFIG_8N1(24000000, 115200);
+    uint_fast8_t n;
+
+    hal_host_uartLoopback(HAL_UART_A0, false);
+    hal_host_uartLoopback(HAL_UART_A2, false);
+    hal_host_uartTxHook(HAL_UART_A2, bridge_bench_outAB);
+    hal_host_uartTxHook(HAL_UART_A0, bridge_bench_outBA);
+
+    uart_init(&uartA0, &config);
+    uart_init(&uartA2, &config);
+
+    printf("route,src_baud,dst_baud,bytes_in,bytes_out,bytes_per_s,line_pct,"
+           "blocks,bytes_per_block,peak_blocks,no_block,queue_full,seq_breaks,"
+           "interrupts_per_byte\n");
+
+    for(n = 0; n < sizeof(cases) / sizeof(cases[0]); n++)
+        bridge_bench_run(&cases[n]);
+
+    fprintf(stderr, "pool: %u blocks of %u bytes, peak %u in use\n",
+            BRIDGE_BLOCKS, BRIDGE_BLOCK_SIZE, block_pool_peak(&bridgePool));
+    return 0;
+}
+
+#endif /* __MSP432P401R__ */
@@ -0,0 +1,127 @@
+/******************************************************************************
+ * Clock profiles
+ *
+ * See clock_profile.h. Wait states follow the limits already encoded in
+ * system_msp432p401r.c: bank 0 runs 0 wait states up to 12 MHz at VCORE0,
+ * and one wait state covers 48 MHz at VCORE1.
+ *
+ *******************************************************************************/
+/* DriverLib Includes */
+#include <ti/devices/msp432p4xx/driverlib/driverlib.h>
+#include <ti/devices/msp432p4xx/inc/msp.h>
+
+#include "clock_profile.h"
+
+typedef struct
+{
+    uint32_t dcoCenter;             /* CS_DCO_FREQUENCY_x                */
+    uint32_t mclkHz;
+    uint32_t smclkDivider;          /* CS_CLOCK_DIVIDER_x                */
+    uint32_t smclkHz;
+    uint_fast8_t vcore;             /* PCM_VCOREx                        */
+    uint32_t waitStates;
+} ClockProfile_Settings;
+
+static const ClockProfile_Settings profiles[CLOCK_PROFILE_COUNT] =
+{
+    [CLOCK_PROFILE_LOW_POWER] =
+    {
+        CS_DCO_FREQUENCY_12, CLOCK_LOW_POWER_MCLK_HZ,
+        CS_CLOCK_DIVIDER_1, CLOCK_LOW_POWER_SMCLK_HZ,
+        PCM_VCORE0, 0
+    },
+    [CLOCK_PROFILE_BALANCED] =
+    {
+        CS_DCO_FREQUENCY_24, CLOCK_BALANCED_MCLK_HZ,
+        CS_CLOCK_DIVIDER_1, CLOCK_BALANCED_SMCLK_HZ,
+        PCM_VCORE0, 1
+    },
+    [CLOCK_PROFILE_MAX_THROUGHPUT] =
+    {
+        CS_DCO_FREQUENCY_48, CLOCK_MAX_THROUGHPUT_MCLK_HZ,
+        CS_CLOCK_DIVIDER_2, CLOCK_MAX_THROUGHPUT_SMCLK_HZ,
+        PCM_VCORE1, 1
+    },
+};
+
+static ClockProfile currentProfile = CLOCK_PROFILE_BOOT;
+
+static void clock_profile_setFlash(uint32_t waitStates)
+{
+    MAP_FlashCtl_setWaitState(FLASH_BANK0, waitStates);
+    MAP_FlashCtl_setWaitState(FLASH_BANK1, waitStates);
+
+    /* Read buffering only pays off when there are wait states to hide */
+    if(waitStates)
+    {
+        MAP_FlashCtl_enableReadBuffering(FLASH_BANK0,
+                FLASH_DATA_READ | FLASH_INSTRUCTION_FETCH);
+        MAP_FlashCtl_enableReadBuffering(FLASH_BANK1,
+                FLASH_DATA_READ | FLASH_INSTRUCTION_FETCH);
+    }
+    else
+    {
+        MAP_FlashCtl_disableReadBuffering(FLASH_BANK0,
+                FLASH_DATA_READ | FLASH_INSTRUCTION_FETCH);
+        MAP_FlashCtl_disableReadBuffering(FLASH_BANK1,
+                FLASH_DATA_READ | FLASH_INSTRUCTION_FETCH);
+    }
+}
+
+bool clock_profile_set(ClockProfile profile)
+{
+    const ClockProfile_Settings *p;
+    bool faster;
+
+    if(profile >= CLOCK_PROFILE_COUNT)
+        return false;
+    if(profile == currentProfile)
+        return true;
+
+    p = &profiles[profile];
+    faster = MAP_CS_getMCLK() < p->mclkHz;
+
+    if(faster)
+    {
+        /* Supply and flash first, then the clock */
+        if(!MAP_PCM_setCoreVoltageLevel(p->vcore))
+            return false;
+        clock_profile_setFlash(p->waitStates);
+    }
+
+    /* SMCLK must not overshoot 24 MHz in between: a larger divider goes in
+     * before the DCO speeds up, a smaller one after it has slowed down */
+    if(faster)
+    {
+        MAP_CS_initClockSignal(CS_SMCLK, CS_DCOCLK_SELECT, p->smclkDivider);
+        MAP_CS_setDCOCenteredFrequency(p->dcoCenter);
+    }
+    else
+    {
+        MAP_CS_setDCOCenteredFrequency(p->dcoCenter);
+        MAP_CS_initClockSignal(CS_SMCLK, CS_DCOCLK_SELECT, p->smclkDivider);
+    }
+    MAP_CS_initClockSignal(CS_MCLK, CS_DCOCLK_SELECT, CS_CLOCK_DIVIDER_1);
+    MAP_CS_initClockSignal(CS_HSMCLK, CS_DCOCLK_SELECT, CS_CLOCK_DIVIDER_1);
+
+    if(!faster)
+    {
+        clock_profile_setFlash(p->waitStates);
+        MAP_PCM_setCoreVoltageLevel(p->vcore);
+    }
+
+    currentProfile = profile;
+    SystemCoreClockUpdate();
+
+    return true;
+}
+
+ClockProfile clock_profile_get(void)
+{
+    return currentProfile;
+}
+
+uint32_t clock_profile_smclkHz(ClockProfile profile)
+{
+    return profile < CLOCK_PROFILE_COUNT ? profiles[profile].smclkHz : 0;
+}
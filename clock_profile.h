@@ -0,0 +1,64 @@
+/******************************************************************************
+ * Clock profiles
+ *
+ * Description: Switches MCLK/SMCLK between a few fixed operating points and
+ * takes care of VCORE, flash wait states and read buffering on the way, in
+ * the order the device needs them (VCORE and wait states go up before the
+ * clock does, and come down after it).
+ *
+ *     profile          MCLK    SMCLK   VCORE  flash wait states
+ *     LOW_POWER        12 MHz  12 MHz  0      0
+ *     BALANCED         24 MHz  24 MHz  0      1
+ *     MAX_THROUGHPUT   48 MHz  24 MHz  1      1
+ *
+ * SMCLK never exceeds its 24 MHz limit: at 48 MHz it runs from DCO/2. That
+ * keeps SMCLK, and with it every baud divisor and software UART bit time,
+ * the same in BALANCED and MAX_THROUGHPUT, so only MCLK doubles.
+ *
+ * SystemCoreClock is brought up to date after every switch. Peripherals
+ * already timed from SMCLK are not touched; if the SMCLK frequency
+ * changes, call uart_setBaudRate() and re-init the software UARTs.
+ *
+ * SystemInit() (system_msp432p401r.c) brings up CLOCK_PROFILE_BOOT straight
+ * from reset, before the C start-up code runs, so main() starts on its
+ * final clocks and setting that profile again costs nothing. Its
+ * __SYSTEM_CLOCK must be the MCLK of CLOCK_PROFILE_BOOT.
+ *
+ *******************************************************************************/
+#ifndef CLOCK_PROFILE_H_
+#define CLOCK_PROFILE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef enum
+{
+    CLOCK_PROFILE_LOW_POWER,
+    CLOCK_PROFILE_BALANCED,
+    CLOCK_PROFILE_MAX_THROUGHPUT,
+    CLOCK_PROFILE_COUNT
+} ClockProfile;
+
+/* Compile-time frequencies, for configurations fixed at build time */
+#define CLOCK_LOW_POWER_MCLK_HZ         12000000
+#define CLOCK_LOW_POWER_SMCLK_HZ        12000000
+#define CLOCK_BALANCED_MCLK_HZ          24000000
+#define CLOCK_BALANCED_SMCLK_HZ         24000000
+#define CLOCK_MAX_THROUGHPUT_MCLK_HZ    48000000
+#define CLOCK_MAX_THROUGHPUT_SMCLK_HZ   24000000
+
+/* Profile the device runs from reset on */
+#define CLOCK_PROFILE_BOOT              CLOCK_PROFILE_MAX_THROUGHPUT
+
+/* Switches to profile. Returns false for an unknown profile or if the
+ * core voltage change fails, in which case the clocks are left as they
+ * were. */
+extern bool clock_profile_set(ClockProfile profile);
+
+/* Profile last set, CLOCK_PROFILE_BOOT before the first call */
+extern ClockProfile clock_profile_get(void);
+
+/* Nominal SMCLK of a profile, 0 for an unknown one */
+extern uint32_t clock_profile_smclkHz(ClockProfile profile);
+
+#endif /* CLOCK_PROFILE_H_ */
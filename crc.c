@@ -0,0 +1,122 @@
+/******************************************************************************
+ * CRC-16 and CRC-32 over byte buffers
+ *
+ * See crc.h. On the CRC32 module, CRC-CCITT comes out of the byte-reversed
+ * data input with the result read as is, and CRC-32 out of the normal data
+ * input with the result read bit-reversed and inverted.
+ *
+ *******************************************************************************/
+#include "crc.h"
+
+#define CRC16_INIT      0xFFFF
+#define CRC32_INIT      0xFFFFFFFF
+
+#ifdef __MSP432P401R__
+
+/* DriverLib Includes */
+#include <ti/devices/msp432p4xx/driverlib/driverlib.h>
+
+uint16_t crc16_compute(const uint8_t *data, size_t len)
+{
+    MAP_CRC32_setSeed(CRC16_INIT, CRC16_MODE);
+    while(len--)
+        MAP_CRC32_set8BitDataReversed(*data++, CRC16_MODE);
+
+    return (uint16_t)MAP_CRC32_getResult(CRC16_MODE);
+}
+
+uint32_t crc32_compute(const uint8_t *data, size_t len)
+{
+    MAP_CRC32_setSeed(CRC32_INIT, CRC32_MODE);
+    while(len--)
+        MAP_CRC32_set8BitData(*data++, CRC32_MODE);
+
+    return MAP_CRC32_getResultReversed(CRC32_MODE) ^ 0xFFFFFFFF;
+}
+
+#else
+
+#include <stdbool.h>
+
+#define CRC16_POLY      0x1021
+#define CRC32_POLY_REV  0xEDB88320
+
+static uint16_t crc16Table[256];
+static uint32_t crc32Table[8][256];
+static bool crcTablesReady = false;
+
+static void crc_buildTables(void)
+{
+    uint32_t n;
+    uint_fast8_t k;
+
+    for(n = 0; n < 256; n++)
+    {
+        uint16_t c16 = (uint16_t)(n << 8);
+        uint32_t c32 = n;
+
+        for(k = 0; k < 8; k++)
+        {
+            c16 = (uint16_t)((c16 & 0x8000) ? (c16 << 1) ^ CRC16_POLY : c16 << 1);
+            c32 = (c32 & 1) ? (c32 >> 1) ^ CRC32_POLY_REV : c32 >> 1;
+        }
+        crc16Table[n] = c16;
+        crc32Table[0][n] = c32;
+    }
+
+    /* crc32Table[k][n]: n followed by k zero bytes */
+    for(n = 0; n < 256; n++)
+    {
+        for(k = 1; k < 8; k++)
+        {
+            uint32_t prev = crc32Table[k - 1][n];
+            crc32Table[k][n] = (prev >> 8) ^ crc32Table[0][prev & 0xFF];
+        }
+    }
+
+    crcTablesReady = true;
+}
+
+uint16_t crc16_compute(const uint8_t *data, size_t len)
+{
+    uint16_t crc = CRC16_INIT;
+
+    if(!crcTablesReady)
+        crc_buildTables();
+
+    while(len--)
+        crc = (uint16_t)((crc << 8) ^ crc16Table[(crc >> 8) ^ *data++]);
+
+    return crc;
+}
+
+uint32_t crc32_compute(const uint8_t *data, size_t len)
+{
+    uint32_t crc = CRC32_INIT;
+
+    if(!crcTablesReady)
+        crc_buildTables();
+
+    /* Slice-by-8: fold eight input bytes per step, byte-order independent */
+    while(len >= 8)
+    {
+        uint32_t lo = crc ^ ((uint32_t)data[0] | (uint32_t)data[1] << 8 |
+                             (uint32_t)data[2] << 16 | (uint32_t)data[3] << 24);
+        uint32_t hi = (uint32_t)data[4] | (uint32_t)data[5] << 8 |
+                      (uint32_t)data[6] << 16 | (uint32_t)data[7] << 24;
+
+        crc = crc32Table[7][lo & 0xFF] ^ crc32Table[6][(lo >> 8) & 0xFF] ^
+              crc32Table[5][(lo >> 16) & 0xFF] ^ crc32Table[4][lo >> 24] ^
+              crc32Table[3][hi & 0xFF] ^ crc32Table[2][(hi >> 8) & 0xFF] ^
+              crc32Table[1][(hi >> 16) & 0xFF] ^ crc32Table[0][hi >> 24];
+        data += 8;
+        len -= 8;
+    }
+
+    while(len--)
+        crc = (crc >> 8) ^ crc32Table[0][(crc ^ *data++) & 0xFF];
+
+    return crc ^ 0xFFFFFFFF;
+}
+
+#endif
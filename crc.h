@@ -0,0 +1,31 @@
+/******************************************************************************
+ * CRC-16 and CRC-32 over byte buffers
+ *
+ * Description: Two checksums for framed traffic:
+ *
+ *     crc16_compute()  CRC-16/CCITT-FALSE: poly 0x1021, init 0xFFFF, not
+ *                      reflected, no final XOR ("123456789" -> 0x29B1)
+ *     crc32_compute()  CRC-32 (ISO 3309, zlib): poly 0x04C11DB7 reflected,
+ *                      init and final XOR 0xFFFFFFFF ("123456789" ->
+ *                      0xCBF43926)
+ *
+ * On the MSP432 both run on the CRC32 module, one byte write per input
+ * byte. The module is a single shared engine and a computation is not
+ * reentrant: call these from one context only (the main loop here), never
+ * from an ISR that may preempt another call.
+ *
+ * A host build has no such module and uses lookup tables instead: one
+ * 256-entry table for CRC-16 and slice-by-8 (eight tables, eight bytes per
+ * step) for CRC-32. The tables are built on first use.
+ *
+ *******************************************************************************/
+#ifndef CRC_H_
+#define CRC_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+extern uint16_t crc16_compute(const uint8_t *data, size_t len);
+extern uint32_t crc32_compute(const uint8_t *data, size_t len);
+
+#endif /* CRC_H_ */
@@ -0,0 +1,148 @@
+/******************************************************************************
+ * Cycle-count instrumentation
+ *
+ * See cycle_stats.h. The dump is plain CSV so it can be captured from a
+ * terminal and pasted into a spreadsheet:
+ *
+ *     probe,count,min,max,avg,latency_max
+ *     EUSCIA2,1523,41,97,52,0
+ *     ...
+ *     window,<cycles>,sleep,<cycles>,active,<cycles>,boot,<cycles>
+ *
+ *******************************************************************************/
+#include <string.h>
+
+#include "cycle_stats.h"
+
+#define CYCLE_STATS_PROBE_NAME_(name)   #name,
+
+static const char *const probeNames[CYCLE_PROBE_COUNT] =
+{
+    CYCLE_STATS_PROBES(CYCLE_STATS_PROBE_NAME_)
+};
+
+CycleStats cycleStats;
+
+#ifdef __MSP432P401R__
+#define CYCLE_STATS_LOCK(state)     do { (state) = __get_PRIMASK(); __disable_irq(); } while(0)
+#define CYCLE_STATS_UNLOCK(state)   __set_PRIMASK(state)
+#else
+volatile uint32_t cycleStatsMockNow = 0;
+volatile bool cycleStatsMockSleepOnExit = false;
+
+#define CYCLE_STATS_LOCK(state)     ((void)(state))
+#define CYCLE_STATS_UNLOCK(state)   ((void)(state))
+#endif
+
+static void cycle_stats_clear(uint32_t now)
+{
+    memset(cycleStats.probe, 0, sizeof(cycleStats.probe));
+    cycleStats.windowStart = now;
+    cycleStats.window = 0;
+    cycleStats.sleepCycles = 0;
+
+    /* A sleep already in progress now counts towards the new window */
+    if(cycleStats.sleeping)
+        cycleStats.sleepStart = now;
+}
+
+void cycle_stats_init(void)
+{
+#ifdef __MSP432P401R__
+    /* Still running from SystemInit() in a CYCLE_STATS_ENABLE build */
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    if(!(DWT->CTRL & DWT_CTRL_CYCCNTENA_Msk))
+        cycle_stats_start();
+#endif
+
+    cycleStats.sleeping = false;
+    cycleStats.depth = 0;
+    cycle_stats_clear(CYCLE_STATS_NOW());
+}
+
+void cycle_stats_snapshot(CycleStats *out)
+{
+    uint32_t state = 0;
+    uint32_t now;
+
+    CYCLE_STATS_LOCK(state);
+
+    now = CYCLE_STATS_NOW();
+    *out = cycleStats;
+    out->window = now - cycleStats.windowStart;
+    if(cycleStats.sleeping)
+        out->sleepCycles += now - cycleStats.sleepStart;
+    cycle_stats_clear(now);
+
+    CYCLE_STATS_UNLOCK(state);
+}
+
+static char *cycle_stats_putText(char *dst, const char *text)
+{
+    while(*text)
+        *dst++ = *text++;
+    return dst;
+}
+
+static char *cycle_stats_putUint(char *dst, uint32_t value)
+{
+    char digits[10];
+    uint_fast8_t n = 0;
+
+    do
+    {
+        digits[n++] = (char)('0' + value % 10);
+        value /= 10;
+    } while(value);
+
+    while(n)
+        *dst++ = digits[--n];
+    return dst;
+}
+
+uint16_t cycle_stats_line(const CycleStats *stats, uint_fast8_t n, char *buf)
+{
+    char *p = buf;
+
+    if(n == 0)
+    {
+        p = cycle_stats_putText(p, "probe,count,min,max,avg,latency_max");
+    }
+    else if(n <= CYCLE_PROBE_COUNT)
+    {
+        const CycleStats_Probe *probe = &stats->probe[n - 1];
+        uint32_t avg = probe->count ?
+                (uint32_t)(probe->total / probe->count) : 0;
+
+        p = cycle_stats_putText(p, probeNames[n - 1]);
+        *p++ = ',';
+        p = cycle_stats_putUint(p, probe->count);
+        *p++ = ',';
+        p = cycle_stats_putUint(p, probe->min);
+        *p++ = ',';
+        p = cycle_stats_putUint(p, probe->max);
+        *p++ = ',';
+        p = cycle_stats_putUint(p, avg);
+        *p++ = ',';
+        p = cycle_stats_putUint(p, probe->latencyMax);
+    }
+    else if(n == CYCLE_STATS_LINES - 1)
+    {
+        p = cycle_stats_putText(p, "window,");
+        p = cycle_stats_putUint(p, stats->window);
+        p = cycle_stats_putText(p, ",sleep,");
+        p = cycle_stats_putUint(p, stats->sleepCycles);
+        p = cycle_stats_putText(p, ",active,");
+        p = cycle_stats_putUint(p, stats->window - stats->sleepCycles);
+        p = cycle_stats_putText(p, ",boot,");
+        p = cycle_stats_putUint(p, stats->bootCycles);
+    }
+    else
+    {
+        return 0;
+    }
+
+    *p++ = '\r';
+    *p++ = '\n';
+    return (uint16_t)(p - buf);
+}
@@ -0,0 +1,214 @@
+/******************************************************************************
+ * Cycle-count instrumentation
+ *
+ * Description: Times hot paths with the Cortex-M4 DWT cycle counter. Each
+ * probe keeps count/min/max/total cycles and the worst interrupt latency
+ * reported for it; the time the CPU spends in LPM0 is tracked separately
+ * so active and sleeping cycles can be compared.
+ *
+ * Everything compiles away unless CYCLE_STATS_ENABLE is 1 (set it with
+ * -DCYCLE_STATS_ENABLE=1 or in the project's predefined symbols).
+ *
+ *     CYCLE_STATS_ISR_ENTER(id)   first statement of an ISR
+ *     CYCLE_STATS_ISR_EXIT(id)    last statement of the same ISR
+ *     CYCLE_STATS_BEGIN/END(id)   same for thread-mode code
+ *     CYCLE_STATS_LATENCY(id, c)  c cycles from the event to ISR entry
+ *     CYCLE_STATS_SLEEP()         right before the LPM0 entry
+ *     CYCLE_STATS_BOOT()          once, when the first byte goes out
+ *
+ * ISR durations include any higher-priority ISR that preempted them. LPM0
+ * time runs from the sleep entry (explicit, or an ISR exit with
+ * SLEEPONEXIT set) to the next instrumented ISR entry, so ISRs without a
+ * probe are counted as sleep.
+ *
+ * The counter wraps after 2^32 cycles (89 s at 48 MHz); a statistics
+ * window must be read and restarted with cycle_stats_snapshot() well
+ * before that.
+ *
+ * Boot time: SystemInit() starts the counter from zero with
+ * cycle_stats_start() before anything else, and CYCLE_STATS_BOOT() keeps
+ * its value, the MCLK cycles from the reset handler to that point, for the
+ * summary line of every dump. MCLK runs at the 3 MHz reset frequency until
+ * SystemInit() has raised VCORE and switched the DCO, so those first
+ * cycles are longer ones.
+ *
+ * On the target DWT->CYCCNT is the cycle source. A host build reads
+ * cycleStatsMockNow and cycleStatsMockSleepOnExit instead, which a test
+ * drives by hand.
+ *
+ *******************************************************************************/
+#ifndef CYCLE_STATS_H_
+#define CYCLE_STATS_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifndef CYCLE_STATS_ENABLE
+#define CYCLE_STATS_ENABLE      0
+#endif
+
+/* Byte that asks the application for a statistics dump (Ctrl-R) */
+#define CYCLE_STATS_DUMP_CMD    0x12
+
+/* Longest line cycle_stats_line() produces, including the CR LF */
+#define CYCLE_STATS_LINE_MAX    80
+
+#define CYCLE_STATS_PROBES(X)                                                 \
+    X(EUSCIA0)                                                                \
+    X(EUSCIA1)                                                                \
+    X(EUSCIA2)                                                                \
+    X(EUSCIA3)                                                                \
+    X(DMA_RX)                                                                 \
+    X(DMA_TX)                                                                 \
+    X(SWUART_TIMER)                                                           \
+    X(SWUART_EDGE)                                                            \
+    X(MC_TICK)                                                                \
+    X(AUTOBAUD_EDGE)                                                          \
+    X(AUTOBAUD_TIMEOUT)                                                       \
+    X(LISTEN_WAKE)                                                            \
+    X(EDGE_POLL)                                                              \
+    X(PENDSV)                                                                 \
+    X(SCHED)
+
+#define CYCLE_STATS_PROBE_ENUM_(name)   CYCLE_PROBE_##name,
+
+typedef enum
+{
+    CYCLE_STATS_PROBES(CYCLE_STATS_PROBE_ENUM_)
+    CYCLE_PROBE_COUNT
+} CycleProbe;
+
+typedef struct
+{
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint64_t total;
+    uint32_t latencyMax;
+} CycleStats_Probe;
+
+typedef struct
+{
+    CycleStats_Probe probe[CYCLE_PROBE_COUNT];
+    uint32_t windowStart;           /* Cycle count at the window start   */
+    uint32_t window;                /* Window length, set by snapshot    */
+    uint32_t sleepCycles;
+    uint32_t sleepStart;
+    uint32_t bootCycles;            /* Reset to CYCLE_STATS_BOOT()       */
+    volatile bool sleeping;
+    volatile uint8_t depth;         /* Instrumented ISRs currently active */
+} CycleStats;
+
+/* Lines produced by cycle_stats_line(): header, one per probe, summary */
+#define CYCLE_STATS_LINES       (CYCLE_PROBE_COUNT + 2)
+
+#ifdef __MSP432P401R__
+#include <ti/devices/msp432p4xx/inc/msp.h>
+#define CYCLE_STATS_NOW()               (DWT->CYCCNT)
+#define CYCLE_STATS_SLEEP_ON_EXIT()     (SCB->SCR & SCB_SCR_SLEEPONEXIT_Msk)
+#else
+extern volatile uint32_t cycleStatsMockNow;
+extern volatile bool cycleStatsMockSleepOnExit;
+#define CYCLE_STATS_NOW()               (cycleStatsMockNow)
+#define CYCLE_STATS_SLEEP_ON_EXIT()     (cycleStatsMockSleepOnExit)
+#endif
+
+extern CycleStats cycleStats;
+
+/* Restarts the cycle counter from zero */
+static inline void cycle_stats_start(void)
+{
+#ifdef __MSP432P401R__
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+}
+
+/* Starts the cycle counter unless it already runs and clears every
+ * statistic but the boot time */
+extern void cycle_stats_init(void);
+
+/* Copies the statistics of the window just ended into out and starts a
+ * new window. Safe against the ISRs updating them. */
+extern void cycle_stats_snapshot(CycleStats *out);
+
+/* Formats line n (0 .. CYCLE_STATS_LINES - 1) of a snapshot as CSV into buf,
+ * which must hold CYCLE_STATS_LINE_MAX bytes. Returns its length. */
+extern uint16_t cycle_stats_line(const CycleStats *stats, uint_fast8_t n,
+                                 char *buf);
+
+static inline void cycle_stats_record(CycleProbe id, uint32_t cycles)
+{
+    CycleStats_Probe *p = &cycleStats.probe[id];
+
+    if(p->count == 0 || cycles < p->min)
+        p->min = cycles;
+    if(cycles > p->max)
+        p->max = cycles;
+    p->total += cycles;
+    p->count++;
+}
+
+static inline uint32_t cycle_stats_isrEnter(void)
+{
+    uint32_t now = CYCLE_STATS_NOW();
+
+    if(cycleStats.sleeping)
+    {
+        cycleStats.sleepCycles += now - cycleStats.sleepStart;
+        cycleStats.sleeping = false;
+    }
+    cycleStats.depth++;
+    return now;
+}
+
+static inline void cycle_stats_isrExit(CycleProbe id, uint32_t start)
+{
+    cycle_stats_record(id, CYCLE_STATS_NOW() - start);
+
+    /* The outermost ISR returning with SLEEPONEXIT set goes back to LPM0 */
+    if(--cycleStats.depth == 0 && CYCLE_STATS_SLEEP_ON_EXIT())
+    {
+        cycleStats.sleepStart = CYCLE_STATS_NOW();
+        cycleStats.sleeping = true;
+    }
+}
+
+static inline void cycle_stats_latency(CycleProbe id, uint32_t cycles)
+{
+    if(cycles > cycleStats.probe[id].latencyMax)
+        cycleStats.probe[id].latencyMax = cycles;
+}
+
+static inline void cycle_stats_sleep(void)
+{
+    cycleStats.sleepStart = CYCLE_STATS_NOW();
+    cycleStats.sleeping = true;
+}
+
+static inline void cycle_stats_boot(void)
+{
+    cycleStats.bootCycles = CYCLE_STATS_NOW();
+}
+
+#if CYCLE_STATS_ENABLE
+#define CYCLE_STATS_ISR_ENTER(id)   uint32_t cycleStatsStart_##id = cycle_stats_isrEnter()
+#define CYCLE_STATS_ISR_EXIT(id)    cycle_stats_isrExit(CYCLE_PROBE_##id, cycleStatsStart_##id)
+#define CYCLE_STATS_BEGIN(id)       uint32_t cycleStatsStart_##id = CYCLE_STATS_NOW()
+#define CYCLE_STATS_END(id)                                                   \
+    cycle_stats_record(CYCLE_PROBE_##id, CYCLE_STATS_NOW() - cycleStatsStart_##id)
+#define CYCLE_STATS_LATENCY(id, c)  cycle_stats_latency(CYCLE_PROBE_##id, (c))
+#define CYCLE_STATS_SLEEP()         cycle_stats_sleep()
+#define CYCLE_STATS_BOOT()          cycle_stats_boot()
+#else
+#define CYCLE_STATS_ISR_ENTER(id)   do { } while(0)
+#define CYCLE_STATS_ISR_EXIT(id)    do { } while(0)
+#define CYCLE_STATS_BEGIN(id)       do { } while(0)
+#define CYCLE_STATS_END(id)         do { } while(0)
+#define CYCLE_STATS_LATENCY(id, c)  do { } while(0)
+#define CYCLE_STATS_SLEEP()         do { } while(0)
+#define CYCLE_STATS_BOOT()          do { } while(0)
+#endif
+
+#endif /* CYCLE_STATS_H_ */
@@ -0,0 +1,436 @@
+/******************************************************************************
+ * Cycle-count instrumentation - host check
+ *
+ * Description: Drives cycle_stats.h and cycle_stats.c by hand through
+ * cycleStatsMockNow and cycleStatsMockSleepOnExit, keeps its own account
+ * of what they should have recorded, and prints one CSV line per check:
+ *
+ *     check,runs,errors
+ *
+ *     probes     random ISR and thread durations into a few probes,
+ *                against count, min, max and total kept alongside
+ *     latency    random CYCLE_STATS_LATENCY() reports: the worst one
+ *     sleep      LPM0 entries, explicit and by SLEEPONEXIT, with ISRs
+ *                nesting now and then: the sleep and active cycles, and
+ *                no sleep started by the return of an inner ISR
+ *     snapshot   a dump mid-run: the snapshot holds the window just ended,
+ *                the live statistics start over from the dump, a sleep in
+ *                progress is split between the two windows and the boot
+ *                time survives
+ *     wrap       the same with the counter passing 2^32 mid-window
+ *     lines      cycle_stats_line() against the same values printed with
+ *                snprintf(), within CYCLE_STATS_LINE_MAX
+ *
+ * Each check runs BENCH_RUNS random scripts; errors counts every value
+ * that differs and must be 0.
+ *
+ * Host only: the target build sees an empty file. Build and run with:
+ *
+ *     cc -std=gnu11 -O2 -I. -DCYCLE_STATS_ENABLE=1 cycle_stats_bench.c \
+ *        cycle_stats.c -o cycle_stats_bench
+ *     ./cycle_stats_bench
+ *
+ *******************************************************************************/
+#ifndef __MSP432P401R__
+
+#include <stdio.h>
+#include <string.h>
+
+#include "cycle_stats.h"
+
+#if !CYCLE_STATS_ENABLE
+#error "cycle_stats_bench.c needs CYCLE_STATS_ENABLE=1"
+#endif
+
+#define BENCH_RUNS          1000
+#define BENCH_EVENTS        200
+
+/* The probes the scripts use */
+#define BENCH_PROBES        3
+
+static const CycleProbe probes[BENCH_PROBES] =
+{
+    CYCLE_PROBE_EUSCIA2, CYCLE_PROBE_DMA_RX, CYCLE_PROBE_SCHED
+};
+
+static uint32_t rng = 0x2545F491;
+
+static uint32_t bench_random(void)
+{
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return rng;
+}
+
+/* What the statistics should hold */
+typedef struct
+{
+    CycleStats_Probe probe[BENCH_PROBES];
+    uint32_t sleep;
+    uint32_t windowStart;
+} CycleBench_Model;
+
+static CycleBench_Model model;
+static bool sleeping;
+
+static void bench_modelRecord(uint_fast8_t k, uint32_t cycles)
+{
+    CycleStats_Probe *p = &model.probe[k];
+
+    if(p->count == 0 || cycles < p->min)
+        p->min = cycles;
+    if(cycles > p->max)
+        p->max = cycles;
+    p->total += cycles;
+    p->count++;
+}
+
+static void bench_modelClear(void)
+{
+    memset(&model, 0, sizeof(model));
+    model.windowStart = cycleStatsMockNow;
+}
+
+/* Time passing, asleep or not */
+static void bench_elapse(uint32_t cycles)
+{
+    cycleStatsMockNow += cycles;
+    if(sleeping)
+        model.sleep += cycles;
+}
+
+static void bench_start(uint32_t now)
+{
+    cycleStatsMockNow = now;
+    cycleStatsMockSleepOnExit = false;
+    sleeping = false;
+    cycle_stats_init();
+    bench_modelClear();
+}
+
+/* ISR on probe k running for cycles, maybe preempted by another one */
+static void bench_isr(uint_fast8_t k, uint32_t cycles, bool nest,
+                      bool sleepOnExit)
+{
+    uint32_t start = cycle_stats_isrEnter();
+    uint32_t first = cycles / 2;
+    uint32_t inner = 0;
+
+    sleeping = false;
+    bench_elapse(first);
+    if(nest)
+    {
+        /* The inner return must not go to sleep, SLEEPONEXIT or not */
+        inner = 1 + bench_random() % 500;
+        cycleStatsMockSleepOnExit = true;
+        bench_isr((k + 1) % BENCH_PROBES, inner, false, true);
+        sleeping = false;
+        cycleStatsMockSleepOnExit = false;
+    }
+    bench_elapse(cycles - first);
+
+    cycleStatsMockSleepOnExit = sleepOnExit;
+    cycle_stats_isrExit(probes[k], start);
+    bench_modelRecord(k, cycles + inner);
+    if(sleepOnExit && cycleStats.depth == 0)
+        sleeping = true;
+}
+
+/* A script of ISRs, thread code and sleeps */
+static void bench_script(void)
+{
+    uint_fast16_t n;
+
+    for(n = 0; n < BENCH_EVENTS; n++)
+    {
+        uint32_t pick = bench_random();
+        uint_fast8_t k = pick % BENCH_PROBES;
+        uint32_t cycles = 1 + (pick >> 8) % 5000;
+
+        switch((pick >> 4) % 4)
+        {
+        case 0:
+            /* Thread-mode code, awake */
+            if(!sleeping)
+            {
+                CYCLE_STATS_BEGIN(SCHED);
+                bench_elapse(cycles);
+                CYCLE_STATS_END(SCHED);
+                bench_modelRecord(2, cycles);
+            }
+            break;
+
+        case 1:
+            /* The main loop goes to sleep */
+            if(!sleeping)
+            {
+                CYCLE_STATS_SLEEP();
+                sleeping = true;
+            }
+            bench_elapse(cycles);
+            break;
+
+        default:
+            bench_elapse(bench_random() % 2000);
+            bench_isr(k, cycles, bench_random() % 8 == 0,
+                      bench_random() % 2);
+            break;
+        }
+    }
+}
+
+static uint32_t bench_compare(const CycleStats *s, uint32_t window)
+{
+    uint32_t errors = 0;
+    uint_fast8_t k;
+
+    for(k = 0; k < BENCH_PROBES; k++)
+    {
+        const CycleStats_Probe *got = &s->probe[probes[k]];
+        const CycleStats_Probe *want = &model.probe[k];
+
+        errors += got->count != want->count;
+        errors += got->min != want->min;
+        errors += got->max != want->max;
+        errors += got->total != want->total;
+        errors += got->latencyMax != want->latencyMax;
+    }
+
+    errors += s->sleepCycles != model.sleep;
+    errors += s->window != window;
+    return errors;
+}
+
+/* Any probe outside the script's must stay untouched */
+static uint32_t bench_untouched(const CycleStats *s)
+{
+    static const CycleStats_Probe zero;
+    uint32_t errors = 0;
+    uint_fast8_t n;
+
+    for(n = 0; n < CYCLE_PROBE_COUNT; n++)
+        if(n != probes[0] && n != probes[1] && n != probes[2])
+            errors += memcmp(&s->probe[n], &zero, sizeof(zero)) != 0;
+
+    return errors;
+}
+
+static uint32_t bench_probes(void)
+{
+    CycleStats s;
+    uint32_t errors;
+
+    bench_start(bench_random());
+    bench_script();
+
+    cycle_stats_snapshot(&s);
+    errors = bench_compare(&s, cycleStatsMockNow - model.windowStart);
+    return errors + bench_untouched(&s);
+}
+
+static uint32_t bench_latency(void)
+{
+    uint32_t worst = 0;
+    CycleStats s;
+    uint_fast16_t n;
+
+    bench_start(bench_random());
+    for(n = 0; n < BENCH_EVENTS; n++)
+    {
+        uint32_t cycles = bench_random() % 100000;
+
+        CYCLE_STATS_LATENCY(MC_TICK, cycles);
+        if(cycles > worst)
+            worst = cycles;
+    }
+
+    cycle_stats_snapshot(&s);
+    return (s.probe[CYCLE_PROBE_MC_TICK].latencyMax != worst) +
+           (s.probe[CYCLE_PROBE_MC_TICK].count != 0);
+}
+
+static uint32_t bench_sleep(void)
+{
+    CycleStats s;
+    uint32_t window;
+
+    bench_start(bench_random());
+    bench_script();
+
+    cycle_stats_snapshot(&s);
+    window = cycleStatsMockNow - model.windowStart;
+    return (s.sleepCycles != model.sleep) + (s.window != window) +
+           (s.depth != 0);
+}
+
+/* Two windows back to back, the first starting at start */
+static uint32_t bench_windows(uint32_t start)
+{
+    uint32_t boot = bench_random();
+    uint32_t errors = 0;
+    uint32_t window;
+    CycleStats s;
+    uint_fast8_t k;
+
+    bench_start(start);
+    cycleStatsMockNow = boot;
+    CYCLE_STATS_BOOT();
+    cycleStatsMockNow = start;
+
+    bench_script();
+
+    /* Dump in the middle of a sleep */
+    if(!sleeping)
+    {
+        CYCLE_STATS_SLEEP();
+        sleeping = true;
+    }
+    bench_elapse(1 + bench_random() % 5000);
+
+    cycle_stats_snapshot(&s);
+    window = cycleStatsMockNow - model.windowStart;
+    errors += bench_compare(&s, window);
+    errors += s.bootCycles != boot;
+
+    /* The live statistics start over from the dump */
+    for(k = 0; k < CYCLE_PROBE_COUNT; k++)
+        errors += cycleStats.probe[k].count != 0 ||
+                  cycleStats.probe[k].max != 0 ||
+                  cycleStats.probe[k].total != 0 ||
+                  cycleStats.probe[k].latencyMax != 0;
+    errors += cycleStats.windowStart != cycleStatsMockNow;
+    errors += cycleStats.sleepCycles != 0;
+
+    /* The rest of that sleep belongs to the next window */
+    bench_modelClear();
+    bench_elapse(1 + bench_random() % 5000);
+    bench_script();
+
+    cycle_stats_snapshot(&s);
+    errors += bench_compare(&s, cycleStatsMockNow - model.windowStart);
+    errors += s.bootCycles != boot;
+    return errors;
+}
+
+static uint32_t bench_snapshot(void)
+{
+    return bench_windows(bench_random() % 0x80000000u);
+}
+
+static uint32_t bench_wrap(void)
+{
+    /* Close enough to 2^32 for the script to cross it */
+    return bench_windows(0u - 1 - bench_random() % 200000);
+}
+
+static uint32_t bench_lines(void)
+{
+    char want[CYCLE_STATS_LINE_MAX * 2];
+    char buf[CYCLE_STATS_LINE_MAX + 8];
+    uint32_t errors = 0;
+    CycleStats s;
+    uint_fast8_t n;
+
+    memset(&s, 0, sizeof(s));
+    for(n = 0; n < CYCLE_PROBE_COUNT; n++)
+    {
+        CycleStats_Probe *p = &s.probe[n];
+
+        /* Full-width values now and then */
+        p->count = bench_random() % 4 ? bench_random() % 100000 : ~0u;
+        p->min = bench_random() >> (bench_random() % 32);
+        p->max = bench_random() % 4 ? bench_random() : ~0u;
+        p->total = (uint64_t)p->count * (bench_random() % 70000);
+        p->latencyMax = bench_random() >> (bench_random() % 32);
+    }
+    s.window = bench_random();
+    s.sleepCycles = bench_random() % (s.window + 1);
+    s.bootCycles = bench_random() % 4 ? bench_random() : ~0u;
+
+    for(n = 0; n <= CYCLE_STATS_LINES; n++)
+    {
+        uint16_t len;
+
+        memset(buf, 0x55, sizeof(buf));
+        len = cycle_stats_line(&s, n, buf);
+
+        if(n == 0)
+        {
+            snprintf(want, sizeof(want), "probe,count,min,max,avg,"
+                     "latency_max\r\n");
+        }
+        else if(n <= CYCLE_PROBE_COUNT)
+        {
+            const CycleStats_Probe *p = &s.probe[n - 1];
+
+            snprintf(want, sizeof(want), ",%u,%u,%u,%u,%u\r\n", p->count,
+                     p->min, p->max,
+                     p->count ? (uint32_t)(p->total / p->count) : 0,
+                     p->latencyMax);
+            /* The name is checked for being there, not spelt out */
+            if(len < strlen(want) || buf[0] == ',' ||
+               memchr(buf, ',', len) == NULL ||
+               memcmp(memchr(buf, ',', len), want, strlen(want)))
+                errors++;
+            errors += len > CYCLE_STATS_LINE_MAX;
+            continue;
+        }
+        else if(n == CYCLE_STATS_LINES - 1)
+        {
+            snprintf(want, sizeof(want),
+                     "window,%u,sleep,%u,active,%u,boot,%u\r\n", s.window,
+                     s.sleepCycles, s.window - s.sleepCycles, s.bootCycles);
+        }
+        else
+        {
+            /* Past the last line: nothing */
+            errors += len != 0 || (uint8_t)buf[0] != 0x55;
+            continue;
+        }
+
+        errors += len != strlen(want) || memcmp(buf, want, len);
+        errors += len > CYCLE_STATS_LINE_MAX;
+    }
+
+    return errors;
+}
+
+typedef struct
+{
+    const char *name;
+    uint32_t (*run)(void);
+} CycleBench_Check;
+
+static const CycleBench_Check checks[] =
+{
+    { "probes", bench_probes },
+    { "latency", bench_latency },
+    { "sleep", bench_sleep },
+    { "snapshot", bench_snapshot },
+    { "wrap", bench_wrap },
+    { "lines", bench_lines },
+};
+
+int main(void)
+{
+    uint32_t failed = 0;
+    uint_fast8_t k;
+
+    printf("check,runs,errors\n");
+    for(k = 0; k < sizeof(checks) / sizeof(checks[0]); k++)
+    {
+        uint32_t errors = 0;
+        uint32_t n;
+
+        for(n = 0; n < BENCH_RUNS; n++)
+            errors += checks[k].run();
+
+        failed += errors;
+        printf("%s,%u,%u\n", checks[k].name, BENCH_RUNS, errors);
+    }
+
+    return failed != 0;
+}
+
+#endif /* __MSP432P401R__ */
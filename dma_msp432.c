@@ -0,0 +1,24 @@
+/******************************************************************************
+ * uDMA controller - MSP432 binding
+ *
+ * See dma_msp432.h.
+ *
+ *******************************************************************************/
+/* DriverLib Includes */
+#include <ti/devices/msp432p4xx/driverlib/driverlib.h>
+
+#include "dma_msp432.h"
+
+/* Control table, aligned as the controller requires */
+#if defined(__TI_COMPILER_VERSION__)
+#pragma DATA_ALIGN(dmaControlTable, 1024)
+#elif defined(__GNUC__)
+__attribute__ ((aligned (1024)))
+#endif
+static DMA_ControlTable dmaControlTable[32];
+
+void dma_msp432_init(void)
+{
+    MAP_DMA_enableModule();
+    MAP_DMA_setControlBase(dmaControlTable);
+}
@@ -0,0 +1,21 @@
+/******************************************************************************
+ * uDMA controller - MSP432 binding
+ *
+ * Description: The controller has one channel control table for all eight
+ * channels, so the drivers that use it (uart_dma.c, edge_uart_msp432.c)
+ * share the table defined here instead of each pointing the controller at
+ * one of their own. dma_msp432_init() enables the controller on first use;
+ * every channel is then set up by the driver that owns it.
+ *
+ *******************************************************************************/
+#ifndef DMA_MSP432_H_
+#define DMA_MSP432_H_
+
+/* Primary or alternate descriptor of a ping-pong slot */
+#define DMA_MSP432_SLOT_SEL(slot)   ((slot) ? UDMA_ALT_SELECT : UDMA_PRI_SELECT)
+
+/* Enables the controller with the shared control table. Safe to call from
+ * every driver's init. */
+extern void dma_msp432_init(void);
+
+#endif /* DMA_MSP432_H_ */
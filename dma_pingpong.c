@@ -0,0 +1,52 @@
+/******************************************************************************
+ * Ping-pong DMA buffer ownership model
+ *
+ * See dma_pingpong.h.
+ *
+ *******************************************************************************/
+#include "dma_pingpong.h"
+
+void dma_pp_init(DmaPingPong *pp)
+{
+    pp->buf[0] = pp->buf[1] = 0;
+    pp->len[0] = pp->len[1] = 0;
+    pp->state[0] = pp->state[1] = DMA_PP_FREE;
+    pp->giveSlot = 0;
+    pp->takeSlot = 0;
+    pp->dmaSlot = 0;
+    pp->running = false;
+    pp->stalls = 0;
+}
+
+void dma_pp_give(DmaPingPong *pp, uint8_t *buf, uint16_t len)
+{
+    uint_fast8_t slot = pp->giveSlot;
+
+    pp->buf[slot] = buf;
+    pp->len[slot] = len;
+    pp->state[slot] = DMA_PP_ARMED;
+    pp->giveSlot = slot ^ 1;
+}
+
+uint8_t *dma_pp_take(DmaPingPong *pp, uint16_t *len)
+{
+    uint_fast8_t slot = pp->takeSlot;
+
+    if(pp->state[slot] != DMA_PP_DONE)
+        return 0;
+
+    if(len)
+        *len = pp->len[slot];
+    pp->state[slot] = DMA_PP_FREE;
+    pp->takeSlot = slot ^ 1;
+    return pp->buf[slot];
+}
+
+uint_fast8_t dma_pp_complete(DmaPingPong *pp)
+{
+    uint_fast8_t slot = pp->dmaSlot;
+
+    pp->state[slot] = DMA_PP_DONE;
+    pp->dmaSlot = slot ^ 1;
+    return slot;
+}
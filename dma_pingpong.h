@@ -0,0 +1,70 @@
+/******************************************************************************
+ * Ping-pong DMA buffer ownership model
+ *
+ * Description: Tracks the two descriptors (primary = slot 0, alternate =
+ * slot 1) of a uDMA channel in ping-pong mode and who owns the buffer
+ * behind each of them. A slot cycles
+ *
+ *     FREE  --give (thread)-->  ARMED  --complete (ISR)-->  DONE
+ *       ^                                                    |
+ *       +-------------------- take (thread) -----------------+
+ *
+ * so a buffer is only ever touched by either the controller or the
+ * application, never both, and nothing is copied on hand-over. For RX the
+ * application gives empty buffers and takes full ones; for TX it gives full
+ * buffers and takes back the sent ones.
+ *
+ * Each transition is owned by one side only and is a single store, so the
+ * thread and the ISR never need a lock. The model holds no hardware state:
+ * uart_dma.c programs the controller around it, and a host build can drive
+ * it with a simulated controller.
+ *
+ *******************************************************************************/
+#ifndef DMA_PINGPONG_H_
+#define DMA_PINGPONG_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define DMA_PP_FREE     0
+#define DMA_PP_ARMED    1
+#define DMA_PP_DONE     2
+
+typedef struct
+{
+    uint8_t *buf[2];
+    uint16_t len[2];
+    volatile uint8_t state[2];      /* DMA_PP_xxx                          */
+    uint8_t giveSlot;               /* Next slot to give (thread)          */
+    uint8_t takeSlot;               /* Next slot to take (thread)          */
+    uint8_t dmaSlot;                /* Slot the controller finishes next   */
+    volatile bool running;          /* Controller enabled (ISR)            */
+    volatile uint16_t stalls;       /* Times the controller ran dry (ISR)  */
+} DmaPingPong;
+
+extern void dma_pp_init(DmaPingPong *pp);
+
+/* Thread: slot the next give() will arm, or -1 while it is not FREE. The
+ * caller programs that slot's descriptor before calling dma_pp_give(). */
+static inline int dma_pp_giveSlot(const DmaPingPong *pp)
+{
+    return pp->state[pp->giveSlot] == DMA_PP_FREE ? pp->giveSlot : -1;
+}
+
+/* Thread: hands buf to the controller through the slot returned by
+ * dma_pp_giveSlot(). */
+extern void dma_pp_give(DmaPingPong *pp, uint8_t *buf, uint16_t len);
+
+/* Thread: takes back the oldest DONE buffer, or NULL if none is ready. */
+extern uint8_t *dma_pp_take(DmaPingPong *pp, uint16_t *len);
+
+/* ISR: slot the controller is working on, or -1 if nothing is armed */
+static inline int dma_pp_activeSlot(const DmaPingPong *pp)
+{
+    return pp->state[pp->dmaSlot] == DMA_PP_ARMED ? pp->dmaSlot : -1;
+}
+
+/* ISR: the active slot has finished; returns its index. */
+extern uint_fast8_t dma_pp_complete(DmaPingPong *pp);
+
+#endif /* DMA_PINGPONG_H_ */
@@ -0,0 +1,312 @@
+/******************************************************************************
+ * Ping-pong DMA ownership model - host simulation
+ *
+ * Description: Drives dma_pingpong.c with a simulated uDMA channel in
+ * ping-pong mode and the same service routine as uart_dma.c, and prints
+ * one CSV line per direction and consumer speed:
+ *
+ *     direction,buffer,process,bytes,buffers,stalls,lost,errors
+ *
+ * The channel has a primary and an alternate descriptor and moves one byte
+ * per byte time, as the eUSCI requests them. When a descriptor runs out it
+ * stops, raises the interrupt and goes on with the other one, or disables
+ * itself if that one is not armed. The interrupt runs uart_dma_service()'s
+ * steps: completes every stopped slot, restarts a disabled channel on an
+ * armed slot or, on RX, counts a stall.
+ *
+ * RX: the line delivers a byte every byte time; a byte that finds the
+ * channel disabled is lost, as the eUSCI would overrun. The application
+ * takes each full buffer, holds it for process byte times, checks it and
+ * gives it back. TX: the application fills a buffer in process byte times
+ * and queues it as uart_dma_write() does, reclaiming sent ones first;
+ * bytes counts what reached the line, which idles when it is slower.
+ *
+ * errors counts bytes that come out wrong or out of order, buffers handed
+ * over while the other side still owns them, and stalls the model counted
+ * that the channel did not (or the other way round); it must be 0. While
+ * process stays under a buffer time the other slot covers for it and RX
+ * must show no stalls and nothing lost. Beyond it the late consumer lets
+ * the channel run dry once per buffer: stalls counts those and lost the
+ * bytes that went by meanwhile, and every byte taken is still right.
+ *
+ * Host only: the target build sees an empty file. Build and run with:
+ *
+ *     cc -std=gnu11 -O2 -I. dma_pingpong_bench.c dma_pingpong.c \
+ *        -o dma_pingpong_bench
+ *     ./dma_pingpong_bench
+ *
+ *******************************************************************************/
+#ifndef __MSP432P401R__
+
+#include <stdio.h>
+
+#include "dma_pingpong.h"
+
+#define BENCH_BYTES         100000
+#define BENCH_MAX_BUFFER    256
+
+typedef struct
+{
+    bool     rx;
+    uint16_t buffer;                /* Bytes per buffer                  */
+    uint32_t process;               /* Byte times the application holds one */
+} DmaBench_Case;
+
+static const DmaBench_Case cases[] =
+{
+    { true, 64, 0 },
+    { true, 64, 32 },
+    { true, 64, 62 },
+    { true, 64, 96 },
+    { true, 64, 200 },
+    { true, 256, 255 },
+    { false, 64, 0 },
+    { false, 64, 62 },
+    { false, 64, 96 },
+};
+
+/* The simulated channel: a descriptor is armed until its count runs out */
+typedef struct
+{
+    uint8_t *ptr;
+    uint16_t left;
+    bool     armed;
+} DmaBench_Descriptor;
+
+static DmaBench_Descriptor desc[2];
+static uint_fast8_t altSelect;
+static bool enabled;
+static bool irqPending;
+static uint32_t modelStalls;
+
+static DmaPingPong pp;
+static bool rxDirection;
+static uint32_t errors;
+
+static uint8_t buffers[2][BENCH_MAX_BUFFER];
+
+/* Line position of every byte the controller stored, by buffer offset,
+ * and the positions lost */
+static uint32_t position[2][BENCH_MAX_BUFFER];
+static bool lostAt[BENCH_BYTES];
+
+static uint8_t bench_byte(uint32_t seq)
+{
+    return (uint8_t)(seq * 167 + (seq >> 8));
+}
+
+/* Controller: moves byte seq of the line through the current descriptor.
+ * Returns false if the channel is disabled. */
+static bool bench_dmaByte(uint8_t *byte, uint32_t seq)
+{
+    DmaBench_Descriptor *d = &desc[altSelect];
+
+    if(!enabled)
+        return false;
+
+    if(rxDirection)
+    {
+        position[0][d->ptr - buffers[0]] = seq;
+        *d->ptr++ = *byte;
+    }
+    else
+    {
+        *byte = *d->ptr++;
+    }
+
+    if(--d->left == 0)
+    {
+        d->armed = false;
+        irqPending = true;
+        altSelect ^= 1;
+        if(!desc[altSelect].armed)
+        {
+            enabled = false;
+            modelStalls += rxDirection;
+        }
+    }
+
+    return true;
+}
+
+/* DMA ISR: as uart_dma_service() */
+static void bench_service(void)
+{
+    int slot;
+
+    irqPending = false;
+
+    while((slot = dma_pp_activeSlot(&pp)) >= 0 && !desc[slot].armed)
+        dma_pp_complete(&pp);
+
+    if(enabled)
+        return;
+
+    slot = dma_pp_activeSlot(&pp);
+    if(slot < 0)
+    {
+        if(rxDirection && pp.running)
+            pp.stalls++;
+        pp.running = false;
+        return;
+    }
+
+    altSelect = (uint_fast8_t)slot;
+    pp.running = true;
+    enabled = true;
+}
+
+/* Thread: as uart_dma_give() */
+static bool bench_give(uint8_t *buf, uint16_t len)
+{
+    int slot = dma_pp_giveSlot(&pp);
+
+    if(slot < 0)
+        return false;
+
+    /* The controller must be done with whatever was behind the slot */
+    if(desc[slot].armed)
+        errors++;
+
+    desc[slot].ptr = buf;
+    desc[slot].left = len;
+    desc[slot].armed = true;
+    dma_pp_give(&pp, buf, len);
+
+    if(!pp.running)
+        irqPending = true;
+    return true;
+}
+
+/* Thread: a buffer back from the controller must not be in use by it */
+static uint8_t *bench_take(uint16_t *len)
+{
+    uint8_t *buf = dma_pp_take(&pp, len);
+    uint_fast8_t n;
+
+    for(n = 0; buf && n < 2; n++)
+        if(desc[n].armed && desc[n].ptr >= buf && desc[n].ptr < buf + *len)
+            errors++;
+
+    return buf;
+}
+
+static void bench_run(const DmaBench_Case *c)
+{
+    uint8_t *held = 0;
+    uint16_t heldLen = 0;
+    uint32_t busyUntil = 0;
+    uint32_t lineSeq = 0;           /* Next byte on the line             */
+    uint32_t appSeq = 0;            /* Next byte the application expects */
+    uint32_t at;
+    uint32_t lost = 0;
+    uint32_t handed = 0;
+    uint32_t now;
+    uint16_t n;
+
+    dma_pp_init(&pp);
+    desc[0].armed = desc[1].armed = false;
+    altSelect = 0;
+    enabled = false;
+    irqPending = false;
+    modelStalls = 0;
+    rxDirection = c->rx;
+    errors = 0;
+
+    if(c->rx)
+    {
+        bench_give(buffers[0], c->buffer);
+        bench_give(buffers[1], c->buffer);
+        bench_service();
+    }
+
+    for(now = 0; now < BENCH_BYTES; now++)
+    {
+        uint8_t byte = bench_byte(lineSeq);
+
+        /* The line: one byte time */
+        if(c->rx)
+        {
+            lostAt[lineSeq] = !bench_dmaByte(&byte, lineSeq);
+            lost += lostAt[lineSeq];
+            lineSeq++;
+        }
+        else if(bench_dmaByte(&byte, lineSeq))
+        {
+            if(byte != bench_byte(lineSeq))
+                errors++;
+            lineSeq++;
+        }
+
+        if(irqPending)
+            bench_service();
+
+        /* The application, when done with what it holds */
+        if(now < busyUntil)
+            continue;
+
+        if(c->rx)
+        {
+            if(held)
+            {
+                if(!bench_give(held, c->buffer))
+                    errors++;
+                held = 0;
+                if(irqPending)
+                    bench_service();
+            }
+
+            held = bench_take(&heldLen);
+            if(!held)
+                continue;
+
+            /* In line order, skipping lost bytes only */
+            for(n = 0; n < heldLen; n++)
+            {
+                at = position[0][held + n - buffers[0]];
+                while(appSeq < at)
+                    if(!lostAt[appSeq++])
+                        errors++;
+                if(at != appSeq++ || held[n] != bench_byte(at))
+                    errors++;
+            }
+            handed++;
+            busyUntil = now + c->process;
+        }
+        else
+        {
+            /* uart_dma_write(): reclaim, then queue the next buffer */
+            while(bench_take(&heldLen))
+                handed++;
+
+            if(dma_pp_giveSlot(&pp) < 0)
+                continue;
+            n = (uint16_t)dma_pp_giveSlot(&pp);
+            for(heldLen = 0; heldLen < c->buffer; heldLen++)
+                buffers[n][heldLen] = bench_byte(appSeq++);
+            bench_give(buffers[n], c->buffer);
+            if(irqPending)
+                bench_service();
+            busyUntil = now + c->process;
+        }
+    }
+
+    if(modelStalls != pp.stalls)
+        errors++;
+
+    printf("%s,%u,%u,%u,%u,%u,%u,%u\n", c->rx ? "rx" : "tx", c->buffer,
+           c->process, lineSeq, handed, pp.stalls, lost, errors);
+}
+
+int main(void)
+{
+    uint_fast8_t n;
+
+    printf("direction,buffer,process,bytes,buffers,stalls,lost,errors\n");
+    for(n = 0; n < sizeof(cases) / sizeof(cases[0]); n++)
+        bench_run(&cases[n]);
+
+    return 0;
+}
+
+#endif /* __MSP432P401R__ */
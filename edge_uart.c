@@ -0,0 +1,145 @@
+/******************************************************************************
+ * Software UART receiver from edge timestamps - decoder
+ *
+ * See edge_uart.h. Frame format is fixed to 8N1, LSB first.
+ *
+ * Each edge closes a run of the level before it. The number of cell
+ * centres the run covers is worked out with one division, and up to
+ * eight data cells of that run are shifted in with one shift and mask,
+ * so a byte of long runs costs a handful of operations.
+ *
+ *******************************************************************************/
+#include "edge_uart.h"
+#include "ramfunc.h"
+
+#define EDGE_UART_STOP_BIT      9
+
+bool edge_uart_init(EdgeUart *rx, uint32_t timerHz, uint32_t baud)
+{
+    uint64_t ticks;
+
+    if(baud == 0)
+        return false;
+
+    ticks = (((uint64_t)timerHz << 8) + baud / 2) / baud;
+    if(ticks < ((uint64_t)EDGE_UART_MIN_BIT_TICKS << 8) ||
+       ticks > ((uint64_t)EDGE_UART_MAX_BIT_TICKS << 8))
+        return false;
+
+    rx->bitTicks = (uint32_t)ticks;
+    rx->last = 0;
+    ring_init(&rx->rxRing, rx->rxStorage, EDGE_UART_RX_RING_SIZE);
+
+    rx->rxOverrun = 0;
+    rx->rxFraming = 0;
+    rx->rxGlitch = 0;
+    rx->resyncs = 0;
+
+    edge_uart_resync(rx, true);
+    return true;
+}
+
+void edge_uart_resync(EdgeUart *rx, bool lineHigh)
+{
+    rx->bit = EDGE_UART_IDLE;
+    rx->level = lineHigh;
+}
+
+/* Samples the current level into every cell whose centre lies before
+ * until (24.8 ticks from the start edge) */
+RAMFUNC static void edge_uart_run(EdgeUart *rx, uint32_t until)
+{
+    uint32_t cells;
+    uint32_t n;
+
+    if(rx->bit == EDGE_UART_IDLE || until <= rx->nextSample)
+        return;
+
+    cells = (until - rx->nextSample - 1) / rx->bitTicks + 1;
+
+    while(cells)
+    {
+        if(rx->bit == 0)
+        {
+            if(rx->level)
+            {
+                rx->rxGlitch++;
+                rx->bit = EDGE_UART_IDLE;
+                return;
+            }
+            n = 1;
+        }
+        else if(rx->bit < EDGE_UART_STOP_BIT)
+        {
+            n = EDGE_UART_STOP_BIT - rx->bit;
+            if(n > cells)
+                n = cells;
+
+            rx->shift = (uint8_t)(rx->shift >> n);
+            if(rx->level)
+                rx->shift |= (uint8_t)(0xFF << (8 - n));
+        }
+        else
+        {
+            if(!rx->level)
+                rx->rxFraming++;
+            else if(!ring_put(&rx->rxRing, rx->shift))
+                rx->rxOverrun++;
+            rx->bit = EDGE_UART_IDLE;
+            return;
+        }
+
+        rx->bit += n;
+        rx->nextSample += n * rx->bitTicks;
+        cells -= n;
+    }
+}
+
+RAMFUNC void edge_uart_decode(EdgeUart *rx, const uint16_t *edges,
+                              uint16_t count)
+{
+    uint16_t n;
+
+    for(n = 0; n < count; n++)
+    {
+        uint16_t t = edges[n];
+
+        edge_uart_run(rx, (uint32_t)(uint16_t)(t - rx->start) << 8);
+
+        /* A falling edge between frames is a start bit */
+        if(rx->bit == EDGE_UART_IDLE && rx->level)
+        {
+            rx->start = t;
+            rx->bit = 0;
+            rx->nextSample = rx->bitTicks / 2;
+        }
+
+        rx->level = !rx->level;
+        rx->last = t;
+    }
+}
+
+void edge_uart_flush(EdgeUart *rx, uint16_t now, bool lineHigh)
+{
+    uint32_t age = (uint16_t)(now - rx->last);
+
+    /* An edge already fed came after now: nothing to tell yet */
+    if(age > 0xFFFF - EDGE_UART_FLUSH_SKEW)
+        return;
+
+    if(rx->bit != EDGE_UART_IDLE)
+    {
+        uint32_t elapsed = (uint32_t)(uint16_t)(now - rx->start) << 8;
+
+        if(elapsed > rx->bitTicks)
+            edge_uart_run(rx, elapsed - rx->bitTicks);
+    }
+
+    /* Idle for a bit or more: the pin has the last word on the level */
+    if(rx->bit == EDGE_UART_IDLE && (age << 8) > rx->bitTicks &&
+       rx->level != lineHigh)
+    {
+        rx->level = lineHigh;
+        rx->resyncs++;
+    }
+}
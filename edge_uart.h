@@ -0,0 +1,121 @@
+/******************************************************************************
+ * Software UART receiver from edge timestamps - decoder
+ *
+ * Description: Rebuilds 8N1 bytes from the timestamps of the RX line's
+ * edges instead of sampling the pin from a timer ISR every bit. The
+ * capture hardware records each edge (see edge_uart_msp432.h, Timer_A
+ * capture moved out by uDMA) and edge_uart_decode() works through a whole
+ * batch of them at once, so the CPU cost is per batch and per run of
+ * equal bits rather than per bit, and the bit rate is limited by the
+ * capture resolution rather than by interrupt latency.
+ *
+ * The line level is known from the edge count: idle high, every edge
+ * flips it. A falling edge between frames starts one, and every cell is
+ * given the level in force at its centre, t_start + (k + 1/2) bit, the
+ * same point the eUSCI and gpio_uart.c sample. A run between two edges
+ * covers all the centres inside it in one step. That leaves half a bit of
+ * tolerance for edge jitter and for rate error accumulated over a frame.
+ *
+ *     start cell high    -> glitch, frame dropped (rxGlitch)
+ *     stop cell low      -> framing error, byte dropped (rxFraming)
+ *     RX ring full       -> byte dropped (rxOverrun)
+ *
+ * The cells after the last edge of a burst (at least the stop bit) have
+ * no edge to close them, so edge_uart_flush() has to be called now and
+ * then with the current time, which completes any frame whose cells lie
+ * a bit or more in the past. It also takes the line level read from the
+ * pin, which puts the level back right between frames should an edge
+ * ever be lost.
+ *
+ * Timestamps are 16-bit timer counts and only differences are used, so a
+ * frame and the bit of margin the flush keeps must fit half the timer
+ * range (EDGE_UART_MAX_BIT_TICKS), and a flush must come at least every
+ * 32768 ticks: one then always lands between the end of a frame and the
+ * timer wrapping past its start edge.
+ *
+ * Portable: no driverlib, the MSP432 capture lives in edge_uart_msp432.c.
+ * The decoder and the consumer of its RX ring may run in different
+ * contexts; decode and flush must stay in one.
+ *
+ *******************************************************************************/
+#ifndef EDGE_UART_H_
+#define EDGE_UART_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "ring_buffer.h"
+
+#ifndef EDGE_UART_RX_RING_SIZE
+#define EDGE_UART_RX_RING_SIZE  64
+#endif
+
+/* Shortest bit the decoder accepts: below this the half-bit tolerance is
+ * within a few ticks of the capture resolution */
+#define EDGE_UART_MIN_BIT_TICKS 8
+
+/* A frame and the flush margin, eleven bits, span at most half the
+ * 16-bit timer range */
+#define EDGE_UART_MAX_BIT_TICKS (0x8000 / 11)
+
+/* How far the last edge fed may lie after the time given to a flush, as
+ * when the capture runs on between reading the timer and the edges */
+#define EDGE_UART_FLUSH_SKEW    256
+
+/* Next cell to sample between frames */
+#define EDGE_UART_IDLE          0xFF
+
+typedef struct
+{
+    uint32_t bitTicks;              /* Bit period, 24.8 fixed point      */
+
+    uint16_t start;                 /* Start edge of the current frame   */
+    uint16_t last;                  /* Latest edge                       */
+    uint32_t nextSample;            /* Next cell centre from start, 24.8 */
+    uint8_t  bit;                   /* Next cell, 0 = start, 9 = stop    */
+    uint8_t  shift;
+    bool     level;                 /* Line level since the latest edge  */
+
+    RingBuffer rxRing;
+    uint8_t rxStorage[EDGE_UART_RX_RING_SIZE];
+
+    /* Error counters, wrap-around */
+    volatile uint16_t rxOverrun;
+    volatile uint16_t rxFraming;
+    volatile uint16_t rxGlitch;
+    volatile uint16_t resyncs;      /* Level corrected by a flush        */
+} EdgeUart;
+
+/* Sets up the decoder for timerHz/baud with the line idle. Returns false
+ * if a bit is shorter than EDGE_UART_MIN_BIT_TICKS or longer than
+ * EDGE_UART_MAX_BIT_TICKS. */
+extern bool edge_uart_init(EdgeUart *rx, uint32_t timerHz, uint32_t baud);
+
+/* Feeds count edge timestamps, oldest first */
+extern void edge_uart_decode(EdgeUart *rx, const uint16_t *edges,
+                             uint16_t count);
+
+/* Completes the frame, if any, whose cells now leaves at least a bit
+ * behind, and checks the level against lineHigh, read from the pin at
+ * now, once the line has been idle for a bit. now is a timer count read
+ * no more than EDGE_UART_FLUSH_SKEW ticks before the last edge fed. */
+extern void edge_uart_flush(EdgeUart *rx, uint16_t now, bool lineHigh);
+
+/* Drops any frame in progress and takes the line level as it is, e.g.
+ * after the capture lost edges */
+extern void edge_uart_resync(EdgeUart *rx, bool lineHigh);
+
+/* Fetches one received byte. Returns false if none is available. */
+static inline bool edge_uart_getc(EdgeUart *rx, uint8_t *byte)
+{
+    return ring_get(&rx->rxRing, byte);
+}
+
+/* Takes up to len received bytes. Returns the number copied. */
+static inline uint16_t edge_uart_read(EdgeUart *rx, uint8_t *buf,
+                                      uint16_t len)
+{
+    return ring_read(&rx->rxRing, buf, len);
+}
+
+#endif /* EDGE_UART_H_ */
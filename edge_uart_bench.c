@@ -0,0 +1,193 @@
+/******************************************************************************
+ * Edge-timestamp UART decoder - host simulation
+ *
+ * Description: Feeds edge_uart.c the edge timestamps of a simulated 8N1
+ * line, the way edge_uart_msp432.c does, and prints one CSV line per
+ * rate, jitter and rate error case:
+ *
+ *     baud,bit_ticks,jitter,offset_ppm,sent,received,errors,framing,
+ *     glitch,overrun,resyncs
+ *
+ * The capture timer counts SMCLK at BENCH_TIMER_HZ and wraps at 16 bits.
+ * Bytes from a fixed pseudo-random sequence are sent with a random idle
+ * gap of up to two bits between frames, at the rate given plus
+ * offset_ppm, and every edge is stamped with the tick it falls in plus up
+ * to jitter ticks. The edges go to the decoder in batches, as the DMA
+ * ISR hands over a half ring of BENCH_HALF_EDGES, or every BENCH_POLL
+ * ticks, as the compare does on a quiet line; every batch is followed by
+ * a flush with the time and the line level of the poll, and the RX ring
+ * is drained. errors counts received bytes that differ from the ones
+ * sent, plus bytes lost.
+ *
+ * Every case must come back with errors, framing, glitch, overrun and
+ * resyncs all 0. At 2 Mbaud a bit is 12 ticks and the half-bit tolerance
+ * 6, shared by the jitter, the rounding of the stamps and the rate error
+ * accumulated over a frame.
+ *
+ * Host only: the target build sees an empty file. Build and run with:
+ *
+ *     cc -std=gnu11 -O2 -I. edge_uart_bench.c edge_uart.c -o edge_uart_bench
+ *     ./edge_uart_bench
+ *
+ *******************************************************************************/
+#ifndef __MSP432P401R__
+
+#include <stdio.h>
+
+#include "edge_uart.h"
+
+#define BENCH_TIMER_HZ      24000000
+#define BENCH_BYTES         20000
+
+/* Half the capture ring of edge_uart_msp432.h, and its compare period */
+#define BENCH_HALF_EDGES    64
+#define BENCH_POLL          32768
+
+typedef struct
+{
+    uint32_t jitter;                /* Ticks added to a stamp, at most   */
+    int32_t  offsetPpm;             /* Sender rate error                 */
+} EdgeBench_Case;
+
+static const uint32_t rates[] = { 115200, 230400, 460800, 921600, 1000000,
+                                  1500000, 2000000 };
+
+static const EdgeBench_Case cases[] =
+{
+    { 0, 0 },
+    { 2, 0 },
+    { 0, 10000 },
+    { 0, -10000 },
+    { 2, 10000 },
+};
+
+static EdgeUart rx;
+
+static uint16_t pending[BENCH_HALF_EDGES];
+static uint16_t pendingCount;
+static uint64_t lastPoll;
+
+static uint32_t rxSeed;
+static uint32_t received;
+static uint32_t errors;
+
+static uint32_t rng;
+
+static uint32_t bench_random(void)
+{
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return rng;
+}
+
+/* Hands the pending edges over and flushes at tick now */
+static void bench_poll(uint64_t now, bool lineHigh)
+{
+    uint8_t byte;
+
+    edge_uart_decode(&rx, pending, pendingCount);
+    pendingCount = 0;
+    edge_uart_flush(&rx, (uint16_t)now, lineHigh);
+    lastPoll = now;
+
+    while(edge_uart_getc(&rx, &byte))
+    {
+        uint32_t save = rng;
+
+        rng = rxSeed;
+        if(byte != (uint8_t)bench_random())
+            errors++;
+        rxSeed = rng;
+        rng = save;
+        received++;
+    }
+}
+
+/* Stamps an edge at t, 24.8 ticks, after any compare poll due before it */
+static void bench_edge(uint64_t t, uint32_t jitter, bool levelBefore)
+{
+    uint64_t tick = (t >> 8) + bench_random() % (jitter + 1);
+
+    while(tick - lastPoll >= BENCH_POLL)
+        bench_poll(lastPoll + BENCH_POLL, levelBefore);
+
+    pending[pendingCount++] = (uint16_t)tick;
+    if(pendingCount == BENCH_HALF_EDGES)
+        bench_poll(tick, !levelBefore);
+}
+
+static void bench_run(uint32_t baud, const EdgeBench_Case *c)
+{
+    uint64_t bit;
+    uint64_t t;
+    uint32_t txSeed = 0x2545F491;
+    uint32_t sent;
+
+    rng = 0x9E3779B9;
+    rxSeed = txSeed;
+    received = 0;
+    errors = 0;
+    pendingCount = 0;
+    lastPoll = 0;
+
+    if(!edge_uart_init(&rx, BENCH_TIMER_HZ, baud))
+    {
+        printf("%u,rejected\n", baud);
+        return;
+    }
+
+    /* Sender bit in 24.8 ticks, off by offsetPpm */
+    bit = ((uint64_t)BENCH_TIMER_HZ << 8) * (1000000 + c->offsetPpm) /
+          ((uint64_t)baud * 1000000);
+    t = (uint64_t)BENCH_POLL << 8;
+
+    for(sent = 0; sent < BENCH_BYTES; sent++)
+    {
+        uint32_t save = rng;
+        uint16_t frame;
+        bool level = true;
+        uint_fast8_t k;
+
+        rng = txSeed;
+        frame = (uint16_t)((uint8_t)bench_random() << 1 | 0x200);
+        txSeed = rng;
+        rng = save;
+
+        /* Start, eight data bits LSB first, stop: an edge per change */
+        for(k = 0; k < 10; k++, frame >>= 1)
+        {
+            if((frame & 1) != level)
+            {
+                bench_edge(t + k * bit, c->jitter, level);
+                level = !level;
+            }
+        }
+
+        t += 10 * bit + bench_random() % (2 * bit + 1);
+    }
+
+    /* The last stop bit needs a poll a bit or more after it */
+    bench_poll((t >> 8) + (bit >> 8) + 1, true);
+
+    errors += sent - received;
+    printf("%u,%u,%u,%d,%u,%u,%u,%u,%u,%u,%u\n", baud, rx.bitTicks >> 8,
+           c->jitter, c->offsetPpm, sent, received, errors, rx.rxFraming,
+           rx.rxGlitch, rx.rxOverrun, rx.resyncs);
+}
+
+int main(void)
+{
+    uint_fast8_t r;
+    uint_fast8_t n;
+
+    printf("baud,bit_ticks,jitter,offset_ppm,sent,received,errors,framing,"
+           "glitch,overrun,resyncs\n");
+    for(r = 0; r < sizeof(rates) / sizeof(rates[0]); r++)
+        for(n = 0; n < sizeof(cases) / sizeof(cases[0]); n++)
+            bench_run(rates[r], &cases[n]);
+
+    return 0;
+}
+
+#endif /* __MSP432P401R__ */
@@ -0,0 +1,200 @@
+/******************************************************************************
+ * Software UART receiver from edge timestamps - MSP432 binding
+ *
+ * See edge_uart_msp432.h. The poll finds the controller's write position
+ * from the number of halves the DMA ISR has re-armed and the items left in
+ * the descriptor of the half after them. The ISR re-arms a half before
+ * counting it, so a poll it preempts can only see fewer edges than there
+ * are, never more: those wait for the next poll.
+ *
+ *******************************************************************************/
+/* DriverLib Includes */
+#include <ti/devices/msp432p4xx/driverlib/driverlib.h>
+
+#include "edge_uart_msp432.h"
+#include "dma_msp432.h"
+#include "cycle_stats.h"
+#include "noinit.h"
+
+#define EDGE_UART_PORT      GPIO_PORT_P2
+#define EDGE_UART_PIN       GPIO_PIN5
+#define EDGE_UART_DMA_CH    DMA_CH1_TIMERA0CCR2
+#define EDGE_UART_HALF      (EDGE_UART_CAPTURE_EDGES / 2)
+
+#define EDGE_CAPTURE_CCTL   EDGE_UART_TIMER->CCTL[EDGE_UART_CAPTURE_CCR]
+#define EDGE_POLL_CCTL      EDGE_UART_TIMER->CCTL[EDGE_UART_POLL_CCR]
+#define EDGE_POLL_CCR       EDGE_UART_TIMER->CCR[EDGE_UART_POLL_CCR]
+
+_Static_assert(EDGE_UART_CAPTURE_EDGES >= 4 &&
+               EDGE_UART_CAPTURE_EDGES <= 2048 &&
+               EDGE_UART_CAPTURE_EDGES % 2 == 0,
+               "EDGE_UART_CAPTURE_EDGES: an even count, 4 to 2048");
+
+static NOINIT uint16_t edgeRing[EDGE_UART_CAPTURE_EDGES];
+static EdgeUart *edgeRx = 0;
+static void (*edgeReady)(void) = 0;
+static volatile uint32_t halvesDone;    /* Re-armed by the DMA ISR       */
+static uint32_t edgesRead;              /* Fed to the decoder            */
+static volatile uint16_t lostEdges;
+
+/* Points a half's descriptor at its part of the ring */
+static void edge_uart_msp432_arm(uint_fast8_t slot)
+{
+    MAP_DMA_setChannelTransfer(EDGE_UART_DMA_CH | DMA_MSP432_SLOT_SEL(slot),
+            UDMA_MODE_PINGPONG,
+            (void *)&EDGE_UART_TIMER->CCR[EDGE_UART_CAPTURE_CCR],
+            &edgeRing[slot * EDGE_UART_HALF], EDGE_UART_HALF);
+}
+
+bool edge_uart_msp432_start(EdgeUart *rx, uint32_t baud,
+                            void (*ready)(void))
+{
+    const uint32_t control = UDMA_SIZE_16 | UDMA_SRC_INC_NONE |
+                             UDMA_DST_INC_16 | UDMA_ARB_1;
+
+    if(!edge_uart_init(rx, MAP_CS_getSMCLK(), baud))
+        return false;
+
+    edgeRx = rx;
+    edgeReady = ready;
+    halvesDone = 0;
+    edgesRead = 0;
+
+    MAP_GPIO_setAsPeripheralModuleFunctionInputPin(EDGE_UART_PORT,
+            EDGE_UART_PIN, GPIO_PRIMARY_MODULE_FUNCTION);
+
+    /* Timer_A0 free running from SMCLK: CCR2 captures both edges of
+     * CCI2A, CCR1 paces the flush */
+    EDGE_UART_TIMER->CTL = TIMER_A_CTL_SSEL__SMCLK | TIMER_A_CTL_CLR;
+    EDGE_CAPTURE_CCTL = TIMER_A_CCTLN_CM__BOTH | TIMER_A_CCTLN_CCIS__CCIA |
+                        TIMER_A_CCTLN_SCS | TIMER_A_CCTLN_CAP;
+    EDGE_POLL_CCR = 0x8000;
+    EDGE_POLL_CCTL = TIMER_A_CCTLN_CCIE;
+
+    /* A capture must not wait behind the UART's byte transfers */
+    dma_msp432_init();
+    MAP_DMA_assignChannel(EDGE_UART_DMA_CH);
+    MAP_DMA_disableChannelAttribute(EDGE_UART_DMA_CH, UDMA_ATTR_ALTSELECT |
+                                    UDMA_ATTR_USEBURST | UDMA_ATTR_REQMASK);
+    MAP_DMA_enableChannelAttribute(EDGE_UART_DMA_CH, UDMA_ATTR_HIGH_PRIORITY);
+    MAP_DMA_setChannelControl(EDGE_UART_DMA_CH | UDMA_PRI_SELECT, control);
+    MAP_DMA_setChannelControl(EDGE_UART_DMA_CH | UDMA_ALT_SELECT, control);
+    edge_uart_msp432_arm(0);
+    edge_uart_msp432_arm(1);
+
+    MAP_DMA_assignInterrupt(DMA_INT3, EDGE_UART_DMA_CH & 0x0F);
+    MAP_DMA_clearInterruptFlag(EDGE_UART_DMA_CH & 0x0F);
+    MAP_DMA_enableChannel(EDGE_UART_DMA_CH & 0x0F);
+
+    MAP_Interrupt_enableInterrupt(EDGE_UART_DMA_INT);
+    MAP_Interrupt_enableInterrupt(EDGE_UART_TIMER_INT);
+
+    EDGE_UART_TIMER->CTL |= TIMER_A_CTL_MC__CONTINUOUS;
+    return true;
+}
+
+void edge_uart_msp432_stop(void)
+{
+    MAP_Interrupt_disableInterrupt(EDGE_UART_TIMER_INT);
+    MAP_Interrupt_disableInterrupt(EDGE_UART_DMA_INT);
+    MAP_DMA_disableChannel(EDGE_UART_DMA_CH & 0x0F);
+    MAP_DMA_clearInterruptFlag(EDGE_UART_DMA_CH & 0x0F);
+
+    EDGE_UART_TIMER->CTL = 0;
+    EDGE_CAPTURE_CCTL = 0;
+    EDGE_POLL_CCTL = 0;
+    edgeRx = 0;
+}
+
+void edge_uart_msp432_poll(void)
+{
+    EdgeUart *rx = edgeRx;
+    uint16_t now;
+    bool lineHigh;
+    uint32_t halves;
+    uint32_t written;
+
+    if(!rx)
+        return;
+
+    CYCLE_STATS_BEGIN(EDGE_POLL);
+
+    /* Time and level first: every edge before them is then in the ring,
+     * the few captured since are allowed for by EDGE_UART_FLUSH_SKEW */
+    now = EDGE_UART_TIMER->R;
+    lineHigh = (EDGE_CAPTURE_CCTL & TIMER_A_CCTLN_CCI) != 0;
+    halves = halvesDone;
+    written = (halves + 1) * EDGE_UART_HALF -
+              MAP_DMA_getChannelSize(EDGE_UART_DMA_CH |
+                                     DMA_MSP432_SLOT_SEL(halves & 1));
+
+    if((EDGE_CAPTURE_CCTL & TIMER_A_CCTLN_COV) ||
+       written - edgesRead > EDGE_UART_CAPTURE_EDGES)
+    {
+        BITBAND_PERI(EDGE_CAPTURE_CCTL, TIMER_A_CCTLN_COV_OFS) = 0;
+        lostEdges++;
+        edgesRead = written;
+        edge_uart_resync(rx, lineHigh);
+    }
+    else
+    {
+        while(edgesRead != written)
+        {
+            uint32_t index = edgesRead % EDGE_UART_CAPTURE_EDGES;
+            uint32_t count = written - edgesRead;
+
+            if(count > EDGE_UART_CAPTURE_EDGES - index)
+                count = EDGE_UART_CAPTURE_EDGES - index;
+
+            edge_uart_decode(rx, &edgeRing[index], (uint16_t)count);
+            edgesRead += count;
+        }
+
+        edge_uart_flush(rx, now, lineHigh);
+    }
+
+    CYCLE_STATS_END(EDGE_POLL);
+}
+
+uint16_t edge_uart_msp432_lostEdges(void)
+{
+    return lostEdges;
+}
+
+/* DMA channel interrupt 3 - a half of the edge ring is full */
+void DMA_INT3_IRQHandler(void)
+{
+    uint_fast8_t slot;
+
+    MAP_DMA_clearInterruptFlag(EDGE_UART_DMA_CH & 0x0F);
+
+    /* Both halves may have filled before this ran */
+    while(MAP_DMA_getChannelMode(EDGE_UART_DMA_CH |
+                                 DMA_MSP432_SLOT_SEL(halvesDone & 1))
+              == UDMA_MODE_STOP)
+    {
+        edge_uart_msp432_arm(halvesDone & 1);
+        halvesDone++;
+    }
+
+    /* It stopped on a half that had not been re-armed yet */
+    if(!MAP_DMA_isChannelEnabled(EDGE_UART_DMA_CH & 0x0F))
+    {
+        slot = halvesDone & 1;
+        if(slot)
+            MAP_DMA_enableChannelAttribute(EDGE_UART_DMA_CH, UDMA_ATTR_ALTSELECT);
+        else
+            MAP_DMA_disableChannelAttribute(EDGE_UART_DMA_CH, UDMA_ATTR_ALTSELECT);
+        MAP_DMA_enableChannel(EDGE_UART_DMA_CH & 0x0F);
+    }
+
+    edgeReady();
+}
+
+/* Timer_A0 CCR1..6 ISR - flush pacing */
+void TA0_N_IRQHandler(void)
+{
+    BITBAND_PERI(EDGE_POLL_CCTL, TIMER_A_CCTLN_CCIFG_OFS) = 0;
+    EDGE_POLL_CCR += 0x8000;
+    edgeReady();
+}
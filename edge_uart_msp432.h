@@ -0,0 +1,68 @@
+/******************************************************************************
+ * Software UART receiver from edge timestamps - MSP432 binding
+ *
+ * Description: Feeds the decoder in edge_uart.c from Timer_A0 capturing
+ * both edges of P2.5 (TA0.2, CCI2A) while running free from SMCLK. Every
+ * capture requests uDMA channel 1, which moves CCR2 into a ring of
+ * EDGE_UART_CAPTURE_EDGES timestamps, so an edge costs the CPU nothing:
+ *
+ *     TA0.2 capture   -> uDMA ch 1 -> edge ring, two ping-pong halves
+ *     DMA_INT3        <- a half is full: re-arm it, call ready
+ *     TA0.1 compare   -> every 32768 ticks: call ready
+ *
+ * edge_uart_msp432_poll() decodes whatever the controller has written
+ * since the last call, half full or not, and flushes the decoder with the
+ * current count. The ready callback has it run at the deferred level,
+ * typically by posting an event_sched.h event whose handler polls, so
+ * decoding happens once per half ring of edges, per compare period, or
+ * whenever the application polls, never per edge. The compare keeps the flush
+ * going through idle lines as edge_uart.h requires.
+ *
+ * At SMCLK = 24 MHz a bit at 1 Mbaud is 24 ticks, half a bit of
+ * tolerance 12; the slowest rate is about 8 kbaud
+ * (EDGE_UART_MAX_BIT_TICKS). The controller has to keep up with the
+ * shortest run, one bit, before the next capture overwrites CCR2; a
+ * capture that comes too early sets COV, and the poll then drops the
+ * frame in progress and counts the loss. So does a poll that finds the
+ * ring lapped.
+ *
+ *******************************************************************************/
+#ifndef EDGE_UART_MSP432_H_
+#define EDGE_UART_MSP432_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <ti/devices/msp432p4xx/inc/msp.h>
+
+#include "edge_uart.h"
+
+#define EDGE_UART_TIMER         TA0
+#define EDGE_UART_TIMER_INT     INT_TA0_N
+#define EDGE_UART_CAPTURE_CCR   2
+#define EDGE_UART_POLL_CCR      1
+#define EDGE_UART_DMA_INT       INT_DMA_INT3
+
+/* Timestamps the controller can hold ahead of the decoder, in two halves */
+#ifndef EDGE_UART_CAPTURE_EDGES
+#define EDGE_UART_CAPTURE_EDGES 128
+#endif
+
+/* Sets up rx for baud from SMCLK, routes P2.5 to the capture input and
+ * starts capturing. ready is called from the DMA and compare ISRs when a
+ * poll is due. Returns false if the rate is out of range. */
+extern bool edge_uart_msp432_start(EdgeUart *rx, uint32_t baud,
+                                   void (*ready)(void));
+
+/* Stops the capture, the controller channel and both interrupts */
+extern void edge_uart_msp432_stop(void);
+
+/* Decodes every edge captured so far and flushes the decoder. From
+ * PendSV, or from one other context that DMA_INT3 may preempt. */
+extern void edge_uart_msp432_poll(void);
+
+/* Edge losses seen so far (capture overflows and lapped rings),
+ * wrap-around */
+extern uint16_t edge_uart_msp432_lostEdges(void);
+
+#endif /* EDGE_UART_MSP432_H_ */
@@ -0,0 +1,120 @@
+/******************************************************************************
+ * Event scheduler - run to completion
+ *
+ * See event_sched.h. A handler's bit is cleared before the handler is
+ * called, so a post that arrives while it runs, from an ISR or from the
+ * handler itself, runs it once more. After every handler the pending word is read
+ * again: an event of higher priority posted meanwhile goes next.
+ *
+ *******************************************************************************/
+#ifdef __MSP432P401R__
+#include <ti/devices/msp432p4xx/inc/msp.h>
+#define SCHED_FIRST(word)       __CLZ(word)
+#else
+#define SCHED_FIRST(word)       ((uint_fast8_t)__builtin_clz(word))
+#endif
+
+#include "event_sched.h"
+
+volatile uint32_t schedPending = 0;
+uint32_t schedDeferred = 0;
+#if CYCLE_STATS_ENABLE
+volatile uint32_t schedPostedAt[SCHED_MAX_EVENTS];
+#endif
+
+static Sched_Handler handlers[SCHED_MAX_EVENTS];
+static Sched_IdleHook idleHook = 0;
+
+void sched_init(void)
+{
+    uint_fast8_t n;
+
+    schedPending = 0;
+    schedDeferred = 0;
+    for(n = 0; n < SCHED_MAX_EVENTS; n++)
+        handlers[n] = 0;
+    idleHook = 0;
+}
+
+bool sched_register(uint_fast8_t event, Sched_Context context,
+                    Sched_Handler handler)
+{
+    uint32_t bit;
+
+    if(event >= SCHED_MAX_EVENTS)
+        return false;
+
+    bit = (uint32_t)1 << SCHED_BIT(event);
+    handlers[event] = handler;
+    if(context == SCHED_DEFERRED)
+        schedDeferred |= bit;
+    else
+        schedDeferred &= ~bit;
+    return true;
+}
+
+void sched_setIdleHook(Sched_IdleHook hook)
+{
+    idleHook = hook;
+}
+
+/* Runs the first pending event of mask. Returns false if there was none. */
+static bool sched_dispatch(uint32_t mask, CycleProbe probe)
+{
+    uint32_t ready = schedPending & mask;
+    uint_fast8_t event;
+    Sched_Handler handler;
+
+    if(!ready)
+        return false;
+
+    event = SCHED_FIRST(ready);
+    hal_bit_clear(&schedPending, SCHED_BIT(event));
+
+#if CYCLE_STATS_ENABLE
+    cycle_stats_latency(probe, CYCLE_STATS_NOW() - schedPostedAt[event]);
+#else
+    (void)probe;
+#endif
+
+    handler = handlers[event];
+    if(handler)
+        handler();
+    return true;
+}
+
+void sched_run(void)
+{
+    for(;;)
+    {
+        CYCLE_STATS_BEGIN(SCHED);
+        bool ran = sched_dispatch(~schedDeferred, CYCLE_PROBE_SCHED);
+        if(ran)
+        {
+            CYCLE_STATS_END(SCHED);
+            continue;
+        }
+
+        /* A post from an ISR taken after the test clears SLEEPONEXIT, and
+         * masked it still ends the WFI */
+        hal_irq_disable();
+        if(!sched_threadPending() && !(idleHook && idleHook()))
+        {
+            hal_sleepOnExit(true);
+            CYCLE_STATS_SLEEP();
+            hal_sleep();
+        }
+        hal_irq_enable();
+    }
+}
+
+/* PendSV - every pending deferred event, at the lowest priority */
+void PendSV_Handler(void)
+{
+    CYCLE_STATS_ISR_ENTER(PENDSV);
+
+    while(sched_dispatch(schedDeferred, CYCLE_PROBE_PENDSV))
+        ;
+
+    CYCLE_STATS_ISR_EXIT(PENDSV);
+}
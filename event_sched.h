@@ -0,0 +1,102 @@
+/******************************************************************************
+ * Event scheduler - run to completion
+ *
+ * Description: ISRs post events, handlers run later, one at a time and to
+ * completion, in priority order. An event is one bit of a pending word, so
+ * posting is a single atomic store (a bit-band write on the target) from
+ * any ISR at any level, and a handler runs once however many times its
+ * event was posted before it got to run. That is all the sources here
+ * need: each one leaves its data in a ring and only has to say "look".
+ *
+ * Event numbers are priorities, 0 highest, up to SCHED_MAX_EVENTS. Each
+ * is registered for one of two contexts:
+ *
+ *     SCHED_DEFERRED  PendSV_Handler, defined here, at IRQ_PRIO_DEFERRED
+ *                     (irq_priority.h): below every ISR, above the
+ *                     thread. Posting one pends PendSV (hal_defer()).
+ *     SCHED_THREAD    sched_run() in the main thread. Posting one clears
+ *                     SLEEPONEXIT so the ISR returns to the thread.
+ *
+ * sched_run() takes over the main loop: it runs the highest pending thread
+ * event, looks again, and once none is left sleeps in LPM0 with
+ * SLEEPONEXIT set, so ISRs and PendSV that post nothing for the thread
+ * return straight to sleep. An idle hook may sleep deeper instead.
+ *
+ * Measuring it: with CYCLE_STATS_ENABLE=1 each event is stamped when it is
+ * first posted, and the latency column of the PENDSV and SCHED probes is
+ * the worst delay from that post to its handler starting, per context.
+ * Their cycle columns are the PendSV pass and the thread handler times.
+ * event_sched_bench.c drives the same code on the host.
+ *
+ *******************************************************************************/
+#ifndef EVENT_SCHED_H_
+#define EVENT_SCHED_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "cycle_stats.h"
+#include "hal.h"
+
+#define SCHED_MAX_EVENTS        32
+
+/* Event e is bit 31 - e, so a count of leading zeros finds the first */
+#define SCHED_BIT(event)        (31u - (event))
+
+typedef enum
+{
+    SCHED_THREAD,
+    SCHED_DEFERRED
+} Sched_Context;
+
+typedef void (*Sched_Handler)(void);
+
+/* Sleeps instead of LPM0, called with interrupts masked when no thread
+ * event is pending. Returns false to have LPM0 after all. */
+typedef bool (*Sched_IdleHook)(void);
+
+extern volatile uint32_t schedPending;
+extern uint32_t schedDeferred;      /* Events run from PendSV            */
+#if CYCLE_STATS_ENABLE
+extern volatile uint32_t schedPostedAt[SCHED_MAX_EVENTS];
+#endif
+
+/* Drops every event and handler */
+extern void sched_init(void);
+
+/* Sets the handler of event and the context it runs in. Returns false if
+ * the event number is out of range. */
+extern bool sched_register(uint_fast8_t event, Sched_Context context,
+                           Sched_Handler handler);
+
+/* Runs in place of LPM0 when idle; NULL for LPM0 */
+extern void sched_setIdleHook(Sched_IdleHook hook);
+
+/* Dispatches thread events and sleeps in between. Does not return. */
+extern void sched_run(void);
+
+/* Marks event pending and wakes its context. Callable from any ISR and
+ * from the thread. */
+static inline void sched_post(uint_fast8_t event)
+{
+    uint32_t bit = (uint32_t)1 << SCHED_BIT(event);
+
+#if CYCLE_STATS_ENABLE
+    if(!(schedPending & bit))
+        schedPostedAt[event] = CYCLE_STATS_NOW();
+#endif
+    hal_bit_set(&schedPending, SCHED_BIT(event));
+
+    if(schedDeferred & bit)
+        hal_defer();
+    else
+        hal_sleepOnExit(false);
+}
+
+/* True while a thread event waits */
+static inline bool sched_threadPending(void)
+{
+    return (schedPending & ~schedDeferred) != 0;
+}
+
+#endif /* EVENT_SCHED_H_ */
@@ -0,0 +1,230 @@
+/******************************************************************************
+ * Event scheduler benchmark - host simulation
+ *
+ * Description: Drives event_sched.c from GPIO edge interrupts on the
+ * simulated hardware and prints one CSV line per load case:
+ *
+ *     thread_load,deferred_load,edges,posts,deferred_runs,thread_runs,
+ *     deferred_mean,deferred_worst,thread_mean,thread_worst,order_errors
+ *
+ * Timer32 fires at random intervals, BENCH_GAP cycles on average, and
+ * drives a falling edge on one of four ports. Each PORTx_IRQHandler posts
+ * its own event: ports 1 and 2 deferred ones, 3 and 4 thread ones, lower
+ * port first in priority. The handlers compute for the case's load, in
+ * simulated cycles. Every handler checks on entry that no event it should
+ * have yielded to is still pending, and order_errors counts the times one
+ * was: it must be 0. posts counts edges that found their event pending
+ * already and were merged into its next run, so runs + posts = edges.
+ *
+ * The mean and worst columns are the delay from the first post of an event
+ * to its handler starting, in SMCLK cycles; the worst ones are also the
+ * latency column of the PENDSV and SCHED probes. A thread handler's delay
+ * grows with the load of the thread handlers before it, a deferred one's
+ * only with the deferred load, which is what PendSV is for. The simulation
+ * charges no cycles to the scheduler itself and runs one interrupt at a
+ * time, so the figures are queueing delay alone, and an edge during a
+ * handler is posted once that handler is done.
+ *
+ * Host only: the target build sees an empty file. Build and run with:
+ *
+ *     cc -std=gnu11 -O2 -I. -DCYCLE_STATS_ENABLE=1 event_sched_bench.c \
+ *        event_sched.c cycle_stats.c hal_host.c -o event_sched_bench
+ *     ./event_sched_bench
+ *
+ *******************************************************************************/
+#ifndef __MSP432P401R__
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "event_sched.h"
+
+#if !CYCLE_STATS_ENABLE
+#error "event_sched_bench.c needs CYCLE_STATS_ENABLE=1"
+#endif
+
+/* Edges per case and mean cycles between them */
+#define BENCH_EDGES             20000
+#define BENCH_GAP               1000
+
+#define BENCH_PORTS             4
+#define BENCH_PIN               0x01
+
+/* Event n comes from port n + 1; the last one ends the case */
+#define EVENT_DONE              BENCH_PORTS
+
+typedef struct
+{
+    uint32_t threadLoad;            /* Cycles per thread handler         */
+    uint32_t deferredLoad;          /* Cycles per deferred handler       */
+} SchedBench_Case;
+
+static const SchedBench_Case cases[] =
+{
+    { 0, 0 },
+    { 200, 0 },
+    { 2000, 0 },
+    { 2000, 100 },
+    { 0, 400 },
+};
+
+typedef struct
+{
+    uint32_t posts;                 /* Edges merged into a pending event */
+    uint32_t runs;
+    uint64_t delay;
+} SchedBench_Count;
+
+static const SchedBench_Case *benchCase;
+static uint32_t edges;
+static uint32_t orderErrors;
+static SchedBench_Count count[BENCH_PORTS];
+
+static uint32_t rng = 0x2545F491;
+
+static uint32_t bench_random(void)
+{
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return rng;
+}
+
+static bool bench_deferred(uint_fast8_t event)
+{
+    return event < 2;
+}
+
+/* Timer32 - the next edge, on a random port, after a random gap */
+void T32_INT1_IRQHandler(void)
+{
+    uint_fast8_t port = (uint_fast8_t)(1 + bench_random() % BENCH_PORTS);
+
+    hal_oneshot_clear();
+
+    hal_host_gpioDrive(port, BENCH_PIN, false);
+    hal_host_gpioDrive(port, BENCH_PIN, true);
+
+    if(++edges < BENCH_EDGES)
+        hal_oneshot_start(1 + bench_random() % (2 * BENCH_GAP));
+    else
+        sched_post(EVENT_DONE);
+}
+
+static void bench_edge(uint_fast8_t port)
+{
+    uint_fast8_t event = port - 1;
+
+    hal_gpio_edgeClear(port, BENCH_PIN);
+    if(schedPending & ((uint32_t)1 << SCHED_BIT(event)))
+        count[event].posts++;
+    sched_post(event);
+}
+
+void PORT1_IRQHandler(void) { bench_edge(1); }
+void PORT2_IRQHandler(void) { bench_edge(2); }
+void PORT3_IRQHandler(void) { bench_edge(3); }
+void PORT4_IRQHandler(void) { bench_edge(4); }
+
+static void bench_handler(uint_fast8_t event)
+{
+    SchedBench_Count *c = &count[event];
+    uint32_t delay = CYCLE_STATS_NOW() - schedPostedAt[event];
+    uint32_t ahead = ~(((uint32_t)2 << SCHED_BIT(event)) - 1);
+    uint32_t yield;
+
+    /* Deferred events go before the thread, and before those after them;
+     * thread events before the thread events after them */
+    if(bench_deferred(event))
+        yield = schedDeferred & ahead;
+    else
+        yield = schedDeferred | (~schedDeferred & ahead);
+    if(schedPending & yield)
+        orderErrors++;
+
+    c->runs++;
+    c->delay += delay;
+
+    hal_host_run(bench_deferred(event) ? benchCase->deferredLoad :
+                                         benchCase->threadLoad);
+}
+
+static void bench_event0(void) { bench_handler(0); }
+static void bench_event1(void) { bench_handler(1); }
+static void bench_event2(void) { bench_handler(2); }
+static void bench_event3(void) { bench_handler(3); }
+
+static void bench_start(const SchedBench_Case *c)
+{
+    static const SchedBench_Count none;
+    uint_fast8_t n;
+
+    benchCase = c;
+    edges = 0;
+    orderErrors = 0;
+    for(n = 0; n < BENCH_PORTS; n++)
+        count[n] = none;
+    rng = 0x2545F491;
+
+    cycle_stats_init();
+    hal_oneshot_start(BENCH_GAP);
+}
+
+static void bench_report(void)
+{
+    const SchedBench_Count *d = &count[0];
+    const SchedBench_Count *t = &count[2];
+    uint32_t deferredRuns = d[0].runs + d[1].runs;
+    uint32_t threadRuns = t[0].runs + t[1].runs;
+
+    printf("%u,%u,%u,%u,%u,%u,%.1f,%u,%.1f,%u,%u\n",
+           benchCase->threadLoad, benchCase->deferredLoad, edges,
+           d[0].posts + d[1].posts + t[0].posts + t[1].posts,
+           deferredRuns, threadRuns,
+           deferredRuns ? (double)(d[0].delay + d[1].delay) / deferredRuns : 0.0,
+           cycleStats.probe[CYCLE_PROBE_PENDSV].latencyMax,
+           threadRuns ? (double)(t[0].delay + t[1].delay) / threadRuns : 0.0,
+           cycleStats.probe[CYCLE_PROBE_SCHED].latencyMax,
+           orderErrors);
+}
+
+/* Lowest priority: every edge of the case has been handled */
+static void bench_done(void)
+{
+    bench_report();
+
+    if(++benchCase == &cases[sizeof(cases) / sizeof(cases[0])])
+        exit(0);
+    bench_start(benchCase);
+}
+
+int main(void)
+{
+    uint_fast8_t port;
+
+    sched_init();
+    sched_register(0, SCHED_DEFERRED, bench_event0);
+    sched_register(1, SCHED_DEFERRED, bench_event1);
+    sched_register(2, SCHED_THREAD, bench_event2);
+    sched_register(3, SCHED_THREAD, bench_event3);
+    sched_register(EVENT_DONE, SCHED_THREAD, bench_done);
+
+    for(port = 1; port <= BENCH_PORTS; port++)
+    {
+        hal_gpio_input(port, BENCH_PIN);
+        hal_gpio_edgeSelect(port, BENCH_PIN, true);
+        hal_gpio_edgeClear(port, BENCH_PIN);
+        hal_gpio_edgeIe(port, BENCH_PIN, true);
+        hal_gpio_irqEnable(port);
+    }
+    hal_oneshot_init();
+
+    printf("thread_load,deferred_load,edges,posts,deferred_runs,thread_runs,"
+           "deferred_mean,deferred_worst,thread_mean,thread_worst,"
+           "order_errors\n");
+
+    bench_start(&cases[0]);
+    sched_run();
+}
+
+#endif /* __MSP432P401R__ */
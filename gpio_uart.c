@@ -0,0 +1,215 @@
+/******************************************************************************
+ * Software UART on arbitrary GPIO pins - bit engine
+ *
+ * See gpio_uart.h. Frame format is fixed to 8N1, LSB first.
+ *
+ * TX: the level for the next compare is computed one bit ahead, so the
+ * compare ISR writes the pin as its very first store. Edge jitter is then
+ * only the interrupt entry variance, independent of the bookkeeping below.
+ *
+ * RX: the edge ISR schedules the first sample half a bit after the start
+ * edge to confirm the start bit, then one sample per bit cell for the eight
+ * data bits and the stop bit.
+ *
+ *******************************************************************************/
+#include "gpio_uart.h"
+#include "ramfunc.h"
+
+/* Below this many timer ticks per bit TX and RX ISRs cannot keep up */
+#define GPIO_UART_MIN_BIT_TICKS     64
+
+/* Start bit + 8 data bits + stop bit, LSB first */
+#define GPIO_UART_FRAME(b)          ((uint16_t)(0x200u | ((uint16_t)(b) << 1)))
+#define GPIO_UART_FRAME_BITS        10
+
+static inline void gpio_uart_advance(uint32_t *phase, uint32_t bitTicks,
+                                     volatile uint16_t *ccr)
+{
+    *phase += bitTicks;
+    *ccr = (uint16_t)(*phase >> 8);
+}
+
+/* Loads a frame so that its start bit is driven at the next compare */
+static inline void gpio_uart_loadFrame(GpioUart *uart, uint8_t byte)
+{
+    uint16_t frame = GPIO_UART_FRAME(byte);
+
+    uart->txLevel = frame & 1;
+    uart->txFrame = frame >> 1;
+    uart->txBits  = GPIO_UART_FRAME_BITS - 1;
+}
+
+bool gpio_uart_init(GpioUart *uart, const GpioUart_Hw *hw,
+                    uint32_t timerHz, uint32_t baud)
+{
+    uint64_t ticks;
+
+    if(baud == 0)
+        return false;
+
+    ticks = (((uint64_t)timerHz << 8) + baud / 2) / baud;
+    if(ticks < ((uint64_t)GPIO_UART_MIN_BIT_TICKS << 8) ||
+       ticks >= ((uint64_t)0x10000 << 8))
+        return false;
+
+    uart->hw = *hw;
+    uart->bitTicks = (uint32_t)ticks;
+
+    uart->txActive = false;
+    uart->txDone = false;
+    uart->txFull = false;
+    uart->txBits = 0;
+    uart->txLevel = 1;
+
+    uart->rxFull = false;
+    uart->rxBits = 0;
+    uart->rxOverrun = 0;
+    uart->rxFraming = 0;
+    uart->rxGlitch = 0;
+
+    *hw->txCcie = 0;
+    *hw->rxCcie = 0;
+    *hw->txOut = 1;
+
+    *hw->rxEdgeIfg = 0;
+    *hw->rxEdgeIe = 1;
+
+    return true;
+}
+
+bool gpio_uart_putc(GpioUart *uart, uint8_t byte)
+{
+    if(uart->txFull)
+        return false;
+
+    /* Mask the TX compare so the ISR cannot retire the transmitter between
+     * the txActive test and the hand-off. A compare that fires meanwhile is
+     * serviced as soon as the enable is restored. */
+    *uart->hw.txCcie = 0;
+
+    if(uart->txActive)
+    {
+        uart->txHold = byte;
+        uart->txFull = true;
+    }
+    else
+    {
+        gpio_uart_loadFrame(uart, byte);
+        uart->txDone = false;
+        uart->txActive = true;
+        uart->txPhase = (uint32_t)(uint16_t)(*uart->hw.timer +
+                                             GPIO_UART_TX_LEAD_TICKS) << 8;
+        *uart->hw.txCcr = (uint16_t)(uart->txPhase >> 8);
+        *uart->hw.txCcifg = 0;
+    }
+
+    *uart->hw.txCcie = 1;
+    return true;
+}
+
+RAMFUNC bool gpio_uart_getc(GpioUart *uart, uint8_t *byte)
+{
+    if(!uart->rxFull)
+        return false;
+
+    *byte = uart->rxHold;
+    uart->rxFull = false;
+    return true;
+}
+
+RAMFUNC void gpio_uart_txIsr(GpioUart *uart)
+{
+    *uart->hw.txOut = uart->txLevel;
+    *uart->hw.txCcifg = 0;
+
+    if(uart->txBits != 0)
+    {
+        uart->txLevel = uart->txFrame & 1;
+        uart->txFrame >>= 1;
+        uart->txBits--;
+    }
+    else if(uart->txFull)
+    {
+        /* Stop bit just started: chain the next start bit back-to-back */
+        gpio_uart_loadFrame(uart, uart->txHold);
+        uart->txFull = false;
+        uart->txDone = false;
+    }
+    else if(!uart->txDone)
+    {
+        /* Hold the line idle for the full stop bit before retiring */
+        uart->txLevel = 1;
+        uart->txDone = true;
+    }
+    else
+    {
+        *uart->hw.txCcie = 0;
+        uart->txActive = false;
+        return;
+    }
+
+    gpio_uart_advance(&uart->txPhase, uart->bitTicks, uart->hw.txCcr);
+}
+
+RAMFUNC void gpio_uart_rxEdgeIsr(GpioUart *uart)
+{
+    uint16_t start = (uint16_t)(*uart->hw.timer - GPIO_UART_RX_LATENCY_TICKS);
+
+    *uart->hw.rxEdgeIe = 0;
+    *uart->hw.rxEdgeIfg = 0;
+
+    uart->rxBits = GPIO_UART_FRAME_BITS;
+    uart->rxPhase = ((uint32_t)start << 8) + uart->bitTicks / 2;
+    *uart->hw.rxCcr = (uint16_t)(uart->rxPhase >> 8);
+    *uart->hw.rxCcifg = 0;
+    *uart->hw.rxCcie = 1;
+}
+
+RAMFUNC void gpio_uart_rxIsr(GpioUart *uart)
+{
+    uint32_t level = *uart->hw.rxIn;
+
+    *uart->hw.rxCcifg = 0;
+
+    switch(--uart->rxBits)
+    {
+    case GPIO_UART_FRAME_BITS - 1:
+        /* Middle of the start bit */
+        if(level)
+        {
+            uart->rxGlitch++;
+            break;
+        }
+        gpio_uart_advance(&uart->rxPhase, uart->bitTicks, uart->hw.rxCcr);
+        return;
+    case 0:
+        /* Middle of the stop bit */
+        if(!level)
+        {
+            uart->rxFraming++;
+            break;
+        }
+        if(uart->rxFull)
+            uart->rxOverrun++;
+        uart->rxHold = uart->rxShift;
+        uart->rxFull = true;
+        break;
+    default:
+        uart->rxShift = (uint8_t)((uart->rxShift >> 1) | (level << 7));
+        gpio_uart_advance(&uart->rxPhase, uart->bitTicks, uart->hw.rxCcr);
+        return;
+    }
+
+    /* Frame finished or aborted: wait for the next start edge */
+    *uart->hw.rxCcie = 0;
+    *uart->hw.rxEdgeIfg = 0;
+    *uart->hw.rxEdgeIe = 1;
+}
+
+RAMFUNC void gpio_uart_timerIsr(GpioUart *uart)
+{
+    if(*uart->hw.txCcie && *uart->hw.txCcifg)
+        gpio_uart_txIsr(uart);
+    if(*uart->hw.rxCcie && *uart->hw.rxCcifg)
+        gpio_uart_rxIsr(uart);
+}
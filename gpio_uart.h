@@ -0,0 +1,116 @@
+/******************************************************************************
+ * Software UART on arbitrary GPIO pins - bit engine
+ *
+ * Description: 8N1 UART driven entirely by timer compare interrupts and a
+ * GPIO edge interrupt. TX levels are written to the pin from a compare
+ * channel, RX start bits are detected by a falling-edge port interrupt and
+ * every following bit is sampled in the middle of its cell by a second
+ * compare channel.
+ *
+ * The engine never touches driverlib: every register it needs is reached
+ * through the pointers in GpioUart_Hw. On the MSP432 those point at the
+ * bit-band aliases of the port bits and at the Timer_A CCR/CCTL registers
+ * (see gpio_uart_msp432.c); on a host build they can point at plain
+ * variables that a simulated timer and pin update.
+ *
+ * Bit timing is kept in 24.8 fixed point so that the fractional part of
+ * the bit period (e.g. 208.33 ticks for 115200 baud at 24 MHz) does not
+ * accumulate into drift across a frame.
+ *
+ *******************************************************************************/
+#ifndef GPIO_UART_H_
+#define GPIO_UART_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Ticks between arming the TX channel and the first (start bit) edge */
+#ifndef GPIO_UART_TX_LEAD_TICKS
+#define GPIO_UART_TX_LEAD_TICKS     64
+#endif
+
+/* Timer ticks between the RX start edge and the timer read in the edge ISR.
+ * Subtracted from the captured time so that samples land mid-bit. */
+#ifndef GPIO_UART_RX_LATENCY_TICKS
+#define GPIO_UART_RX_LATENCY_TICKS  20
+#endif
+
+/* Register access points used by the engine. Single-bit entries are 0/1
+ * words (bit-band aliases on target). */
+typedef struct
+{
+    volatile uint32_t *txOut;       /* TX pin output level               */
+    volatile uint16_t *txCcr;       /* TX compare register               */
+    volatile uint32_t *txCcie;      /* TX compare interrupt enable       */
+    volatile uint32_t *txCcifg;     /* TX compare interrupt flag         */
+
+    volatile uint32_t *rxIn;        /* RX pin input level                */
+    volatile uint32_t *rxEdgeIe;    /* RX pin edge interrupt enable      */
+    volatile uint32_t *rxEdgeIfg;   /* RX pin edge interrupt flag        */
+    volatile uint16_t *rxCcr;       /* RX sample compare register        */
+    volatile uint32_t *rxCcie;      /* RX compare interrupt enable       */
+    volatile uint32_t *rxCcifg;     /* RX compare interrupt flag         */
+
+    volatile const uint16_t *timer; /* Free running timer count          */
+} GpioUart_Hw;
+
+typedef struct
+{
+    GpioUart_Hw hw;
+    uint32_t bitTicks;              /* Bit period, 24.8 fixed point      */
+
+    /* Transmitter */
+    uint32_t txPhase;               /* Next TX edge, 24.8 fixed point    */
+    uint16_t txFrame;               /* Levels still to be driven         */
+    uint8_t  txBits;                /* Number of levels left in txFrame  */
+    uint8_t  txLevel;               /* Level driven at the next compare  */
+    volatile bool txActive;
+    volatile bool txDone;
+    volatile bool txFull;           /* txHold owns a byte                */
+    volatile uint8_t txHold;
+
+    /* Receiver */
+    uint32_t rxPhase;               /* Next RX sample, 24.8 fixed point  */
+    uint8_t  rxShift;
+    uint8_t  rxBits;
+    volatile bool rxFull;           /* rxHold owns a byte                */
+    volatile uint8_t rxHold;
+
+    /* Error counters, wrap-around */
+    volatile uint16_t rxOverrun;
+    volatile uint16_t rxFraming;
+    volatile uint16_t rxGlitch;
+} GpioUart;
+
+/* Sets up the engine for timerHz/baud. Returns false if a bit does not fit
+ * the 16-bit timer or is too short to be serviced. Pins must already be
+ * configured; both compare channels are left disabled and the RX edge
+ * interrupt is armed. */
+extern bool gpio_uart_init(GpioUart *uart, const GpioUart_Hw *hw,
+                           uint32_t timerHz, uint32_t baud);
+
+/* Queues one byte. Returns false if the holding register is still full. */
+extern bool gpio_uart_putc(GpioUart *uart, uint8_t byte);
+
+/* Fetches one received byte. Returns false if none is available. */
+extern bool gpio_uart_getc(GpioUart *uart, uint8_t *byte);
+
+/* True while a frame is on the wire or waiting in the holding register */
+static inline bool gpio_uart_txBusy(const GpioUart *uart)
+{
+    return uart->txActive || uart->txFull;
+}
+
+/* Interrupt entry points: TX compare, RX edge and RX compare. The caller's
+ * ISR must only call these when the matching flag is set and enabled. */
+extern void gpio_uart_txIsr(GpioUart *uart);
+extern void gpio_uart_rxEdgeIsr(GpioUart *uart);
+extern void gpio_uart_rxIsr(GpioUart *uart);
+
+/* Shared compare vector: runs the TX and RX compare ISRs whose channel is
+ * enabled and flagged. The timer sets a channel's flag on every match,
+ * enabled or not, and keeps running for the other channel, so the flag
+ * of an idle channel alone means nothing. */
+extern void gpio_uart_timerIsr(GpioUart *uart);
+
+#endif /* GPIO_UART_H_ */
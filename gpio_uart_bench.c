@@ -0,0 +1,290 @@
+/******************************************************************************
+ * Software UART bit engine loopback - host simulation
+ *
+ * Description: Runs gpio_uart.c against a simulated Timer_A and pin and
+ * prints one CSV line per mode, rate and jitter case:
+ *
+ *     mode,baud,bit_ticks,jitter,wraps,sent,received,errors,framing,
+ *     glitch,overrun
+ *
+ * The timer counts SMCLK at BENCH_TIMER_HZ and is stepped one tick at a
+ * time. As on Timer_A, a compare match sets the channel's flag whether
+ * its interrupt is enabled or not; the shared vector is pending while an
+ * enabled channel is flagged, and BENCH_ISR_TICKS later it runs
+ * gpio_uart_timerIsr(), the body GPIO_UART_MSP432_TIMER_ISR() expands to.
+ * The RX edge ISR runs GPIO_UART_RX_LATENCY_TICKS after the falling edge,
+ * the figure the engine corrects for. jitter adds up to that many ticks
+ * to every entry, as other interrupts would. errors counts received bytes
+ * that differ from the ones sent, plus bytes lost or made up.
+ *
+ *     loopback   TX wired back to RX, BENCH_BYTES queued back to back
+ *     txonly     TX busy, RX pin held idle for wraps timer wraps: the RX
+ *                compare flag comes up on every wrap and must not be
+ *                taken for a sample, received must be 0
+ *     rxonly     RX fed by a bench-generated line, TX idle for wraps
+ *                timer wraps: TX must hold the line high throughout
+ *
+ * Without jitter every case must come back with errors, framing, glitch
+ * and overrun all 0. Jitter hits a frame three times, on the TX edge, the
+ * start edge and the sample, against a margin of half a bit less
+ * BENCH_ISR_TICKS: at the two fastest rates the jittered cases show where
+ * that margin runs out, not a fault.
+ *
+ * The engine's register words (GpioUart_Hw) point at plain variables
+ * this file updates, as gpio_uart.h intends for a host build.
+ *
+ * Host only: the target build sees an empty file. Build and run with:
+ *
+ *     cc -std=gnu11 -O2 -I. gpio_uart_bench.c gpio_uart.c -o gpio_uart_bench
+ *     ./gpio_uart_bench
+ *
+ *******************************************************************************/
+#ifndef __MSP432P401R__
+
+#include <stdio.h>
+
+#include "gpio_uart.h"
+
+#define BENCH_TIMER_HZ      24000000
+#define BENCH_BYTES         2000
+
+/* Timer wraps the one-sided modes run for */
+#define BENCH_WRAPS         600
+
+/* Compare match to the pin write in the TX ISR, without jitter */
+#define BENCH_ISR_TICKS     12
+
+#define BENCH_NEVER         UINT64_MAX
+
+typedef enum
+{
+    MODE_LOOPBACK,
+    MODE_TXONLY,
+    MODE_RXONLY
+} GpioUartBench_Mode;
+
+static const char *const modeNames[] = { "loopback", "txonly", "rxonly" };
+
+typedef struct
+{
+    GpioUartBench_Mode mode;
+    uint32_t baud;
+    uint32_t jitter;
+} GpioUartBench_Case;
+
+static const uint32_t rates[] = { 9600, 19200, 57600, 115200, 230400, 375000 };
+static const uint32_t jitters[] = { 0, 8, 24 };
+
+static const GpioUartBench_Case idleCases[] =
+{
+    { MODE_TXONLY, 9600, 0 },
+    { MODE_TXONLY, 115200, 0 },
+    { MODE_TXONLY, 375000, 8 },
+    { MODE_RXONLY, 9600, 0 },
+    { MODE_RXONLY, 115200, 0 },
+    { MODE_RXONLY, 375000, 8 },
+};
+
+/* The simulated hardware */
+static uint32_t txOut;
+static uint32_t rxLine;
+static uint16_t txCcr;
+static uint32_t txCcie;
+static uint32_t txCcifg;
+static uint32_t rxEdgeIe;
+static uint32_t rxEdgeIfg;
+static uint16_t rxCcr;
+static uint32_t rxCcie;
+static uint32_t rxCcifg;
+static uint16_t timer;
+
+static GpioUart_Hw hw =
+{
+    &txOut, &txCcr, &txCcie, &txCcifg,
+    &txOut, &rxEdgeIe, &rxEdgeIfg, &rxCcr, &rxCcie, &rxCcifg,
+    &timer
+};
+
+static uint32_t rng;
+
+static uint32_t bench_random(void)
+{
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return rng;
+}
+
+/* Next byte of a sequence kept in its own state */
+static uint8_t bench_next(uint32_t *seed)
+{
+    uint32_t save = rng;
+    uint8_t byte;
+
+    rng = *seed;
+    byte = (uint8_t)bench_random();
+    *seed = rng;
+    rng = save;
+    return byte;
+}
+
+/* The bench's own transmitter for rxonly: 8N1 frames with one idle bit
+ * between them, bit times in 24.8 ticks from the start of the run */
+typedef struct
+{
+    uint32_t seed;
+    uint32_t frame;                 /* Frames started                    */
+    uint8_t  byte;
+} GpioUartBench_Line;
+
+static uint32_t bench_lineLevel(GpioUartBench_Line *line, uint64_t now,
+                                uint32_t bitTicks, uint64_t stopAt)
+{
+    uint64_t bit = (now << 8) / bitTicks;
+    uint32_t frame = (uint32_t)(bit / 11);
+    uint32_t k = (uint32_t)(bit % 11);
+
+    if(frame >= line->frame)
+    {
+        if(now >= stopAt)
+            return 1;
+        line->byte = bench_next(&line->seed);
+        line->frame++;
+    }
+
+    if(k == 0)
+        return 0;
+    if(k <= 8)
+        return (line->byte >> (k - 1)) & 1;
+    return 1;
+}
+
+static void bench_run(const GpioUartBench_Case *c)
+{
+    static GpioUart uart;
+    GpioUartBench_Line line = { 0x2545F491, 0, 0 };
+    uint64_t now = 0;
+    uint64_t isrAt = BENCH_NEVER;
+    uint64_t rxEdgeAt = BENCH_NEVER;
+    uint64_t deadline;
+    uint64_t stopAt;
+    uint32_t lastLine = 1;
+    uint32_t txSeed = 0x2545F491;
+    uint32_t rxSeed = 0x2545F491;
+    uint32_t sent = 0;
+    uint32_t received = 0;
+    uint32_t errors = 0;
+    uint32_t frameTicks;
+    uint8_t byte;
+
+    timer = 0;
+    rng = 0x9E3779B9;
+    rxLine = 1;
+    hw.rxIn = c->mode == MODE_LOOPBACK ? &txOut : &rxLine;
+    if(!gpio_uart_init(&uart, &hw, BENCH_TIMER_HZ, c->baud))
+    {
+        printf("%s,%u,rejected\n", modeNames[c->mode], c->baud);
+        return;
+    }
+    txCcr = rxCcr = 0;
+    txCcifg = rxCcifg = 0;
+
+    /* Every byte plus two frames of slack, or the wraps; nothing new is
+     * sent in the last three frames */
+    frameTicks = (10 * uart.bitTicks >> 8) + 1;
+    if(c->mode == MODE_LOOPBACK)
+        deadline = (uint64_t)(BENCH_BYTES + 2) * frameTicks + 1000;
+    else
+        deadline = (uint64_t)BENCH_WRAPS << 16;
+    stopAt = deadline - 3 * (uint64_t)frameTicks;
+
+    for(; now < deadline; now++, timer++)
+    {
+        /* Thread: keep the holding register full, drain the receiver */
+        if(c->mode != MODE_RXONLY &&
+           (c->mode == MODE_LOOPBACK ? sent < BENCH_BYTES : now < stopAt))
+        {
+            uint32_t seed = txSeed;
+
+            if(gpio_uart_putc(&uart, bench_next(&seed)))
+            {
+                txSeed = seed;
+                sent++;
+            }
+        }
+        while(gpio_uart_getc(&uart, &byte))
+        {
+            if(c->mode == MODE_TXONLY || byte != bench_next(&rxSeed))
+                errors++;
+            received++;
+        }
+
+        if(c->mode == MODE_RXONLY)
+        {
+            rxLine = bench_lineLevel(&line, now, uart.bitTicks, stopAt);
+            sent = line.frame;
+            if(!txOut)
+                errors++;
+        }
+
+        /* Compare matches set the flag, enabled or not, and the edge */
+        if(timer == txCcr)
+            txCcifg = 1;
+        if(timer == rxCcr)
+            rxCcifg = 1;
+        if(lastLine && !*hw.rxIn)
+            rxEdgeIfg = 1;
+        lastLine = *hw.rxIn;
+
+        if(isrAt == BENCH_NEVER &&
+           ((txCcie && txCcifg) || (rxCcie && rxCcifg)))
+            isrAt = now + BENCH_ISR_TICKS + bench_random() % (c->jitter + 1);
+        if(rxEdgeIfg && rxEdgeIe && rxEdgeAt == BENCH_NEVER)
+            rxEdgeAt = now + GPIO_UART_RX_LATENCY_TICKS +
+                       bench_random() % (c->jitter + 1);
+
+        /* ISRs that are due, if still pending */
+        if(now >= isrAt)
+        {
+            isrAt = BENCH_NEVER;
+            gpio_uart_timerIsr(&uart);
+        }
+        if(now >= rxEdgeAt)
+        {
+            rxEdgeAt = BENCH_NEVER;
+            if(rxEdgeIe)
+                gpio_uart_rxEdgeIsr(&uart);
+        }
+    }
+
+    if(c->mode != MODE_TXONLY)
+        errors += sent - received;
+    printf("%s,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u\n", modeNames[c->mode],
+           c->baud, uart.bitTicks >> 8, c->jitter,
+           (uint32_t)(deadline >> 16), sent, received, errors,
+           uart.rxFraming, uart.rxGlitch, uart.rxOverrun);
+}
+
+int main(void)
+{
+    uint_fast8_t r;
+    uint_fast8_t j;
+
+    printf("mode,baud,bit_ticks,jitter,wraps,sent,received,errors,framing,"
+           "glitch,overrun\n");
+    for(r = 0; r < sizeof(rates) / sizeof(rates[0]); r++)
+    {
+        for(j = 0; j < sizeof(jitters) / sizeof(jitters[0]); j++)
+        {
+            GpioUartBench_Case c = { MODE_LOOPBACK, rates[r], jitters[j] };
+
+            bench_run(&c);
+        }
+    }
+    for(r = 0; r < sizeof(idleCases) / sizeof(idleCases[0]); r++)
+        bench_run(&idleCases[r]);
+
+    return 0;
+}
+
+#endif /* __MSP432P401R__ */
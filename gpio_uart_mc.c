@@ -0,0 +1,140 @@
+/******************************************************************************
+ * Multi-channel software UART - shared oversampling tick
+ *
+ * See gpio_uart_mc.h. Frame format is fixed to 8N1, LSB first.
+ *
+ * TX: txShift holds the frame with the start bit in bit 0 and the stop bit
+ * as the MSB, so once it has shifted down to zero the line is idle and the
+ * holding register can be loaded at the very next bit boundary.
+ *
+ * RX: an idle channel polls its pin every tick. The first low sample arms a
+ * countdown of OVERSAMPLE/2 ticks to the middle of the start bit, then one
+ * sample every OVERSAMPLE ticks for data and stop bits.
+ *
+ *******************************************************************************/
+#include "gpio_uart_mc.h"
+#include "ramfunc.h"
+
+#if GPIO_UART_MC_OVERSAMPLE < 2 || GPIO_UART_MC_OVERSAMPLE > 255
+#error "GPIO_UART_MC_OVERSAMPLE must be in 2..255"
+#endif
+
+/* Start bit + 8 data bits + stop bit, LSB first */
+#define GPIO_UART_MC_FRAME(b)       ((uint16_t)(0x200u | ((uint16_t)(b) << 1)))
+#define GPIO_UART_MC_FRAME_BITS     10
+
+/* Stand-ins for unused pins, so the tick never tests for NULL. An idle RX
+ * line reads high. */
+static uint32_t gpio_uart_mc_txSink;
+static const uint32_t gpio_uart_mc_rxIdle = 1;
+
+void gpio_uart_mc_init(GpioUartMc *mc)
+{
+    mc->count = 0;
+}
+
+int gpio_uart_mc_addChannel(GpioUartMc *mc, volatile uint32_t *txOut,
+                            volatile const uint32_t *rxIn)
+{
+    GpioUartMc_Channel *c;
+    uint_fast8_t n = mc->count;
+
+    if(n >= GPIO_UART_MC_MAX_CHANNELS)
+        return -1;
+
+    c = &mc->ch[n];
+    c->txOut = txOut ? txOut : &gpio_uart_mc_txSink;
+    c->rxIn = rxIn ? rxIn : &gpio_uart_mc_rxIdle;
+    c->txShift = 0;
+    c->rxShift = 0;
+    c->txTick = GPIO_UART_MC_OVERSAMPLE;
+    c->rxTick = 0;
+    c->rxBits = 0;
+
+    mc->txFull[n] = 0;
+    mc->rxFull[n] = 0;
+    mc->rxOverrun[n] = 0;
+    mc->rxFraming[n] = 0;
+
+    *c->txOut = 1;
+    mc->count = n + 1;
+
+    return (int)n;
+}
+
+bool gpio_uart_mc_putc(GpioUartMc *mc, uint_fast8_t channel, uint8_t byte)
+{
+    if(mc->txFull[channel])
+        return false;
+
+    mc->txHold[channel] = byte;
+    mc->txFull[channel] = 1;
+    return true;
+}
+
+RAMFUNC bool gpio_uart_mc_getc(GpioUartMc *mc, uint_fast8_t channel,
+                               uint8_t *byte)
+{
+    if(!mc->rxFull[channel])
+        return false;
+
+    *byte = mc->rxHold[channel];
+    mc->rxFull[channel] = 0;
+    return true;
+}
+
+RAMFUNC void gpio_uart_mc_tick(GpioUartMc *mc)
+{
+    GpioUartMc_Channel *c = mc->ch;
+    uint_fast8_t count = mc->count;
+    uint_fast8_t n;
+
+    for(n = 0; n < count; n++, c++)
+    {
+        uint32_t level = *c->rxIn;
+
+        /* Transmit: one level per OVERSAMPLE ticks, idle shifts out ones */
+        if(--c->txTick == 0)
+        {
+            c->txTick = GPIO_UART_MC_OVERSAMPLE;
+            if(c->txShift == 0 && mc->txFull[n])
+            {
+                c->txShift = GPIO_UART_MC_FRAME(mc->txHold[n]);
+                mc->txFull[n] = 0;
+            }
+            *c->txOut = (c->txShift & 1) | (c->txShift == 0);
+            c->txShift >>= 1;
+        }
+
+        /* Receive */
+        if(c->rxBits == 0)
+        {
+            if(!level)
+            {
+                c->rxBits = GPIO_UART_MC_FRAME_BITS;
+                c->rxTick = GPIO_UART_MC_OVERSAMPLE / 2;
+            }
+        }
+        else if(--c->rxTick == 0)
+        {
+            c->rxTick = GPIO_UART_MC_OVERSAMPLE;
+            c->rxShift = (uint16_t)((c->rxShift >> 1) |
+                                    (level << (GPIO_UART_MC_FRAME_BITS - 1)));
+            if(--c->rxBits == 0)
+            {
+                /* Start bit (bit 0) must be low, stop bit (bit 9) high */
+                if((c->rxShift & 0x201) != 0x200)
+                {
+                    mc->rxFraming[n]++;
+                }
+                else
+                {
+                    if(mc->rxFull[n])
+                        mc->rxOverrun[n]++;
+                    mc->rxHold[n] = (uint8_t)(c->rxShift >> 1);
+                    mc->rxFull[n] = 1;
+                }
+            }
+        }
+    }
+}
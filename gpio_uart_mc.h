@@ -0,0 +1,87 @@
+/******************************************************************************
+ * Multi-channel software UART - shared oversampling tick
+ *
+ * Description: Runs up to GPIO_UART_MC_MAX_CHANNELS bit-banged 8N1 ports
+ * from one periodic timer interrupt at GPIO_UART_MC_OVERSAMPLE times the
+ * (common) baud rate. Unlike gpio_uart.c, which spends two compare channels
+ * and an edge interrupt per port, this engine needs a single timer for all
+ * of them: every tick walks the whole channel table, shifting TX bits out
+ * and polling RX pins for start bits.
+ *
+ * The tick walks every channel added so far, busy or idle, and none of the
+ * slots beyond: its cost grows with the number of channels added, not with
+ * GPIO_UART_MC_MAX_CHANNELS, and an idle channel still pays for its TX
+ * countdown and RX poll. Only add the ports that are actually wired.
+ *
+ * Like the single-port engine, pins are reached through 0/1 words
+ * (bit-band aliases on target) and the code builds unchanged on a host.
+ *
+ *******************************************************************************/
+#ifndef GPIO_UART_MC_H_
+#define GPIO_UART_MC_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifndef GPIO_UART_MC_MAX_CHANNELS
+#define GPIO_UART_MC_MAX_CHANNELS   8
+#endif
+
+/* Ticks per bit. With an odd value RX samples land within 1/(2*N) bit of
+ * the cell centre; with an even one they may sit up to 1/N bit late. */
+#ifndef GPIO_UART_MC_OVERSAMPLE
+#define GPIO_UART_MC_OVERSAMPLE     5
+#endif
+
+/* One table slot, 16 bytes on Cortex-M. Only the tick touches it; every
+ * field shared with thread context lives in the GpioUartMc byte arrays so
+ * that neither side ever read-modify-writes the other's state. */
+typedef struct
+{
+    volatile uint32_t *txOut;       /* TX pin output level                 */
+    volatile const uint32_t *rxIn;  /* RX pin input level                  */
+    uint16_t txShift;               /* Levels left, stop bit is the MSB    */
+    uint16_t rxShift;               /* Received bits, filled from the MSB  */
+    uint8_t  txTick;                /* Ticks left in the current TX bit    */
+    uint8_t  rxTick;                /* Ticks left until the next RX sample */
+    uint8_t  rxBits;                /* Samples left in the frame, 0 = idle */
+    uint8_t  reserved;
+} GpioUartMc_Channel;
+
+typedef struct
+{
+    GpioUartMc_Channel ch[GPIO_UART_MC_MAX_CHANNELS];
+    uint_fast8_t count;             /* Slots walked by every tick          */
+
+    volatile uint8_t txHold[GPIO_UART_MC_MAX_CHANNELS];
+    volatile uint8_t txFull[GPIO_UART_MC_MAX_CHANNELS];
+    volatile uint8_t rxHold[GPIO_UART_MC_MAX_CHANNELS];
+    volatile uint8_t rxFull[GPIO_UART_MC_MAX_CHANNELS];
+
+    /* Error counters, wrap-around */
+    volatile uint8_t rxOverrun[GPIO_UART_MC_MAX_CHANNELS];
+    volatile uint8_t rxFraming[GPIO_UART_MC_MAX_CHANNELS];
+} GpioUartMc;
+
+/* Empties the table. */
+extern void gpio_uart_mc_init(GpioUartMc *mc);
+
+/* Adds a port. Either pin may be NULL for a TX-only or RX-only channel.
+ * Returns the channel index or -1 if the table is full. */
+extern int gpio_uart_mc_addChannel(GpioUartMc *mc,
+                                   volatile uint32_t *txOut,
+                                   volatile const uint32_t *rxIn);
+
+/* Queues one byte on a channel. Returns false if its holding register is
+ * still full. */
+extern bool gpio_uart_mc_putc(GpioUartMc *mc, uint_fast8_t channel,
+                              uint8_t byte);
+
+/* Fetches one received byte. Returns false if none is available. */
+extern bool gpio_uart_mc_getc(GpioUartMc *mc, uint_fast8_t channel,
+                              uint8_t *byte);
+
+/* Timer tick, called GPIO_UART_MC_OVERSAMPLE times per bit. */
+extern void gpio_uart_mc_tick(GpioUartMc *mc);
+
+#endif /* GPIO_UART_MC_H_ */
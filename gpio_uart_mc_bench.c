@@ -0,0 +1,178 @@
+/******************************************************************************
+ * Multi-channel software UART tick benchmark - host
+ *
+ * Description: Times gpio_uart_mc_tick() against the number of channels
+ * and prints one CSV line per channel count:
+ *
+ *     channels,ns_mean,ns_worst,ns_idle,bytes,errors
+ *
+ * ns_mean is the mean tick with every channel looping its TX level word
+ * back to its RX one and sending back-to-back frames. ns_worst is the
+ * tick with every channel on its heaviest path at once: a TX bit boundary
+ * that loads the next frame and the stop bit of a frame that overruns an
+ * unread byte. It is timed by running that one tick over and over from a
+ * saved state, the cost of restoring the state taken off, as a single
+ * slowest tick is lost in timer noise on a host. ns_idle is the tick with
+ * nothing to send or receive, the floor every added channel costs.
+ * errors counts received bytes that differ from the ones sent, bytes
+ * lost and the engine's overrun and framing counts, and must be 0.
+ *
+ * The figures are host timings, not Cortex-M4 cycles: the growth with the
+ * channel count and the worst-to-idle ratio are what carry over. A tick
+ * must fit the Timer_A period, OVERSAMPLE times the bit rate, with room
+ * for everything else.
+ *
+ * Host only: the target build sees an empty file. Build and run with:
+ *
+ *     cc -std=gnu11 -O2 -I. gpio_uart_mc_bench.c gpio_uart_mc.c \
+ *        -o gpio_uart_mc_bench
+ *     ./gpio_uart_mc_bench
+ *
+ *******************************************************************************/
+#ifndef __MSP432P401R__
+
+#include <stdio.h>
+#include <time.h>
+
+#include "gpio_uart_mc.h"
+
+#define BENCH_FRAMES        5000
+#define BENCH_REPEAT        200000
+
+#define BENCH_FRAME_TICKS   (GPIO_UART_MC_OVERSAMPLE * 10)
+
+/* Level words of the lines, TX wired to RX */
+static uint32_t line[GPIO_UART_MC_MAX_CHANNELS];
+
+static uint64_t bench_ns(void)
+{
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t)t.tv_sec * 1000000000u + (uint64_t)t.tv_nsec;
+}
+
+/* Puts every channel on the heaviest path of the tick: a TX bit boundary
+ * that loads the next frame and the stop bit sample of a good frame that
+ * overruns an unread byte */
+static void bench_worstState(GpioUartMc *mc, uint_fast8_t channels)
+{
+    uint_fast8_t n;
+
+    for(n = 0; n < channels; n++)
+    {
+        GpioUartMc_Channel *c = &mc->ch[n];
+
+        line[n] = 1;
+        c->txTick = 1;
+        c->txShift = 0;
+        mc->txHold[n] = 0x5A;
+        mc->txFull[n] = 1;
+        c->rxBits = 1;
+        c->rxTick = 1;
+        c->rxShift = 0x5A << 1;
+        mc->rxFull[n] = 1;
+    }
+}
+
+static void bench_run(uint_fast8_t channels)
+{
+    static GpioUartMc mc;
+    static GpioUartMc worstState;
+    uint8_t next[GPIO_UART_MC_MAX_CHANNELS] = { 0 };
+    uint8_t expect[GPIO_UART_MC_MAX_CHANNELS] = { 0 };
+    uint32_t got[GPIO_UART_MC_MAX_CHANNELS] = { 0 };
+    uint64_t busy = 0;
+    uint64_t idle;
+    uint64_t worst;
+    uint64_t copy;
+    uint64_t t0;
+    uint32_t bytes = 0;
+    uint32_t errors = 0;
+    uint32_t frame;
+    uint32_t k;
+    uint_fast8_t n;
+
+    gpio_uart_mc_init(&mc);
+    for(n = 0; n < channels; n++)
+        gpio_uart_mc_addChannel(&mc, &line[n], &line[n]);
+
+    /* Floor: nothing queued, nothing on the lines */
+    t0 = bench_ns();
+    for(k = 0; k < BENCH_REPEAT; k++)
+        gpio_uart_mc_tick(&mc);
+    idle = bench_ns() - t0;
+
+    /* Traffic: one frame queued and one read per channel per frame time,
+     * only the ticks timed */
+    for(frame = 0; frame < BENCH_FRAMES; frame++)
+    {
+        uint8_t byte;
+
+        for(n = 0; n < channels; n++)
+            if(gpio_uart_mc_putc(&mc, n, next[n]))
+                next[n] = (uint8_t)(next[n] * 5 + 1);
+
+        t0 = bench_ns();
+        for(k = 0; k < BENCH_FRAME_TICKS; k++)
+            gpio_uart_mc_tick(&mc);
+        busy += bench_ns() - t0;
+
+        for(n = 0; n < channels; n++)
+        {
+            if(gpio_uart_mc_getc(&mc, n, &byte))
+            {
+                if(byte != expect[n])
+                    errors++;
+                expect[n] = (uint8_t)(byte * 5 + 1);
+                got[n]++;
+                bytes++;
+            }
+        }
+    }
+    for(n = 0; n < channels; n++)
+    {
+        /* At most the frame on the wire is still missing */
+        if(got[n] + 1 < BENCH_FRAMES)
+            errors++;
+        errors += mc.rxOverrun[n] + mc.rxFraming[n];
+    }
+
+    /* Worst case: the same tick over and over from the same state, less
+     * the cost of restoring that state */
+    worstState = mc;
+    bench_worstState(&worstState, channels);
+    t0 = bench_ns();
+    for(k = 0; k < BENCH_REPEAT; k++)
+    {
+        mc = worstState;
+        __asm__ volatile("" : : "r"(&mc) : "memory");
+    }
+    copy = bench_ns() - t0;
+    t0 = bench_ns();
+    for(k = 0; k < BENCH_REPEAT; k++)
+    {
+        mc = worstState;
+        gpio_uart_mc_tick(&mc);
+    }
+    worst = bench_ns() - t0;
+    worst = worst > copy ? worst - copy : 0;
+
+    printf("%u,%.1f,%.1f,%.1f,%u,%u\n", (unsigned)channels,
+           (double)busy / ((uint64_t)BENCH_FRAMES * BENCH_FRAME_TICKS),
+           (double)worst / BENCH_REPEAT, (double)idle / BENCH_REPEAT,
+           bytes, errors);
+}
+
+int main(void)
+{
+    uint_fast8_t channels;
+
+    printf("channels,ns_mean,ns_worst,ns_idle,bytes,errors\n");
+    for(channels = 1; channels <= GPIO_UART_MC_MAX_CHANNELS; channels++)
+        bench_run(channels);
+
+    return 0;
+}
+
+#endif /* __MSP432P401R__ */
@@ -0,0 +1,128 @@
+/******************************************************************************
+ * Software UART on arbitrary GPIO pins - MSP432 binding
+ *
+ * Every pin and compare control bit is reached through its bit-band alias,
+ * so the ISRs in gpio_uart.c flip single bits with one store and never do a
+ * read-modify-write on a register shared with other pins.
+ *
+ *******************************************************************************/
+/* DriverLib Includes */
+#include <ti/devices/msp432p4xx/driverlib/driverlib.h>
+
+#include "gpio_uart_msp432.h"
+
+/* Port register offsets of P1 (odd ports); even ports sit one byte above */
+#define DIO_OFS_IN      0x00
+#define DIO_OFS_OUT     0x02
+#define DIO_OFS_IES     0x18
+#define DIO_OFS_IE      0x1A
+#define DIO_OFS_IFG     0x1C
+
+volatile uint32_t *gpio_uart_msp432_pinAlias(uint_fast8_t port,
+                                             uint_fast16_t pin, uint32_t ofs)
+{
+    uint32_t addr = DIO_BASE + ((port - 1) >> 1) * 0x20 + ofs + ((port - 1) & 1);
+    uint32_t bit = 0;
+
+    while(!(pin & (1 << bit)))
+        bit++;
+
+    return (volatile uint32_t *)(BITBAND_PERI_BASE +
+                                 (addr - PERIPH_BASE) * 32 + bit * 4);
+}
+
+bool gpio_uart_msp432_init(GpioUart *uart,
+                           uint_fast8_t txPort, uint_fast16_t txPin,
+                           uint_fast8_t rxPort, uint_fast16_t rxPin,
+                           uint32_t baud)
+{
+    GpioUart_Hw hw;
+
+    if(txPort < GPIO_PORT_P1 || txPort > GPIO_PORT_P10 ||
+       rxPort < GPIO_PORT_P1 || rxPort > GPIO_PORT_P6)
+        return false;
+
+    hw.txOut     = gpio_uart_msp432_pinAlias(txPort, txPin, DIO_OFS_OUT);
+    hw.txCcr     = &GPIO_UART_TIMER->CCR[GPIO_UART_TX_CCR];
+    hw.txCcie    = &BITBAND_PERI(GPIO_UART_TIMER->CCTL[GPIO_UART_TX_CCR],
+                                 TIMER_A_CCTLN_CCIE_OFS);
+    hw.txCcifg   = &BITBAND_PERI(GPIO_UART_TIMER->CCTL[GPIO_UART_TX_CCR],
+                                 TIMER_A_CCTLN_CCIFG_OFS);
+    hw.rxIn      = gpio_uart_msp432_pinAlias(rxPort, rxPin, DIO_OFS_IN);
+    hw.rxEdgeIe  = gpio_uart_msp432_pinAlias(rxPort, rxPin, DIO_OFS_IE);
+    hw.rxEdgeIfg = gpio_uart_msp432_pinAlias(rxPort, rxPin, DIO_OFS_IFG);
+    hw.rxCcr     = &GPIO_UART_TIMER->CCR[GPIO_UART_RX_CCR];
+    hw.rxCcie    = &BITBAND_PERI(GPIO_UART_TIMER->CCTL[GPIO_UART_RX_CCR],
+                                 TIMER_A_CCTLN_CCIE_OFS);
+    hw.rxCcifg   = &BITBAND_PERI(GPIO_UART_TIMER->CCTL[GPIO_UART_RX_CCR],
+                                 TIMER_A_CCTLN_CCIFG_OFS);
+    hw.timer     = &GPIO_UART_TIMER->R;
+
+    /* TX idles high, RX is pulled up and interrupts on the start edge */
+    MAP_GPIO_setOutputHighOnPin(txPort, txPin);
+    MAP_GPIO_setAsOutputPin(txPort, txPin);
+    MAP_GPIO_setAsInputPinWithPullUpResistor(rxPort, rxPin);
+    MAP_GPIO_interruptEdgeSelect(rxPort, rxPin, GPIO_HIGH_TO_LOW_TRANSITION);
+
+    /* Timer_A1 free running from SMCLK, both channels in compare mode */
+    GPIO_UART_TIMER->CTL = TIMER_A_CTL_SSEL__SMCLK | TIMER_A_CTL_CLR;
+    GPIO_UART_TIMER->CCTL[GPIO_UART_TX_CCR] = 0;
+    GPIO_UART_TIMER->CCTL[GPIO_UART_RX_CCR] = 0;
+
+    if(!gpio_uart_init(uart, &hw, MAP_CS_getSMCLK(), baud))
+        return false;
+
+    GPIO_UART_TIMER->CTL |= TIMER_A_CTL_MC__CONTINUOUS;
+
+    MAP_Interrupt_enableInterrupt(GPIO_UART_TIMER_INT);
+    MAP_Interrupt_enableInterrupt(INT_PORT1 + (rxPort - GPIO_PORT_P1));
+
+    return true;
+}
+
+int gpio_uart_mc_msp432_addChannel(GpioUartMc *mc,
+                                   uint_fast8_t txPort, uint_fast16_t txPin,
+                                   uint_fast8_t rxPort, uint_fast16_t rxPin)
+{
+    volatile uint32_t *txOut = 0;
+    volatile const uint32_t *rxIn = 0;
+
+    if(txPort > GPIO_PORT_P10 || rxPort > GPIO_PORT_P10)
+        return -1;
+
+    if(txPort)
+    {
+        MAP_GPIO_setOutputHighOnPin(txPort, txPin);
+        MAP_GPIO_setAsOutputPin(txPort, txPin);
+        txOut = gpio_uart_msp432_pinAlias(txPort, txPin, DIO_OFS_OUT);
+    }
+    if(rxPort)
+    {
+        MAP_GPIO_setAsInputPinWithPullUpResistor(rxPort, rxPin);
+        rxIn = gpio_uart_msp432_pinAlias(rxPort, rxPin, DIO_OFS_IN);
+    }
+
+    return gpio_uart_mc_addChannel(mc, txOut, rxIn);
+}
+
+bool gpio_uart_mc_msp432_start(uint32_t baud)
+{
+    uint32_t tickHz = baud * GPIO_UART_MC_OVERSAMPLE;
+    uint32_t period;
+
+    if(tickHz == 0)
+        return false;
+
+    period = (MAP_CS_getSMCLK() + tickHz / 2) / tickHz;
+    if(period < 2 || period > 0x10000)
+        return false;
+
+    GPIO_UART_MC_TIMER->CTL = TIMER_A_CTL_SSEL__SMCLK | TIMER_A_CTL_CLR;
+    GPIO_UART_MC_TIMER->CCR[0] = (uint16_t)(period - 1);
+    GPIO_UART_MC_TIMER->CCTL[0] = TIMER_A_CCTLN_CCIE;
+    GPIO_UART_MC_TIMER->CTL |= TIMER_A_CTL_MC__UP;
+
+    MAP_Interrupt_enableInterrupt(GPIO_UART_MC_TIMER_INT);
+
+    return true;
+}
@@ -0,0 +1,69 @@
+/******************************************************************************
+ * Software UART on arbitrary GPIO pins - MSP432 binding
+ *
+ * Description: Maps the portable bit engine in gpio_uart.c onto Timer_A1
+ * (continuous mode, clocked from SMCLK) and the port bit-band aliases.
+ *
+ *     TA1.1 compare  -> TX bit edges
+ *     TA1.2 compare  -> RX mid-bit samples
+ *     PORTx edge     -> RX start bit (falling edge)
+ *
+ * The multi-channel engine in gpio_uart_mc.c runs from Timer_A2 in up
+ * mode instead; its CCR0 period is one oversampling tick.
+ *
+ * The application owns the vectors and forwards them, see
+ * GPIO_UART_MSP432_TIMER_ISR(), TA2_0_IRQHandler and the PORTx_IRQHandler
+ * in main().
+ *
+ *******************************************************************************/
+#ifndef GPIO_UART_MSP432_H_
+#define GPIO_UART_MSP432_H_
+
+#include <ti/devices/msp432p4xx/inc/msp.h>
+#include "gpio_uart.h"
+#include "gpio_uart_mc.h"
+
+#define GPIO_UART_TIMER         TA1
+#define GPIO_UART_TIMER_INT     INT_TA1_N
+#define GPIO_UART_TX_CCR        1
+#define GPIO_UART_RX_CCR        2
+
+#define GPIO_UART_MC_TIMER      TA2
+#define GPIO_UART_MC_TIMER_INT  INT_TA2_0
+
+/* Body of TA1_N_IRQHandler for one software UART instance */
+#define GPIO_UART_MSP432_TIMER_ISR(uart)    gpio_uart_timerIsr(uart)
+
+/* True if a compare channel's interrupt is the one pending, not just the
+ * flag every match sets */
+#define GPIO_UART_MSP432_CCR_DUE(ccr)                                         \
+    ((GPIO_UART_TIMER->CCTL[ccr] & (TIMER_A_CCTLN_CCIE | TIMER_A_CCTLN_CCIFG)) \
+     == (TIMER_A_CCTLN_CCIE | TIMER_A_CCTLN_CCIFG))
+
+/* Configures the pins (driverlib GPIO_PORT_Px / GPIO_PINn identifiers),
+ * starts Timer_A1 from SMCLK and enables the timer and port interrupts.
+ * The RX pin must be on P1..P6, the only ports with edge interrupts. */
+extern bool gpio_uart_msp432_init(GpioUart *uart,
+                                  uint_fast8_t txPort, uint_fast16_t txPin,
+                                  uint_fast8_t rxPort, uint_fast16_t rxPin,
+                                  uint32_t baud);
+
+/* Configures a TX/RX pin pair and adds it to the multi-channel table.
+ * Either port may be 0 for a one-directional channel. Returns the channel
+ * index or -1. */
+extern int gpio_uart_mc_msp432_addChannel(GpioUartMc *mc,
+                                          uint_fast8_t txPort,
+                                          uint_fast16_t txPin,
+                                          uint_fast8_t rxPort,
+                                          uint_fast16_t rxPin);
+
+/* Starts the shared tick at baud * GPIO_UART_MC_OVERSAMPLE from SMCLK and
+ * enables its interrupt. Returns false if the rate cannot be reached. */
+extern bool gpio_uart_mc_msp432_start(uint32_t baud);
+
+/* Bit-band alias of one port register bit, ofs relative to P1 */
+extern volatile uint32_t *gpio_uart_msp432_pinAlias(uint_fast8_t port,
+                                                    uint_fast16_t pin,
+                                                    uint32_t ofs);
+
+#endif /* GPIO_UART_MSP432_H_ */
@@ -0,0 +1,114 @@
+/******************************************************************************
+ * Hardware abstraction layer
+ *
+ * Description: The handful of hardware operations the eUSCI_A UART driver
+ * and the demo application use, behind one interface with two backends:
+ *
+ *     hal_msp432.h   MSP432 target: driverlib, direct register access and
+ *                    bit-band stores, all static inline, so the target
+ *                    build compiles to the same code as writing the
+ *                    registers by hand.
+ *     hal_host.c     Linux: four simulated eUSCI_A modules with TXBUF/RXBUF,
+ *                    the TX shift register, IFG/IE flags and frame timing
+ *                    derived from the programmed divisors. Simulated time
+ *                    only advances while the application sleeps, jumping
+ *                    straight to the next event, so it runs far faster
+ *                    than real time. EUSCIAx_IRQHandler is called as the
+ *                    interrupt, honouring PRIMASK and SLEEPONEXIT.
+ *
+ * The backend is picked by __MSP432P401R__, as elsewhere in the tree.
+ *
+ * UART (eUSCI_A0..A3, 8N1 from SMCLK). Every call takes the module handle,
+ * a Hal_Uart (HAL_UART_A0..HAL_UART_A3) defined by the backend: the
+ * register block on the target, an index on the host. With a constant
+ * handle the target calls fold to fixed register addresses.
+ *     hal_uart_configure(uart, cfg)  program divisors, module held in
+ *                                    reset; erroneous and break
+ *                                    characters are received too
+ *                                    (UCRXEIE, UCBRKIE)
+ *     hal_uart_enable(uart)          release reset
+ *     hal_uart_irqEnable(uart)       enable the interrupt in the NVIC
+ *     hal_uart_rxIe(uart, on), hal_uart_txIe(uart, on),
+ *     hal_uart_txCptIe(uart, on), hal_uart_txCptClear(uart)
+ *     hal_uart_pending(uart)         enabled and set HAL_UART_*_FLAG bits
+ *     hal_uart_flags(uart)           set HAL_UART_*_FLAG bits, enabled or
+ *                                    not
+ *     hal_uart_rxErrors(uart)        HAL_UART_ERR_* bits of the byte in
+ *                                    RXBUF, to be read before
+ *                                    hal_uart_read()
+ *     hal_uart_read(uart)            RXBUF, clears RXIFG and the error bits
+ *     hal_uart_write(uart, byte)     TXBUF, clears TXIFG
+ *
+ * Core:
+ *     hal_clock_smclkHz(), hal_clock_mclkHz()
+ *     hal_irq_disable(), hal_irq_enable()     PRIMASK
+ *     hal_sleepOnExit(on)                     SLEEPONEXIT
+ *     hal_sleep()                             LPM0
+ *     hal_defer()                             pend PendSV_Handler, which
+ *                                             runs once no other ISR is
+ *                                             active
+ *     hal_bit_set(word, bit), hal_bit_clear(word, bit)
+ *                                             atomic on a word in SRAM
+ *
+ * GPIO (driverlib numbering: ports 1..10, pins as a bit mask):
+ *     hal_gpio_output(port, pins), hal_gpio_high(port, pins),
+ *     hal_gpio_low(port, pins), hal_gpio_peripheral(port, pins)
+ *     hal_gpio_input(port, pins)              input with pull-up
+ *     hal_gpio_read(port, pins)               true if any of pins is high
+ *
+ * GPIO edge interrupts (ports 1..6, PORTx_IRQHandler):
+ *     hal_gpio_edgeSelect(port, pins, falling)
+ *     hal_gpio_edgeIe(port, pins, on), hal_gpio_edgeClear(port, pins)
+ *     hal_gpio_irqEnable(port)                enable PORTx in the NVIC
+ *
+ * One-shot timer (Timer32 module 1 from MCLK, T32_INT1_IRQHandler):
+ *     hal_oneshot_init()        32-bit one-shot, interrupt enabled
+ *     hal_oneshot_start(ticks)  (re)starts the count from ticks
+ *     hal_oneshot_stop(), hal_oneshot_clear()
+ *
+ *******************************************************************************/
+#ifndef HAL_H_
+#define HAL_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* eUSCI_A divisors, see uart_baud.h */
+typedef struct
+{
+    uint16_t brdiv;                 /* UCBRx                             */
+    uint8_t  brf;                   /* UCBRFx                            */
+    uint8_t  brs;                   /* UCBRSx                            */
+    bool     overSampling;          /* UCOS16                            */
+} Hal_UartConfig;
+
+/* hal_uart_pending() bits, equal to the UCAxIFG bits */
+#define HAL_UART_RX_FLAG        0x01
+#define HAL_UART_TX_FLAG        0x02
+#define HAL_UART_TXCPT_FLAG     0x08
+
+/* hal_uart_rxErrors() bits, equal to the UCAxSTATW bits */
+#define HAL_UART_ERR_BRK        0x08
+#define HAL_UART_ERR_PE         0x10
+#define HAL_UART_ERR_OE         0x20
+#define HAL_UART_ERR_FE         0x40
+#define HAL_UART_ERR_MASK       (HAL_UART_ERR_BRK | HAL_UART_ERR_PE |       \
+                                 HAL_UART_ERR_OE | HAL_UART_ERR_FE)
+
+#define HAL_PORT_P1             1
+#define HAL_PORT_P2             2
+#define HAL_PORT_P3             3
+#define HAL_PORT_P5             5
+
+#define HAL_PIN0                0x0001
+#define HAL_PIN1                0x0002
+#define HAL_PIN2                0x0004
+#define HAL_PIN3                0x0008
+
+#ifdef __MSP432P401R__
+#include "hal_msp432.h"
+#else
+#include "hal_host.h"
+#endif
+
+#endif /* HAL_H_ */
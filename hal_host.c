@@ -0,0 +1,845 @@
+/******************************************************************************
+ * Hardware abstraction layer - Linux simulation backend
+ *
+ * A discrete-event model of eUSCI_A0..A3 in UART mode, accurate to the
+ * frame, each module simulated on its own:
+ *
+ *  - Writing TXBUF while the shift register is idle moves the byte straight
+ *    into it and leaves TXIFG set; otherwise TXBUF holds it and TXIFG
+ *    clears until the shift register takes it.
+ *  - A frame takes 10 bit times, a bit being N = UCBRx*16 + UCBRFx (+ the
+ *    average UCBRSx modulation) BRCLK cycles with UCOS16, UCBRx otherwise.
+ *  - TXCPTIFG sets when the shift register empties with TXBUF empty.
+ *  - A byte completes on RX one frame after it started; if RXIFG is still
+ *    set RXBUF is overwritten, UCOE set and the overrun counted. Injected
+ *    bytes can carry UCFE/UCPE/UCBRK; reading RXBUF clears them all.
+ *  - UCSWRST (hal_uart_configure) clears IE and the RX/TXCPT flags and
+ *    aborts any frame in flight.
+ *
+ * The one-shot timer counts MCLK (= SMCLK) cycles and sets its flag when
+ * it runs out.
+ *
+ * GPIO inputs only change through hal_host_gpioDrive(); a change matching
+ * PxIES sets PxIFG, as on the part.
+ *
+ * Interrupts: EUSCIAx_IRQHandler (or PORTx/T32_INT1_IRQHandler) runs
+ * whenever its IE & IFG != 0, the NVIC line is enabled, PRIMASK is clear
+ * and no handler is already running. Priorities are not modelled: the
+ * eUSCIs go first, lowest module first, then the timer, then the ports.
+ * It is entered from any HAL call that can make it pending in thread mode,
+ * and from hal_sleep(). Returning to thread mode with SLEEPONEXIT set
+ * sleeps again, as on the Cortex-M4.
+ *
+ * Build the demo on a Linux host with, e.g.:
+ *
+ *     cc -std=c11 -O2 -I. uart_loopback_24mhz_brclk.c uart_driver.c \
+ *        uart_baud.c cycle_stats.c hal_host.c event_sched.c -o loopback
+ *     HAL_HOST_SECONDS=10 ./loopback
+ *
+ *******************************************************************************/
+#ifndef __MSP432P401R__
+
+#define _POSIX_C_SOURCE 199309L     /* clock_gettime() */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "hal.h"
+#include "cycle_stats.h"
+
+#define HAL_HOST_RX_QUEUE       64
+
+#define HAL_HOST_GPIO_IRQ_PORTS 6
+
+extern void EUSCIA0_IRQHandler(void) __attribute__((weak));
+extern void EUSCIA1_IRQHandler(void) __attribute__((weak));
+extern void EUSCIA2_IRQHandler(void) __attribute__((weak));
+extern void EUSCIA3_IRQHandler(void) __attribute__((weak));
+extern void PORT1_IRQHandler(void) __attribute__((weak));
+extern void PORT2_IRQHandler(void) __attribute__((weak));
+extern void PORT3_IRQHandler(void) __attribute__((weak));
+extern void PORT4_IRQHandler(void) __attribute__((weak));
+extern void PORT5_IRQHandler(void) __attribute__((weak));
+extern void PORT6_IRQHandler(void) __attribute__((weak));
+extern void T32_INT1_IRQHandler(void) __attribute__((weak));
+extern void PendSV_Handler(void) __attribute__((weak));
+
+HalHost_UartStats halHostUartStats[HAL_HOST_UARTS];
+uint16_t halHostGpioOut[11];
+uint16_t halHostGpioIn[11];
+
+typedef struct
+{
+    bool     reset;                 /* UCSWRST                           */
+    uint8_t  ie;
+    uint8_t  ifg;
+    uint8_t  stat;                  /* HAL_UART_ERR_* of RXBUF           */
+    uint8_t  rxbuf;
+    uint8_t  txbuf;
+    bool     txbufFull;
+    bool     shiftBusy;
+    uint8_t  shift;
+    uint64_t shiftDone;             /* Time the shifted frame completes  */
+    uint64_t frameCycles;
+    bool     nvic;
+    bool     loopback;
+
+    /* Bytes on their way into RX: loopback and injected */
+    uint8_t  rxQueue[HAL_HOST_RX_QUEUE];
+    uint8_t  rxErr[HAL_HOST_RX_QUEUE];
+    uint64_t rxDue[HAL_HOST_RX_QUEUE];
+    uint8_t  rxHead, rxTail;
+    uint64_t rxWireFree;            /* End of the last frame on RX wire  */
+
+    HalHost_TxHook txHook;
+    HalHost_RxFeed rxFeed;
+    HalHost_UartStats *stats;
+} HalHost_Uart;
+
+static HalHost_Uart uarts[HAL_HOST_UARTS] =
+{
+    { .reset = true, .loopback = true, .stats = &halHostUartStats[0] },
+    { .reset = true, .loopback = true, .stats = &halHostUartStats[1] },
+    { .reset = true, .loopback = true, .stats = &halHostUartStats[2] },
+    { .reset = true, .loopback = true, .stats = &halHostUartStats[3] }
+};
+
+static void (*const uartIrq[HAL_HOST_UARTS])(void) =
+{
+    EUSCIA0_IRQHandler, EUSCIA1_IRQHandler,
+    EUSCIA2_IRQHandler, EUSCIA3_IRQHandler
+};
+
+static struct
+{
+    bool     running;
+    bool     ifg;
+    bool     nvic;
+    uint64_t due;
+} oneshot;
+
+/* Edge interrupt state of ports 1..6, index 0 unused */
+static struct
+{
+    uint16_t ies;                   /* Set: falling edge                 */
+    uint16_t ie;
+    uint16_t ifg;
+    bool     nvic;
+} gpio[HAL_HOST_GPIO_IRQ_PORTS + 1];
+
+static void (*const portIrq[HAL_HOST_GPIO_IRQ_PORTS + 1])(void) =
+{
+    0, PORT1_IRQHandler, PORT2_IRQHandler, PORT3_IRQHandler,
+    PORT4_IRQHandler, PORT5_IRQHandler, PORT6_IRQHandler
+};
+
+/* Input pins hal_host_gpioDrive() has set, which pull-ups do not override */
+static uint16_t gpioDriven[11];
+
+static struct
+{
+    uint8_t  outPort, inPort;
+    uint16_t outPin, inPin;
+} wire[HAL_HOST_GPIO_WIRES];
+static uint_fast8_t wires = 0;
+
+static uint64_t now = 0;
+static uint32_t smclkHz = 24000000;
+static bool primask = false;
+static bool sleepOnExit = false;
+static bool inIsr = false;
+static bool deferPending = false;
+static uint64_t stopAt = 0;
+static struct timespec wallStart;
+
+static void hal_host_summary(void)
+{
+    struct timespec wall;
+    double simSeconds = (double)now / smclkHz;
+    double wallSeconds;
+    HalHost_UartStats total = { 0, 0, 0, 0 };
+    uint_fast8_t n;
+
+    for(n = 0; n < HAL_HOST_UARTS; n++)
+    {
+        total.txBytes += halHostUartStats[n].txBytes;
+        total.rxBytes += halHostUartStats[n].rxBytes;
+        total.rxOverruns += halHostUartStats[n].rxOverruns;
+        total.interrupts += halHostUartStats[n].interrupts;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &wall);
+    wallSeconds = (double)(wall.tv_sec - wallStart.tv_sec) +
+                  (wall.tv_nsec - wallStart.tv_nsec) * 1e-9;
+
+    fprintf(stderr, "simulated %.3f s in %.3f s wall (x%.1f): "
+            "tx %u, rx %u, overruns %u, interrupts %u\n",
+            simSeconds, wallSeconds,
+            wallSeconds > 0 ? simSeconds / wallSeconds : 0.0,
+            total.txBytes, total.rxBytes, total.rxOverruns, total.interrupts);
+}
+
+static void hal_host_start(void)
+{
+    static bool started = false;
+    const char *seconds;
+
+    if(started)
+        return;
+    started = true;
+
+    clock_gettime(CLOCK_MONOTONIC, &wallStart);
+    seconds = getenv("HAL_HOST_SECONDS");
+    if(seconds)
+        stopAt = (uint64_t)(atof(seconds) * smclkHz);
+}
+
+static void hal_host_setNow(uint64_t t)
+{
+    now = t;
+    cycleStatsMockNow = (uint32_t)now;
+
+    if(stopAt && now >= stopAt)
+    {
+        hal_host_summary();
+        exit(0);
+    }
+}
+
+/* Queues a byte to complete on RX one frame after the wire is free */
+static bool hal_host_rxSchedule(HalHost_Uart *u, uint8_t byte,
+                                uint_fast8_t err, uint64_t start)
+{
+    uint8_t slot = u->rxHead % HAL_HOST_RX_QUEUE;
+
+    if((uint8_t)(u->rxHead - u->rxTail) >= HAL_HOST_RX_QUEUE)
+        return false;
+
+    if(start < u->rxWireFree)
+        start = u->rxWireFree;
+    u->rxWireFree = start + u->frameCycles;
+
+    u->rxQueue[slot] = byte;
+    u->rxErr[slot] = (uint8_t)err;
+    u->rxDue[slot] = u->rxWireFree;
+    u->rxHead++;
+    return true;
+}
+
+/* Pulls the next scripted byte once everything before it is in */
+static void hal_host_feed(HalHost_Uart *u)
+{
+    uint8_t byte;
+    uint32_t gap;
+    uint64_t start;
+
+    if(!u->rxFeed || u->rxTail != u->rxHead)
+        return;
+
+    if(!u->rxFeed(&byte, &gap))
+    {
+        u->rxFeed = 0;
+        return;
+    }
+
+    start = (now > u->rxWireFree ? now : u->rxWireFree) + gap;
+    hal_host_rxSchedule(u, byte, 0, start);
+}
+
+static void hal_host_shiftLoad(HalHost_Uart *u, uint8_t byte)
+{
+    u->shift = byte;
+    u->shiftBusy = true;
+    u->shiftDone = now + u->frameCycles;
+    u->ifg |= HAL_UART_TX_FLAG;
+
+    if(u->loopback)
+        hal_host_rxSchedule(u, byte, 0, now);
+}
+
+static void hal_host_uartEvents(HalHost_Uart *u)
+{
+    if(u->reset)
+        return;
+
+    while(u->rxTail != u->rxHead &&
+          u->rxDue[u->rxTail % HAL_HOST_RX_QUEUE] <= now)
+    {
+        if(u->ifg & HAL_UART_RX_FLAG)
+        {
+            u->stats->rxOverruns++;
+            u->stat |= HAL_UART_ERR_OE;
+        }
+        u->stat |= u->rxErr[u->rxTail % HAL_HOST_RX_QUEUE];
+        u->rxbuf = u->rxQueue[u->rxTail % HAL_HOST_RX_QUEUE];
+        u->ifg |= HAL_UART_RX_FLAG;
+        u->rxTail++;
+        u->stats->rxBytes++;
+        hal_host_feed(u);
+    }
+
+    if(u->shiftBusy && u->shiftDone <= now)
+    {
+        uint64_t done = u->shiftDone;
+
+        u->shiftBusy = false;
+        u->stats->txBytes++;
+        if(u->txHook)
+            u->txHook(u->shift);
+
+        if(u->txbufFull)
+        {
+            u->txbufFull = false;
+            hal_host_shiftLoad(u, u->txbuf);
+            u->shiftDone = done + u->frameCycles;
+        }
+        else
+        {
+            u->ifg |= HAL_UART_TXCPT_FLAG;
+        }
+    }
+}
+
+/* Retires every event due at or before the current time */
+static void hal_host_events(void)
+{
+    uint_fast8_t n;
+
+    if(oneshot.running && oneshot.due <= now)
+    {
+        oneshot.running = false;
+        oneshot.ifg = true;
+    }
+
+    for(n = 0; n < HAL_HOST_UARTS; n++)
+        hal_host_uartEvents(&uarts[n]);
+}
+
+/* Lowest module with an enabled interrupt pending, HAL_HOST_UARTS if none */
+static uint_fast8_t hal_host_uartIrqPending(void)
+{
+    uint_fast8_t n;
+
+    for(n = 0; n < HAL_HOST_UARTS; n++)
+    {
+        if(uarts[n].nvic && (uarts[n].ie & uarts[n].ifg) != 0)
+            break;
+    }
+
+    return n;
+}
+
+/* Lowest port with an enabled edge interrupt pending, 0 if none */
+static uint_fast8_t hal_host_gpioIrqPending(void)
+{
+    uint_fast8_t port;
+
+    for(port = 1; port <= HAL_HOST_GPIO_IRQ_PORTS; port++)
+    {
+        if(gpio[port].nvic && (gpio[port].ie & gpio[port].ifg) != 0)
+            return port;
+    }
+
+    return 0;
+}
+
+static bool hal_host_oneshotIrqPending(void)
+{
+    return oneshot.nvic && oneshot.ifg;
+}
+
+static bool hal_host_irqPending(void)
+{
+    return hal_host_uartIrqPending() != HAL_HOST_UARTS ||
+           hal_host_oneshotIrqPending() ||
+           hal_host_gpioIrqPending() != 0 ||
+           deferPending;
+}
+
+/* Time of the next scheduled event, UINT64_MAX if there is none */
+static uint64_t hal_host_nextEvent(void)
+{
+    uint64_t next = UINT64_MAX;
+    uint_fast8_t n;
+
+    for(n = 0; n < HAL_HOST_UARTS; n++)
+    {
+        const HalHost_Uart *u = &uarts[n];
+
+        if(u->reset)
+            continue;
+        if(u->rxTail != u->rxHead &&
+           u->rxDue[u->rxTail % HAL_HOST_RX_QUEUE] < next)
+            next = u->rxDue[u->rxTail % HAL_HOST_RX_QUEUE];
+        if(u->shiftBusy && u->shiftDone < next)
+            next = u->shiftDone;
+    }
+
+    if(oneshot.running && oneshot.due < next)
+        next = oneshot.due;
+
+    return next;
+}
+
+/* Advances simulated time to the next event, the core sleeping meanwhile */
+static void hal_host_advance(void)
+{
+    uint64_t next = hal_host_nextEvent();
+
+    if(next == UINT64_MAX)
+    {
+        fprintf(stderr, "hal_host: sleeping with no event left to wake up\n");
+        hal_host_summary();
+        exit(1);
+    }
+
+    hal_host_setNow(next);
+    hal_host_events();
+}
+
+/* WFI: sleep until an interrupt is pending (PRIMASK does not mask the
+ * wake-up, only the handler) */
+static void hal_host_wait(void)
+{
+    hal_host_events();
+    while(!hal_host_irqPending())
+        hal_host_advance();
+}
+
+static bool hal_host_dispatch(void)
+{
+    bool ran = false;
+
+    while(!inIsr && !primask && hal_host_irqPending())
+    {
+        void (*handler)(void);
+        uint_fast8_t module = hal_host_uartIrqPending();
+
+        if(module != HAL_HOST_UARTS)
+        {
+            halHostUartStats[module].interrupts++;
+            handler = uartIrq[module];
+        }
+        else if(hal_host_oneshotIrqPending())
+        {
+            handler = T32_INT1_IRQHandler;
+        }
+        else if(hal_host_gpioIrqPending() != 0)
+        {
+            handler = portIrq[hal_host_gpioIrqPending()];
+        }
+        else
+        {
+            /* PendSV: lowest priority, cleared on entry */
+            deferPending = false;
+            handler = PendSV_Handler;
+        }
+
+        if(!handler)
+        {
+            fprintf(stderr, "hal_host: interrupt enabled without a handler\n");
+            exit(1);
+        }
+
+        inIsr = true;
+        handler();
+        inIsr = false;
+        hal_host_events();
+        ran = true;
+    }
+
+    return ran;
+}
+
+/* Thread mode: take whatever interrupt just became pending, and honour
+ * SLEEPONEXIT on the way back */
+static void hal_host_service(void)
+{
+    if(inIsr || primask)
+        return;
+
+    while(hal_host_dispatch())
+    {
+        if(!sleepOnExit)
+            return;
+        hal_host_wait();
+    }
+}
+
+bool hal_uart_configure(Hal_Uart uart, const Hal_UartConfig *cfg)
+{
+    HalHost_Uart *u = &uarts[uart];
+    uint64_t bit8;                  /* Bit time in 1/8 BRCLK cycles      */
+    uint8_t brs = cfg->brs;
+    uint32_t ones = 0;
+
+    hal_host_start();
+
+    if(cfg->brdiv == 0)
+        return false;
+
+    while(brs)
+    {
+        ones += brs & 1;
+        brs >>= 1;
+    }
+
+    if(cfg->overSampling)
+        bit8 = ((uint64_t)cfg->brdiv * 16 + cfg->brf) * 8 + ones;
+    else
+        bit8 = (uint64_t)cfg->brdiv * 8 + ones;
+
+    u->reset = true;
+    u->ie = 0;
+    u->ifg = 0;
+    u->stat = 0;
+    u->txbufFull = false;
+    u->shiftBusy = false;
+    u->frameCycles = (bit8 * 10 + 4) / 8;
+    return true;
+}
+
+void hal_uart_enable(Hal_Uart uart)
+{
+    uarts[uart].reset = false;
+    uarts[uart].ifg |= HAL_UART_TX_FLAG;
+    hal_host_service();
+}
+
+void hal_uart_irqEnable(Hal_Uart uart)
+{
+    uarts[uart].nvic = true;
+    hal_host_service();
+}
+
+static void hal_host_setIe(Hal_Uart uart, uint8_t flag, bool on)
+{
+    if(on)
+        uarts[uart].ie |= flag;
+    else
+        uarts[uart].ie &= ~flag;
+    hal_host_service();
+}
+
+void hal_uart_rxIe(Hal_Uart uart, bool on)
+{
+    hal_host_setIe(uart, HAL_UART_RX_FLAG, on);
+}
+
+void hal_uart_txIe(Hal_Uart uart, bool on)
+{
+    hal_host_setIe(uart, HAL_UART_TX_FLAG, on);
+}
+
+void hal_uart_txCptIe(Hal_Uart uart, bool on)
+{
+    hal_host_setIe(uart, HAL_UART_TXCPT_FLAG, on);
+}
+
+void hal_uart_txCptClear(Hal_Uart uart)
+{
+    uarts[uart].ifg &= ~HAL_UART_TXCPT_FLAG;
+}
+
+uint_fast8_t hal_uart_pending(Hal_Uart uart)
+{
+    hal_host_events();
+    return uarts[uart].ie & uarts[uart].ifg;
+}
+
+uint_fast8_t hal_uart_flags(Hal_Uart uart)
+{
+    hal_host_setNow(now + HAL_HOST_POLL_CYCLES);
+    hal_host_events();
+    return uarts[uart].ifg;
+}
+
+uint_fast8_t hal_uart_rxErrors(Hal_Uart uart)
+{
+    return uarts[uart].stat;
+}
+
+uint8_t hal_uart_read(Hal_Uart uart)
+{
+    uarts[uart].ifg &= ~HAL_UART_RX_FLAG;
+    uarts[uart].stat = 0;
+    return uarts[uart].rxbuf;
+}
+
+void hal_uart_write(Hal_Uart uart, uint8_t byte)
+{
+    HalHost_Uart *u = &uarts[uart];
+
+    if(u->reset)
+        return;
+
+    /* Writing TXBUF also clears TXCPTIFG */
+    u->ifg &= ~HAL_UART_TXCPT_FLAG;
+
+    if(!u->shiftBusy)
+    {
+        hal_host_shiftLoad(u, byte);
+    }
+    else
+    {
+        u->txbuf = byte;
+        u->txbufFull = true;
+        u->ifg &= ~HAL_UART_TX_FLAG;
+    }
+    hal_host_service();
+}
+
+uint32_t hal_clock_smclkHz(void)
+{
+    return smclkHz;
+}
+
+uint32_t hal_clock_mclkHz(void)
+{
+    return smclkHz;
+}
+
+void hal_irq_disable(void)
+{
+    primask = true;
+}
+
+void hal_irq_enable(void)
+{
+    primask = false;
+    hal_host_service();
+}
+
+void hal_sleepOnExit(bool on)
+{
+    sleepOnExit = on;
+}
+
+void hal_sleep(void)
+{
+    hal_host_wait();
+    hal_host_service();
+}
+
+void hal_defer(void)
+{
+    deferPending = true;
+    hal_host_service();
+}
+
+void hal_gpio_output(uint_fast8_t port, uint_fast16_t pins)
+{
+    (void)port;
+    (void)pins;
+}
+
+/* Carries output levels across the jumpers */
+static void hal_host_gpioWires(uint_fast8_t port)
+{
+    uint_fast8_t n;
+
+    for(n = 0; n < wires; n++)
+    {
+        if(wire[n].outPort == port)
+            hal_host_gpioDrive(wire[n].inPort, wire[n].inPin,
+                               (halHostGpioOut[port] & wire[n].outPin) != 0);
+    }
+}
+
+void hal_gpio_high(uint_fast8_t port, uint_fast16_t pins)
+{
+    if(port < 11)
+    {
+        halHostGpioOut[port] |= pins;
+        hal_host_gpioWires(port);
+    }
+}
+
+void hal_gpio_low(uint_fast8_t port, uint_fast16_t pins)
+{
+    if(port < 11)
+    {
+        halHostGpioOut[port] &= ~pins;
+        hal_host_gpioWires(port);
+    }
+}
+
+void hal_gpio_peripheral(uint_fast8_t port, uint_fast16_t pins)
+{
+    (void)port;
+    (void)pins;
+}
+
+void hal_gpio_input(uint_fast8_t port, uint_fast16_t pins)
+{
+    /* Pull-up: undriven pins read high */
+    if(port < 11)
+        halHostGpioIn[port] |= pins & ~gpioDriven[port];
+}
+
+bool hal_gpio_read(uint_fast8_t port, uint_fast16_t pins)
+{
+    return port < 11 && (halHostGpioIn[port] & pins) != 0;
+}
+
+void hal_gpio_edgeSelect(uint_fast8_t port, uint_fast16_t pins, bool falling)
+{
+    if(port > HAL_HOST_GPIO_IRQ_PORTS)
+        return;
+
+    if(falling)
+        gpio[port].ies |= pins;
+    else
+        gpio[port].ies &= ~pins;
+}
+
+void hal_gpio_edgeIe(uint_fast8_t port, uint_fast16_t pins, bool on)
+{
+    if(port > HAL_HOST_GPIO_IRQ_PORTS)
+        return;
+
+    if(on)
+        gpio[port].ie |= pins;
+    else
+        gpio[port].ie &= ~pins;
+    hal_host_service();
+}
+
+void hal_gpio_edgeClear(uint_fast8_t port, uint_fast16_t pins)
+{
+    if(port <= HAL_HOST_GPIO_IRQ_PORTS)
+        gpio[port].ifg &= ~pins;
+}
+
+void hal_gpio_irqEnable(uint_fast8_t port)
+{
+    if(port > HAL_HOST_GPIO_IRQ_PORTS)
+        return;
+
+    gpio[port].nvic = true;
+    hal_host_service();
+}
+
+void hal_oneshot_init(void)
+{
+    oneshot.running = false;
+    oneshot.ifg = false;
+    oneshot.nvic = true;
+}
+
+void hal_oneshot_start(uint32_t ticks)
+{
+    oneshot.running = true;
+    oneshot.due = now + ticks;
+}
+
+void hal_oneshot_stop(void)
+{
+    oneshot.running = false;
+}
+
+void hal_oneshot_clear(void)
+{
+    oneshot.ifg = false;
+}
+
+void hal_host_uartLoopback(Hal_Uart uart, bool on)
+{
+    uarts[uart].loopback = on;
+}
+
+bool hal_host_uartInject(Hal_Uart uart, uint8_t byte)
+{
+    return hal_host_uartInjectError(uart, byte, 0);
+}
+
+bool hal_host_uartInjectError(Hal_Uart uart, uint8_t byte, uint_fast8_t errors)
+{
+    bool queued = hal_host_rxSchedule(&uarts[uart], byte,
+                                      errors & HAL_UART_ERR_MASK, now);
+
+    hal_host_service();
+    return queued;
+}
+
+void hal_host_uartFeed(Hal_Uart uart, HalHost_RxFeed feed)
+{
+    uarts[uart].rxFeed = feed;
+    hal_host_feed(&uarts[uart]);
+}
+
+void hal_host_uartTxHook(Hal_Uart uart, HalHost_TxHook hook)
+{
+    uarts[uart].txHook = hook;
+}
+
+void hal_host_setSmclk(uint32_t hz)
+{
+    smclkHz = hz;
+}
+
+uint64_t hal_host_now(void)
+{
+    return now;
+}
+
+void hal_host_run(uint64_t cycles)
+{
+    uint64_t end = now + cycles;
+
+    hal_host_events();
+    hal_host_service();
+
+    while(hal_host_nextEvent() <= end)
+    {
+        hal_host_setNow(hal_host_nextEvent());
+        hal_host_events();
+        hal_host_service();
+    }
+
+    if(now < end)
+        hal_host_setNow(end);
+}
+
+void hal_host_gpioDrive(uint_fast8_t port, uint_fast16_t pins, bool high)
+{
+    uint16_t before;
+    uint16_t changed;
+
+    if(port >= 11)
+        return;
+
+    before = halHostGpioIn[port];
+    gpioDriven[port] |= pins;
+    if(high)
+        halHostGpioIn[port] |= pins;
+    else
+        halHostGpioIn[port] &= ~pins;
+    changed = before ^ halHostGpioIn[port];
+
+    if(port <= HAL_HOST_GPIO_IRQ_PORTS)
+    {
+        /* Falling edges on IES pins, rising edges on the others */
+        gpio[port].ifg |= changed & (high ? ~gpio[port].ies : gpio[port].ies);
+        hal_host_service();
+    }
+}
+
+bool hal_host_gpioWire(uint_fast8_t outPort, uint_fast16_t outPin,
+                       uint_fast8_t inPort, uint_fast16_t inPin)
+{
+    if(wires == HAL_HOST_GPIO_WIRES || outPort >= 11 || inPort >= 11)
+        return false;
+
+    wire[wires].outPort = (uint8_t)outPort;
+    wire[wires].outPin = (uint16_t)outPin;
+    wire[wires].inPort = (uint8_t)inPort;
+    wire[wires].inPin = (uint16_t)inPin;
+    wires++;
+
+    hal_host_gpioWires(outPort);
+    return true;
+}
+
+#endif /* __MSP432P401R__ */
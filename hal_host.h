@@ -0,0 +1,151 @@
+/******************************************************************************
+ * Hardware abstraction layer - Linux simulation backend
+ *
+ * Description: See hal.h for the common interface. On top of it the host
+ * backend lets a harness drive and observe the simulated hardware:
+ *
+ *     hal_host_uartLoopback(uart, on)
+ *                                  TX wired back to RX (default on, like
+ *                                  the loopback demo's jumper)
+ *     hal_host_uartInject(uart, byte)
+ *                                  a byte arriving on RX from outside
+ *     hal_host_uartInjectError(uart, byte, errors)
+ *                                  the same with HAL_UART_ERR_* status,
+ *                                  e.g. a framing error or a break
+ *     hal_host_uartFeed(uart, fn)  scripted RX traffic: fn supplies the
+ *                                  next byte and the idle time before its
+ *                                  start bit, each time the last one has
+ *                                  been received, until it returns false
+ *     hal_host_uartTxHook(uart, fn)
+ *                                  called with every byte leaving TX
+ *     hal_host_setSmclk(hz)        simulated SMCLK (default 24 MHz)
+ *     hal_host_now()               simulated time in SMCLK cycles
+ *     hal_host_run(cycles)         the application computing for that
+ *                                  long, interrupts taken as they fall due
+ *     hal_host_gpioDrive(port, pins, high)
+ *                                  an external level on input pins; an
+ *                                  enabled edge calls PORTx_IRQHandler
+ *     hal_host_gpioWire(outPort, outPin, inPort, inPin)
+ *                                  a jumper: the output pin drives the
+ *                                  input pin from then on
+ *
+ * MCLK equals SMCLK. UCRXEIE and UCBRKIE are always in effect.
+ *
+ * Hal_Uart is the module number, HAL_UART_A0..A3 being 0..3.
+ *
+ * EUSCIA0..3_IRQHandler, PORT1..PORT6_IRQHandler, T32_INT1_IRQHandler and
+ * PendSV_Handler are weak references: a program only needs to define the
+ * ones whose interrupts it enables. Interrupts do not nest: each handler
+ * runs to completion, and PendSV_Handler, pended by hal_defer(), is taken
+ * only when no other interrupt is pending, as the lowest priority would.
+ *
+ * Simulated time advances while the application sleeps, and by
+ * HAL_HOST_POLL_CYCLES on every hal_uart_flags() call, so a busy-polling
+ * loop moves time forward too. The cycle_stats.h mock cycle source follows
+ * simulated time, in SMCLK cycles.
+ *
+ * The environment variable HAL_HOST_SECONDS stops the program once that
+ * much simulated time has passed and prints a summary to stderr.
+ *
+ *******************************************************************************/
+#ifndef HAL_HOST_H_
+#define HAL_HOST_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Jumpers hal_host_gpioWire() can hold */
+#define HAL_HOST_GPIO_WIRES     4
+
+/* Simulated cost of one raw flag poll, in SMCLK cycles */
+#define HAL_HOST_POLL_CYCLES    4
+
+typedef uint_fast8_t Hal_Uart;
+
+#define HAL_UART_A0             0
+#define HAL_UART_A1             1
+#define HAL_UART_A2             2
+#define HAL_UART_A3             3
+#define HAL_HOST_UARTS          4
+
+typedef void (*HalHost_TxHook)(uint8_t byte);
+typedef bool (*HalHost_RxFeed)(uint8_t *byte, uint32_t *gapCycles);
+
+typedef struct
+{
+    uint32_t txBytes;
+    uint32_t rxBytes;
+    uint32_t rxOverruns;            /* RXBUF overwritten before read     */
+    uint32_t interrupts;
+} HalHost_UartStats;
+
+/* Per module, indexed by Hal_Uart */
+extern HalHost_UartStats halHostUartStats[HAL_HOST_UARTS];
+
+/* Simulated output latch and input level of each port, index 1..10 */
+extern uint16_t halHostGpioOut[11];
+extern uint16_t halHostGpioIn[11];
+
+extern bool hal_uart_configure(Hal_Uart uart, const Hal_UartConfig *cfg);
+extern void hal_uart_enable(Hal_Uart uart);
+extern void hal_uart_irqEnable(Hal_Uart uart);
+extern void hal_uart_rxIe(Hal_Uart uart, bool on);
+extern void hal_uart_txIe(Hal_Uart uart, bool on);
+extern void hal_uart_txCptIe(Hal_Uart uart, bool on);
+extern void hal_uart_txCptClear(Hal_Uart uart);
+extern uint_fast8_t hal_uart_pending(Hal_Uart uart);
+extern uint_fast8_t hal_uart_flags(Hal_Uart uart);
+extern uint_fast8_t hal_uart_rxErrors(Hal_Uart uart);
+extern uint8_t hal_uart_read(Hal_Uart uart);
+extern void hal_uart_write(Hal_Uart uart, uint8_t byte);
+
+extern uint32_t hal_clock_smclkHz(void);
+extern uint32_t hal_clock_mclkHz(void);
+extern void hal_irq_disable(void);
+extern void hal_irq_enable(void);
+extern void hal_sleepOnExit(bool on);
+extern void hal_sleep(void);
+extern void hal_defer(void);
+
+static inline void hal_bit_set(volatile uint32_t *word, uint_fast8_t bit)
+{
+    __atomic_fetch_or(word, (uint32_t)1 << bit, __ATOMIC_SEQ_CST);
+}
+
+static inline void hal_bit_clear(volatile uint32_t *word, uint_fast8_t bit)
+{
+    __atomic_fetch_and(word, ~((uint32_t)1 << bit), __ATOMIC_SEQ_CST);
+}
+
+extern void hal_gpio_output(uint_fast8_t port, uint_fast16_t pins);
+extern void hal_gpio_high(uint_fast8_t port, uint_fast16_t pins);
+extern void hal_gpio_low(uint_fast8_t port, uint_fast16_t pins);
+extern void hal_gpio_peripheral(uint_fast8_t port, uint_fast16_t pins);
+extern void hal_gpio_input(uint_fast8_t port, uint_fast16_t pins);
+extern bool hal_gpio_read(uint_fast8_t port, uint_fast16_t pins);
+extern void hal_gpio_edgeSelect(uint_fast8_t port, uint_fast16_t pins,
+                                bool falling);
+extern void hal_gpio_edgeIe(uint_fast8_t port, uint_fast16_t pins, bool on);
+extern void hal_gpio_edgeClear(uint_fast8_t port, uint_fast16_t pins);
+extern void hal_gpio_irqEnable(uint_fast8_t port);
+
+extern void hal_oneshot_init(void);
+extern void hal_oneshot_start(uint32_t ticks);
+extern void hal_oneshot_stop(void);
+extern void hal_oneshot_clear(void);
+
+extern void hal_host_uartLoopback(Hal_Uart uart, bool on);
+extern bool hal_host_uartInject(Hal_Uart uart, uint8_t byte);
+extern bool hal_host_uartInjectError(Hal_Uart uart, uint8_t byte,
+                                     uint_fast8_t errors);
+extern void hal_host_uartFeed(Hal_Uart uart, HalHost_RxFeed feed);
+extern void hal_host_uartTxHook(Hal_Uart uart, HalHost_TxHook hook);
+extern void hal_host_setSmclk(uint32_t hz);
+extern uint64_t hal_host_now(void);
+extern void hal_host_run(uint64_t cycles);
+extern void hal_host_gpioDrive(uint_fast8_t port, uint_fast16_t pins,
+                               bool high);
+extern bool hal_host_gpioWire(uint_fast8_t outPort, uint_fast16_t outPin,
+                              uint_fast8_t inPort, uint_fast16_t inPin);
+
+#endif /* HAL_HOST_H_ */
@@ -0,0 +1,249 @@
+/******************************************************************************
+ * Hardware abstraction layer - MSP432 backend
+ *
+ * Description: See hal.h. Interrupt enables that the ISR and thread code
+ * both change go through their bit-band aliases, one store each.
+ *
+ *******************************************************************************/
+#ifndef HAL_MSP432_H_
+#define HAL_MSP432_H_
+
+/* DriverLib Includes */
+#include <ti/devices/msp432p4xx/driverlib/driverlib.h>
+#include <ti/devices/msp432p4xx/inc/msp.h>
+
+/* A UART is its eUSCI_A register block */
+typedef EUSCI_A_Type *Hal_Uart;
+
+#define HAL_UART_A0             EUSCI_A0
+#define HAL_UART_A1             EUSCI_A1
+#define HAL_UART_A2             EUSCI_A2
+#define HAL_UART_A3             EUSCI_A3
+
+/* The modules are 1 KiB apart and INT_EUSCIA0..3 are consecutive */
+#define HAL_UART_BASE(uart)     ((uint32_t)(uart))
+#define HAL_UART_INT(uart)                                                    \
+    (INT_EUSCIA0 + ((HAL_UART_BASE(uart) - EUSCI_A0_BASE) >> 10))
+
+static inline bool hal_uart_configure(Hal_Uart uart, const Hal_UartConfig *cfg)
+{
+    const eUSCI_UART_ConfigV1 config =
+    {
+        EUSCI_A_UART_CLOCKSOURCE_SMCLK,
+        cfg->brdiv,
+        cfg->brf,
+        cfg->brs,
+        EUSCI_A_UART_NO_PARITY,
+        EUSCI_A_UART_LSB_FIRST,
+        EUSCI_A_UART_ONE_STOP_BIT,
+        EUSCI_A_UART_MODE,
+        cfg->overSampling ?
+            EUSCI_A_UART_OVERSAMPLING_BAUDRATE_GENERATION :
+            EUSCI_A_UART_LOW_FREQUENCY_BAUDRATE_GENERATION,
+        EUSCI_A_UART_8_BIT_LEN
+    };
+
+    if(!MAP_UART_initModule(HAL_UART_BASE(uart), &config))
+        return false;
+
+    /* Still in reset: let erroneous and break characters set RXIFG, so
+     * the driver sees their status instead of losing them silently */
+    uart->CTLW0 |= EUSCI_A_CTLW0_RXEIE | EUSCI_A_CTLW0_BRKIE;
+    return true;
+}
+
+static inline void hal_uart_enable(Hal_Uart uart)
+{
+    MAP_UART_enableModule(HAL_UART_BASE(uart));
+}
+
+static inline void hal_uart_irqEnable(Hal_Uart uart)
+{
+    MAP_Interrupt_enableInterrupt(HAL_UART_INT(uart));
+}
+
+static inline void hal_uart_rxIe(Hal_Uart uart, bool on)
+{
+    BITBAND_PERI(uart->IE, EUSCI_A_IE_RXIE_OFS) = on;
+}
+
+static inline void hal_uart_txIe(Hal_Uart uart, bool on)
+{
+    BITBAND_PERI(uart->IE, EUSCI_A_IE_TXIE_OFS) = on;
+}
+
+static inline void hal_uart_txCptIe(Hal_Uart uart, bool on)
+{
+    BITBAND_PERI(uart->IE, EUSCI_A_IE_TXCPTIE_OFS) = on;
+}
+
+static inline void hal_uart_txCptClear(Hal_Uart uart)
+{
+    BITBAND_PERI(uart->IFG, EUSCI_A_IFG_TXCPTIFG_OFS) = 0;
+}
+
+/* Straight from the registers: the ISRs call this first thing */
+static inline uint_fast8_t hal_uart_pending(Hal_Uart uart)
+{
+    return uart->IFG & uart->IE;
+}
+
+static inline uint_fast8_t hal_uart_flags(Hal_Uart uart)
+{
+    return uart->IFG & (HAL_UART_RX_FLAG | HAL_UART_TX_FLAG |
+                        HAL_UART_TXCPT_FLAG);
+}
+
+static inline uint_fast8_t hal_uart_rxErrors(Hal_Uart uart)
+{
+    return uart->STATW & HAL_UART_ERR_MASK;
+}
+
+static inline uint8_t hal_uart_read(Hal_Uart uart)
+{
+    return (uint8_t)uart->RXBUF;
+}
+
+static inline void hal_uart_write(Hal_Uart uart, uint8_t byte)
+{
+    uart->TXBUF = byte;
+}
+
+static inline uint32_t hal_clock_smclkHz(void)
+{
+    return MAP_CS_getSMCLK();
+}
+
+static inline uint32_t hal_clock_mclkHz(void)
+{
+    return MAP_CS_getMCLK();
+}
+
+static inline void hal_irq_disable(void)
+{
+    MAP_Interrupt_disableMaster();
+}
+
+static inline void hal_irq_enable(void)
+{
+    MAP_Interrupt_enableMaster();
+}
+
+static inline void hal_sleepOnExit(bool on)
+{
+    if(on)
+        MAP_Interrupt_enableSleepOnIsrExit();
+    else
+        MAP_Interrupt_disableSleepOnIsrExit();
+}
+
+static inline void hal_sleep(void)
+{
+    MAP_PCM_gotoLPM0();
+}
+
+static inline void hal_defer(void)
+{
+    SCB->ICSR = SCB_ICSR_PENDSVSET_Msk;
+}
+
+/* Bit-band stores: a single write, no read-modify-write to interrupt */
+static inline void hal_bit_set(volatile uint32_t *word, uint_fast8_t bit)
+{
+    BITBAND_SRAM(*word, bit) = 1;
+}
+
+static inline void hal_bit_clear(volatile uint32_t *word, uint_fast8_t bit)
+{
+    BITBAND_SRAM(*word, bit) = 0;
+}
+
+static inline void hal_gpio_output(uint_fast8_t port, uint_fast16_t pins)
+{
+    MAP_GPIO_setAsOutputPin(port, pins);
+}
+
+static inline void hal_gpio_high(uint_fast8_t port, uint_fast16_t pins)
+{
+    MAP_GPIO_setOutputHighOnPin(port, pins);
+}
+
+static inline void hal_gpio_low(uint_fast8_t port, uint_fast16_t pins)
+{
+    MAP_GPIO_setOutputLowOnPin(port, pins);
+}
+
+static inline void hal_gpio_peripheral(uint_fast8_t port, uint_fast16_t pins)
+{
+    MAP_GPIO_setAsPeripheralModuleFunctionInputPin(port, pins,
+            GPIO_PRIMARY_MODULE_FUNCTION);
+}
+
+static inline void hal_gpio_input(uint_fast8_t port, uint_fast16_t pins)
+{
+    MAP_GPIO_setAsInputPinWithPullUpResistor(port, pins);
+}
+
+static inline bool hal_gpio_read(uint_fast8_t port, uint_fast16_t pins)
+{
+    return MAP_GPIO_getInputPinValue(port, pins) == GPIO_INPUT_PIN_HIGH;
+}
+
+static inline void hal_gpio_edgeSelect(uint_fast8_t port, uint_fast16_t pins,
+                                       bool falling)
+{
+    MAP_GPIO_interruptEdgeSelect(port, pins, falling ?
+            GPIO_HIGH_TO_LOW_TRANSITION : GPIO_LOW_TO_HIGH_TRANSITION);
+}
+
+static inline void hal_gpio_edgeIe(uint_fast8_t port, uint_fast16_t pins,
+                                   bool on)
+{
+    if(on)
+        MAP_GPIO_enableInterrupt(port, pins);
+    else
+        MAP_GPIO_disableInterrupt(port, pins);
+}
+
+static inline void hal_gpio_edgeClear(uint_fast8_t port, uint_fast16_t pins)
+{
+    MAP_GPIO_clearInterruptFlag(port, pins);
+}
+
+/* INT_PORT1..INT_PORT6 are consecutive */
+static inline void hal_gpio_irqEnable(uint_fast8_t port)
+{
+    MAP_Interrupt_enableInterrupt(INT_PORT1 + port - 1);
+}
+
+#define HAL_ONESHOT_REGS        TIMER32_1
+#define HAL_ONESHOT_INT         INT_T32_INT1
+
+#define HAL_ONESHOT_CONTROL     (TIMER32_CONTROL_IE | TIMER32_CONTROL_SIZE |  \
+                                 TIMER32_CONTROL_ONESHOT)
+
+static inline void hal_oneshot_init(void)
+{
+    HAL_ONESHOT_REGS->CONTROL = HAL_ONESHOT_CONTROL;
+    HAL_ONESHOT_REGS->INTCLR = 0;
+    MAP_Interrupt_enableInterrupt(HAL_ONESHOT_INT);
+}
+
+/* Writing LOAD restarts the count immediately, running or not */
+static inline void hal_oneshot_start(uint32_t ticks)
+{
+    HAL_ONESHOT_REGS->LOAD = ticks;
+    HAL_ONESHOT_REGS->CONTROL = HAL_ONESHOT_CONTROL | TIMER32_CONTROL_ENABLE;
+}
+
+static inline void hal_oneshot_stop(void)
+{
+    HAL_ONESHOT_REGS->CONTROL = HAL_ONESHOT_CONTROL;
+}
+
+static inline void hal_oneshot_clear(void)
+{
+    HAL_ONESHOT_REGS->INTCLR = 0;
+}
+
+#endif /* HAL_MSP432_H_ */
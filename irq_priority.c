@@ -0,0 +1,53 @@
+/******************************************************************************
+ * Interrupt priority plan
+ *
+ * See irq_priority.h. The table names the vectors rather than the modules'
+ * *_INT macros so the whole plan reads in one place; the modules that own
+ * them are in the comments.
+ *
+ *******************************************************************************/
+/* DriverLib Includes */
+#include <ti/devices/msp432p4xx/driverlib/driverlib.h>
+
+#include "irq_priority.h"
+
+typedef struct
+{
+    uint32_t interrupt;
+    uint8_t priority;
+} IrqPriority_Entry;
+
+static const IrqPriority_Entry plan[] =
+{
+    /* Bit timing */
+    { INT_TA1_N,        IRQ_PRIO_BIT_TIMING },  /* gpio_uart timer        */
+    { INT_PORT6,        IRQ_PRIO_BIT_TIMING },  /* gpio_uart start bit    */
+    { INT_TA2_0,        IRQ_PRIO_BIT_TIMING },  /* gpio_uart_mc tick      */
+    { INT_PORT3,        IRQ_PRIO_BIT_TIMING },  /* uart_autobaud edge     */
+
+    /* eUSCI and its helpers */
+    { INT_EUSCIA0,      IRQ_PRIO_UART },
+    { INT_EUSCIA1,      IRQ_PRIO_UART },
+    { INT_EUSCIA2,      IRQ_PRIO_UART },
+    { INT_EUSCIA3,      IRQ_PRIO_UART },
+    { INT_T32_INT1,     IRQ_PRIO_UART },        /* uart_driver RX idle    */
+    { INT_PORT5,        IRQ_PRIO_UART },        /* uart_driver CTS        */
+    { INT_TA3_N,        IRQ_PRIO_UART },        /* uart_autobaud timeout  */
+
+    { INT_DMA_INT0,     IRQ_PRIO_DMA },         /* pattern_uart_msp432    */
+    { INT_DMA_INT1,     IRQ_PRIO_DMA },         /* uart_dma RX            */
+    { INT_DMA_INT2,     IRQ_PRIO_DMA },         /* uart_dma TX            */
+    { INT_DMA_INT3,     IRQ_PRIO_DMA },         /* edge_uart_msp432 ring  */
+    { INT_TA0_N,        IRQ_PRIO_DMA },         /* edge_uart_msp432 flush */
+
+    { FAULT_SYSTICK,    IRQ_PRIO_TICK },
+    { FAULT_PENDSV,     IRQ_PRIO_DEFERRED },
+};
+
+void irq_priority_init(void)
+{
+    uint_fast8_t n;
+
+    for(n = 0; n < sizeof(plan) / sizeof(plan[0]); n++)
+        MAP_Interrupt_setPriority(plan[n].interrupt, plan[n].priority);
+}
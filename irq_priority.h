@@ -0,0 +1,71 @@
+/******************************************************************************
+ * Interrupt priority plan
+ *
+ * Description: Every NVIC priority the firmware uses, set in one place by
+ * irq_priority_init(). The MSP432 implements the top three priority bits
+ * (0x00 highest .. 0xE0 lowest), all of them preempting, so each level
+ * interrupts everything below it:
+ *
+ *     level  IRQ_PRIO_     vectors
+ *     0x00   BIT_TIMING    software UART timers and start-bit edges,
+ *                          autobaud edge timestamps
+ *     0x20   UART          eUSCI_A0..A3, Timer32 RX idle, CTS edge,
+ *                          autobaud timeout
+ *     0x40   DMA           uDMA buffer completion, edge capture
+ *                          flush pacing
+ *     0xC0   TICK          SysTick
+ *     0xE0   DEFERRED      PendSV: data processing
+ *
+ * A bit-timing ISR then waits only for another bit-timing ISR or a
+ * thread-mode section with interrupts masked, never for an eUSCI, DMA or
+ * processing ISR, however long. Its jitter is bounded by the longest of
+ * those plus the entry latency, whatever else is enabled.
+ *
+ * For that the bit-timing ISRs only move bits. Anything that looks at the
+ * bytes they produce is posted as a deferred event (event_sched.h), which
+ * pends PendSV; it runs at the lowest level once every other ISR has
+ * returned, and a single pass serves any number of posts made meanwhile.
+ *
+ * Every eUSCI vector shares one level, which bridge.h relies on.
+ *
+ * Measuring it: with CYCLE_STATS_ENABLE=1 the latency column of the
+ * SWUART_TIMER and MC_TICK probes is the worst delay from compare match to
+ * ISR entry, the bit-timing jitter, and the PENDSV probe shows the work
+ * moved out of those ISRs. All levels but PendSV's can be overridden at
+ * build time to compare plans.
+ *
+ *******************************************************************************/
+#ifndef IRQ_PRIORITY_H_
+#define IRQ_PRIORITY_H_
+
+#include <ti/devices/msp432p4xx/inc/msp.h>
+
+#ifndef IRQ_PRIO_BIT_TIMING
+#define IRQ_PRIO_BIT_TIMING     0x00
+#endif
+
+#ifndef IRQ_PRIO_UART
+#define IRQ_PRIO_UART           0x20
+#endif
+
+#ifndef IRQ_PRIO_DMA
+#define IRQ_PRIO_DMA            0x40
+#endif
+
+#ifndef IRQ_PRIO_TICK
+#define IRQ_PRIO_TICK           0xC0
+#endif
+
+#define IRQ_PRIO_DEFERRED       0xE0
+
+_Static_assert(IRQ_PRIO_BIT_TIMING < IRQ_PRIO_UART &&
+               IRQ_PRIO_UART <= IRQ_PRIO_DMA &&
+               IRQ_PRIO_DMA <= IRQ_PRIO_TICK &&
+               IRQ_PRIO_TICK < IRQ_PRIO_DEFERRED,
+               "bit timing must lead and PendSV must trail every level");
+
+/* Applies the plan to every vector the firmware may use, enabled or not.
+ * Call before enabling any interrupt. */
+extern void irq_priority_init(void);
+
+#endif /* IRQ_PRIORITY_H_ */
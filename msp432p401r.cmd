@@ -123,6 +123,8 @@ SECTIONS
     .vtable :   > 0x20000000
     .data   :   > SRAM_DATA
     .bss    :   > SRAM_DATA
+    .blockpool  :   > SRAM_DATA     /* block_pool.h, not zeroed */
+    .TI.noinit  :   > SRAM_DATA, type = NOINIT  /* noinit.h */
     .sysmem :   > SRAM_DATA
     .stack  :   > SRAM_DATA (HIGH)
 
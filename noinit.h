@@ -0,0 +1,27 @@
+/******************************************************************************
+ * Buffers left out of the start-up zeroing
+ *
+ * Description: NOINIT marks a static buffer the C start-up code need not
+ * clear. _c_int00 zeroes all of .bss before main() runs, so every RX/TX
+ * ring and DMA buffer costs boot time although its owner never reads a
+ * byte it has not written: a ring is empty by its indices, a pattern half
+ * is expanded before it is armed, a capture slot written by the DMA before
+ * it is decoded.
+ *
+ * NOINIT puts them in .TI.noinit, which msp432p401r.cmd places in
+ * SRAM_DATA as a NOINIT section, so the start-up code leaves it alone.
+ * Only plain data buffers belong there: anything holding an index, a flag
+ * or a pointer must still start from zero or be set by its init function.
+ * The host build has no start-up cost to save and NOINIT is empty there.
+ *
+ *******************************************************************************/
+#ifndef NOINIT_H_
+#define NOINIT_H_
+
+#ifdef __MSP432P401R__
+#define NOINIT              __attribute__((section(".TI.noinit")))
+#else
+#define NOINIT
+#endif
+
+#endif /* NOINIT_H_ */
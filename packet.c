@@ -0,0 +1,198 @@
+/******************************************************************************
+ * COBS framed packets with CRC over a UART byte stream
+ *
+ * See packet.h. COBS splits the frame at every zero byte; each block is sent
+ * as a code byte (block length + 1) followed by the block's non-zero bytes,
+ * the zero itself being implied. A code of 0xFF marks a full 254-byte block
+ * with no zero after it.
+ *
+ *******************************************************************************/
+#include "packet.h"
+#include "crc.h"
+
+#define PACKET_SLOT_MASK        (PACKET_RX_SLOTS - 1)
+
+void packet_rxInit(PacketRx *rx)
+{
+    rx->head = 0;
+    rx->tail = 0;
+    rx->pos = 0;
+    rx->left = 0;
+    rx->zeroPending = false;
+    rx->discard = false;
+    rx->dropped = 0;
+    rx->malformed = 0;
+    rx->badCrc = 0;
+}
+
+static inline void packet_rxRestart(PacketRx *rx)
+{
+    rx->pos = 0;
+    rx->left = 0;
+    rx->zeroPending = false;
+    rx->discard = false;
+}
+
+void packet_rxByte(PacketRx *rx, uint8_t byte)
+{
+    uint8_t *slot;
+
+    if(byte == 0)
+    {
+        /* Delimiter: publish if the frame ended on a block boundary */
+        if(!rx->discard && rx->pos != 0)
+        {
+            if(rx->left != 0 || rx->pos < PACKET_CRC_BYTES)
+            {
+                rx->malformed++;
+            }
+            else
+            {
+                rx->len[rx->head & PACKET_SLOT_MASK] = rx->pos;
+                RING_BARRIER();
+                rx->head++;
+            }
+        }
+        packet_rxRestart(rx);
+        return;
+    }
+
+    if(rx->discard)
+        return;
+
+    if(rx->pos == 0 && rx->left == 0 && !rx->zeroPending &&
+       (uint8_t)(rx->head - rx->tail) >= PACKET_RX_SLOTS)
+    {
+        rx->dropped++;
+        rx->discard = true;
+        return;
+    }
+
+    slot = rx->buf[rx->head & PACKET_SLOT_MASK];
+
+    if(rx->left == 0)
+    {
+        /* Code byte: the previous block's implied zero is data after all */
+        if(rx->zeroPending)
+        {
+            if(rx->pos >= PACKET_FRAME_MAX)
+                goto overflow;
+            slot[rx->pos++] = 0;
+        }
+        rx->left = byte - 1;
+        rx->zeroPending = byte != 0xFF;
+        return;
+    }
+
+    if(rx->pos >= PACKET_FRAME_MAX)
+        goto overflow;
+    slot[rx->pos++] = byte;
+    rx->left--;
+    return;
+
+overflow:
+    rx->malformed++;
+    rx->discard = true;
+}
+
+int packet_receive(PacketRx *rx, const uint8_t **payload)
+{
+    while(rx->tail != rx->head)
+    {
+        uint8_t index = rx->tail & PACKET_SLOT_MASK;
+        const uint8_t *frame;
+        uint16_t len;
+        bool ok;
+
+        RING_BARRIER();
+        frame = rx->buf[index];
+        len = rx->len[index] - PACKET_CRC_BYTES;
+
+#if PACKET_CRC_BITS == 32
+        ok = crc32_compute(frame, len) ==
+             ((uint32_t)frame[len] | (uint32_t)frame[len + 1] << 8 |
+              (uint32_t)frame[len + 2] << 16 | (uint32_t)frame[len + 3] << 24);
+#else
+        ok = crc16_compute(frame, len) ==
+             (uint16_t)(frame[len] | frame[len + 1] << 8);
+#endif
+        if(ok)
+        {
+            *payload = frame;
+            return len;
+        }
+
+        rx->badCrc++;
+        packet_release(rx);
+    }
+
+    return -1;
+}
+
+void packet_release(PacketRx *rx)
+{
+    RING_BARRIER();
+    rx->tail++;
+}
+
+bool packet_send(RingBuffer *ring, const uint8_t *payload, uint16_t len)
+{
+    uint8_t crc[PACKET_CRC_BYTES];
+    uint16_t total = len + PACKET_CRC_BYTES;
+    uint16_t codeAt = 0;            /* Ring offset of the open code byte */
+    uint16_t out = 1;
+    uint8_t code = 1;
+    uint16_t n;
+
+    if(len > PACKET_MAX_PAYLOAD || ring_space(ring) < PACKET_ENCODED_MAX(len))
+        return false;
+
+#if PACKET_CRC_BITS == 32
+    {
+        uint32_t c = crc32_compute(payload, len);
+        crc[0] = (uint8_t)c;
+        crc[1] = (uint8_t)(c >> 8);
+        crc[2] = (uint8_t)(c >> 16);
+        crc[3] = (uint8_t)(c >> 24);
+    }
+#else
+    {
+        uint16_t c = crc16_compute(payload, len);
+        crc[0] = (uint8_t)c;
+        crc[1] = (uint8_t)(c >> 8);
+    }
+#endif
+
+    for(n = 0; n < total; n++)
+    {
+        uint8_t byte = n < len ? payload[n] : crc[n - len];
+
+        if(byte == 0)
+        {
+            ring_poke(ring, codeAt, code);
+            codeAt = out++;
+            code = 1;
+            continue;
+        }
+
+        ring_poke(ring, out++, byte);
+        if(++code == 0xFF)
+        {
+            /* Full block: close it, and open the next one only if more
+             * data follows, otherwise the decoder sees an empty block */
+            ring_poke(ring, codeAt, code);
+            code = 1;
+            if(n + 1 < total)
+                codeAt = out++;
+            else
+                codeAt = 0xFFFF;
+        }
+    }
+
+    if(codeAt != 0xFFFF)
+        ring_poke(ring, codeAt, code);
+    ring_poke(ring, out++, 0);
+
+    ring_commit(ring, out);
+    return true;
+}
@@ -0,0 +1,112 @@
+/******************************************************************************
+ * COBS framed packets with CRC over a UART byte stream
+ *
+ * Description: Each packet is payload || CRC (little endian), COBS encoded
+ * and terminated by a single 0x00 delimiter:
+ *
+ *     [COBS(payload, crc)] 0x00
+ *
+ * COBS guarantees the delimiter never shows up inside a frame, so a
+ * receiver that joins mid-stream or hits a corrupted byte resynchronises
+ * at the next zero. The overhead is one byte per 254 plus the delimiter.
+ *
+ * A byte corrupted into 0x00 cuts its frame in two, and the CRC then has
+ * to reject the piece before the cut as a frame of its own. It does,
+ * except for payloads built of runs: as many 0xFF bytes as the CRC is wide
+ * clear its register from the initial value, 0x00 bytes keep it clear and
+ * the CRC-32 of nothing is 0, so such a payload can be cut into a piece
+ * that checks. Applications sending runs should check the length or the
+ * content of what arrives.
+ *
+ * RX: packet_rxByte() decodes one byte at a time and is meant to be called
+ * straight from the UART RX ISR (see uart_setRxHandler()). Decoded bytes
+ * land directly in one of PACKET_RX_SLOTS frame slots, which the main loop
+ * later reads in place; nothing is copied a second time. The CRC is
+ * checked in packet_receive(), in thread context, because on the target it
+ * runs on the shared CRC32 module.
+ *
+ * TX: packet_send() encodes straight into the free space of a TX ring and
+ * publishes the whole frame at once, so a half-written frame is never
+ * transmitted and there is no intermediate frame buffer either.
+ *
+ * The CRC width is PACKET_CRC_BITS, 16 or 32 (see crc.h).
+ *
+ *******************************************************************************/
+#ifndef PACKET_H_
+#define PACKET_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "ring_buffer.h"
+
+#ifndef PACKET_CRC_BITS
+#define PACKET_CRC_BITS         32
+#endif
+
+#if PACKET_CRC_BITS != 16 && PACKET_CRC_BITS != 32
+#error "PACKET_CRC_BITS must be 16 or 32"
+#endif
+
+#define PACKET_CRC_BYTES        (PACKET_CRC_BITS / 8)
+
+/* Largest payload accepted in either direction */
+#ifndef PACKET_MAX_PAYLOAD
+#define PACKET_MAX_PAYLOAD      256
+#endif
+
+/* Decoded frames that may wait for the main loop */
+#ifndef PACKET_RX_SLOTS
+#define PACKET_RX_SLOTS         2
+#endif
+
+#if PACKET_RX_SLOTS < 1 || PACKET_RX_SLOTS > 128 || \
+    (PACKET_RX_SLOTS & (PACKET_RX_SLOTS - 1)) != 0
+#error "PACKET_RX_SLOTS must be a power of two <= 128"
+#endif
+
+#define PACKET_FRAME_MAX        (PACKET_MAX_PAYLOAD + PACKET_CRC_BYTES)
+
+/* Worst-case wire size of a payload: COBS codes plus the delimiter */
+#define PACKET_ENCODED_MAX(len)                                               \
+    ((len) + PACKET_CRC_BYTES + ((len) + PACKET_CRC_BYTES) / 254 + 2)
+
+typedef struct
+{
+    uint8_t buf[PACKET_RX_SLOTS][PACKET_FRAME_MAX];
+    volatile uint16_t len[PACKET_RX_SLOTS];
+    volatile uint8_t head;          /* Slots published, written by the ISR */
+    volatile uint8_t tail;          /* Slots released, written by main     */
+
+    /* Decoder state, ISR only */
+    uint16_t pos;                   /* Decoded bytes in the current slot   */
+    uint8_t  left;                  /* Bytes left in the current COBS block */
+    bool     zeroPending;           /* Block ended short: a zero follows   */
+    bool     discard;               /* Skip to the next delimiter          */
+
+    /* Error counters, wrap-around */
+    volatile uint16_t dropped;      /* No free slot                        */
+    volatile uint16_t malformed;    /* Bad COBS or oversized frame         */
+    volatile uint16_t badCrc;
+} PacketRx;
+
+extern void packet_rxInit(PacketRx *rx);
+
+/* Feeds one received byte. ISR side. */
+extern void packet_rxByte(PacketRx *rx, uint8_t byte);
+
+/* Returns the payload length of the oldest complete frame and points
+ * payload at it in place, or -1 if there is none. Frames failing the CRC
+ * are counted and skipped. The slot stays owned by the caller until
+ * packet_release(). Main side. */
+extern int packet_receive(PacketRx *rx, const uint8_t **payload);
+
+/* Hands the slot returned by packet_receive() back to the decoder */
+extern void packet_release(PacketRx *rx);
+
+/* Appends the CRC, encodes and queues one frame into ring. All or nothing:
+ * returns false if len exceeds PACKET_MAX_PAYLOAD or the ring has less than
+ * PACKET_ENCODED_MAX(len) bytes free. Producer side of ring. */
+extern bool packet_send(RingBuffer *ring, const uint8_t *payload, uint16_t len);
+
+#endif /* PACKET_H_ */
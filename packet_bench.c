@@ -0,0 +1,235 @@
+/******************************************************************************
+ * COBS packet round trip, corruption and throughput - host
+ *
+ * Description: Runs packet.c and crc.c end to end: packet_send() into a
+ * TX ring, the ring byte by byte into packet_rxByte(), packet_receive()
+ * back out. First the CRCs against their check values, then one CSV line
+ * per stream case:
+ *
+ *     case,frames,corrupted,delivered,lost,wrong,wrong_runs
+ *
+ * A stream is BENCH_FRAMES frames of 0 to PACKET_MAX_PAYLOAD bytes, drawn
+ * from all zeros, no zeros, 0xFF runs and random bytes so COBS blocks end
+ * on zeros, at 254 bytes and at the end of the frame. In the corruption
+ * cases every other frame is damaged on the wire before it is fed: one bit
+ * flipped, or one byte dropped, anywhere before the delimiter. delivered
+ * counts frames packet_receive() returns, lost clean frames that do not
+ * come back, so a damaged frame must not take the clean one after it down
+ * with it. wrong counts payloads that come back different from the frame
+ * sent for the no-zero and random payloads, wrong_runs for the all-zero
+ * and 0xFF-run ones. lost and wrong must be 0; wrong_runs is the limit
+ * packet.h describes, damage that cuts a frame of such runs short.
+ *
+ * Then one CSV line per payload size:
+ *
+ *     payload,encode_mb_s,decode_mb_s
+ *
+ * encode is packet_send() with its CRC, decode packet_rxByte() over the
+ * encoded frame plus the CRC check in packet_receive(), both in payload
+ * bytes per second. Host figures: the target runs the CRC on its CRC32
+ * module a byte at a time, the host on tables.
+ *
+ * Host only: the target build sees an empty file. Build and run with
+ * (-DPACKET_CRC_BITS=16 for the CRC-16 variant):
+ *
+ *     cc -std=gnu11 -O2 -I. packet_bench.c packet.c crc.c -o packet_bench
+ *     ./packet_bench
+ *
+ *******************************************************************************/
+#ifndef __MSP432P401R__
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "packet.h"
+#include "crc.h"
+
+#define BENCH_FRAMES        100000
+#define BENCH_REPEAT        200000
+
+typedef enum
+{
+    DAMAGE_NONE,
+    DAMAGE_FLIP,
+    DAMAGE_DROP
+} PacketBench_Damage;
+
+static const char *const damageNames[] = { "clean", "bitflip", "drop" };
+
+static const uint16_t payloads[] = { 16, 64, 256 };
+
+RING_BUFFER_DEFINE(txRing, 1024);
+
+static PacketRx rx;
+
+static uint32_t rng = 0x2545F491;
+
+static uint32_t bench_random(void)
+{
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return rng;
+}
+
+static uint64_t bench_ns(void)
+{
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t)t.tv_sec * 1000000000u + (uint64_t)t.tv_nsec;
+}
+
+/* Fills p, returns its length and whether it is made of runs */
+static uint16_t bench_payload(uint8_t *p, bool *runs)
+{
+    uint16_t len = (uint16_t)(bench_random() % (PACKET_MAX_PAYLOAD + 1));
+    uint32_t kind = bench_random() % 4;
+    uint16_t n;
+
+    *runs = kind == 0 || kind == 2;
+
+    for(n = 0; n < len; n++)
+    {
+        switch(kind)
+        {
+        case 0:  p[n] = 0; break;
+        case 1:  p[n] = (uint8_t)(1 + bench_random() % 255); break;
+        case 2:  p[n] = bench_random() % 8 ? 0xFF : 0; break;
+        default: p[n] = (uint8_t)bench_random(); break;
+        }
+    }
+
+    return len;
+}
+
+static bool bench_checkCrc(void)
+{
+    static const uint8_t check[] = "123456789";
+
+    return crc16_compute(check, 9) == 0x29B1 &&
+           crc32_compute(check, 9) == 0xCBF43926;
+}
+
+static void bench_stream(PacketBench_Damage damage)
+{
+    static uint8_t wire[PACKET_ENCODED_MAX(PACKET_MAX_PAYLOAD)];
+    uint8_t sent[PACKET_MAX_PAYLOAD];
+    uint32_t corrupted = 0;
+    uint32_t delivered = 0;
+    uint32_t lost = 0;
+    uint32_t wrong = 0;
+    uint32_t wrongRuns = 0;
+    uint32_t frame;
+
+    packet_rxInit(&rx);
+
+    for(frame = 0; frame < BENCH_FRAMES; frame++)
+    {
+        bool runs;
+        uint16_t len = bench_payload(sent, &runs);
+        bool damaged = damage != DAMAGE_NONE && (frame & 1);
+        bool back = false;
+        const uint8_t *payload;
+        uint16_t count;
+        uint16_t at;
+        uint16_t n;
+        int got;
+
+        packet_send(&txRing, sent, len);
+        count = ring_read(&txRing, wire, sizeof(wire));
+
+        /* Anywhere before the delimiter */
+        at = (uint16_t)(bench_random() % (count - 1));
+        if(damaged && damage == DAMAGE_FLIP)
+            wire[at] ^= (uint8_t)(1 << bench_random() % 8);
+        else if(damaged)
+            memmove(&wire[at], &wire[at + 1], --count - at);
+        corrupted += damaged;
+
+        for(n = 0; n < count; n++)
+            packet_rxByte(&rx, wire[n]);
+
+        while((got = packet_receive(&rx, &payload)) >= 0)
+        {
+            delivered++;
+            if(!damaged && !back && got == len && !memcmp(payload, sent, len))
+                back = true;
+            else if(runs)
+                wrongRuns++;
+            else
+                wrong++;
+            packet_release(&rx);
+        }
+        if(!damaged && !back)
+            lost++;
+    }
+
+    printf("%s,%u,%u,%u,%u,%u,%u\n", damageNames[damage], BENCH_FRAMES,
+           corrupted, delivered, lost, wrong, wrongRuns);
+}
+
+static void bench_throughput(uint16_t len)
+{
+    static uint8_t wire[PACKET_ENCODED_MAX(PACKET_MAX_PAYLOAD)];
+    uint8_t sent[PACKET_MAX_PAYLOAD];
+    const uint8_t *payload;
+    uint64_t encode;
+    uint64_t decode;
+    uint64_t t0;
+    uint16_t count;
+    uint32_t k;
+    uint16_t n;
+
+    for(n = 0; n < len; n++)
+        sent[n] = (uint8_t)bench_random();
+
+    t0 = bench_ns();
+    for(k = 0; k < BENCH_REPEAT; k++)
+    {
+        packet_send(&txRing, sent, len);
+
+        /* Discarded unread, as the consumer */
+        txRing.tail = txRing.head;
+    }
+    encode = bench_ns() - t0;
+
+    packet_send(&txRing, sent, len);
+    count = ring_read(&txRing, wire, sizeof(wire));
+    packet_rxInit(&rx);
+
+    t0 = bench_ns();
+    for(k = 0; k < BENCH_REPEAT; k++)
+    {
+        for(n = 0; n < count; n++)
+            packet_rxByte(&rx, wire[n]);
+        if(packet_receive(&rx, &payload) >= 0)
+            packet_release(&rx);
+    }
+    decode = bench_ns() - t0;
+
+    printf("%u,%.1f,%.1f\n", len, (double)len * BENCH_REPEAT * 1e3 / encode,
+           (double)len * BENCH_REPEAT * 1e3 / decode);
+}
+
+int main(void)
+{
+    uint_fast8_t n;
+
+    printf("crc16 0x29B1, crc32 0xCBF43926: %s\n",
+           bench_checkCrc() ? "ok" : "FAIL");
+
+    printf("case,frames,corrupted,delivered,lost,wrong,wrong_runs\n");
+    bench_stream(DAMAGE_NONE);
+    bench_stream(DAMAGE_FLIP);
+    bench_stream(DAMAGE_DROP);
+
+    printf("payload,encode_mb_s,decode_mb_s\n");
+    for(n = 0; n < sizeof(payloads) / sizeof(payloads[0]); n++)
+        bench_throughput(payloads[n]);
+
+    return 0;
+}
+
+#endif /* __MSP432P401R__ */
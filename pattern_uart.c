@@ -0,0 +1,94 @@
+/******************************************************************************
+ * Software UART transmitter from port bit patterns - expander
+ *
+ * See pattern_uart.h. Frame format is fixed to 8N1, LSB first.
+ *
+ * The data bits of a frame are built as two words of four port values,
+ * least significant byte first, both starting with every line high. A
+ * table entry has bit 0 of byte k set where bit k of the nibble is 0, so
+ * shifting it to the line's pin and XORing it in pulls exactly those bits
+ * low. The words are stored byte by byte, which keeps the expansion free
+ * of alignment and byte-order assumptions.
+ *
+ *******************************************************************************/
+#include "pattern_uart.h"
+#include "ramfunc.h"
+
+/* Zero bits of a nibble, one per byte lane */
+static const uint32_t nibbleZeros[16] =
+{
+    0x01010101, 0x01010100, 0x01010001, 0x01010000,
+    0x01000101, 0x01000100, 0x01000001, 0x01000000,
+    0x00010101, 0x00010100, 0x00010001, 0x00010000,
+    0x00000101, 0x00000100, 0x00000001, 0x00000000,
+};
+
+void pattern_uart_init(PatternUart *tx)
+{
+    tx->lineMask = 0;
+    tx->rest = 0;
+    tx->lines = 0;
+}
+
+int pattern_uart_addLine(PatternUart *tx, uint_fast8_t pin)
+{
+    uint_fast8_t line = tx->lines;
+
+    if(line >= PATTERN_UART_MAX_LINES || pin > 7 ||
+       (tx->lineMask & (1u << pin)))
+        return -1;
+
+    tx->pin[line] = (uint8_t)pin;
+    ring_init(&tx->txRing[line], tx->txStorage[line],
+              PATTERN_UART_TX_RING_SIZE);
+    tx->lineMask |= (uint8_t)(1u << pin);
+    tx->lines = line + 1;
+    return (int)line;
+}
+
+RAMFUNC uint16_t pattern_uart_expand(PatternUart *tx, uint8_t *out,
+                                     uint16_t frames)
+{
+    const uint8_t idle = tx->rest | tx->lineMask;
+    const uint32_t high = idle * 0x01010101u;
+    uint16_t done;
+
+    for(done = 0; done < frames; done++)
+    {
+        uint32_t lo = high;
+        uint32_t hi = high;
+        uint8_t start = idle;
+        uint_fast8_t n;
+
+        for(n = 0; n < tx->lines; n++)
+        {
+            uint_fast8_t pin = tx->pin[n];
+            uint8_t byte;
+
+            if(!ring_get(&tx->txRing[n], &byte))
+                continue;
+
+            start &= (uint8_t)~(1u << pin);
+            lo ^= nibbleZeros[byte & 0x0F] << pin;
+            hi ^= nibbleZeros[byte >> 4] << pin;
+        }
+
+        /* Every line idle */
+        if(start == idle)
+            break;
+
+        out[0] = start;
+        out[1] = (uint8_t)lo;
+        out[2] = (uint8_t)(lo >> 8);
+        out[3] = (uint8_t)(lo >> 16);
+        out[4] = (uint8_t)(lo >> 24);
+        out[5] = (uint8_t)hi;
+        out[6] = (uint8_t)(hi >> 8);
+        out[7] = (uint8_t)(hi >> 16);
+        out[8] = (uint8_t)(hi >> 24);
+        out[9] = idle;
+        out += PATTERN_UART_FRAME_BITS;
+    }
+
+    return done;
+}
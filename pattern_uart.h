@@ -0,0 +1,92 @@
+/******************************************************************************
+ * Software UART transmitter from port bit patterns - expander
+ *
+ * Description: Sends 8N1 on up to eight pins of one 8-bit port without the
+ * CPU timing a single bit. Queued bytes are expanded ahead of time into a
+ * buffer of whole-port output values, one per bit time, with every line's
+ * start, data and stop bits packed side by side:
+ *
+ *     out[0]      start bits: low on every line with a byte, high on idle
+ *     out[1..8]   data bits 0..7 of each line
+ *     out[9]      stop bits: high on every line
+ *
+ * A timer-paced uDMA channel then copies the buffer to PxOUT one value per
+ * bit (see pattern_uart_msp432.h), so all lines shift in lockstep from a
+ * single stream and the CPU only runs the expansion, once per batch of
+ * frames.
+ *
+ * The expansion takes the lines' bytes round robin, one per line and frame,
+ * and looks each nibble up in a 16-entry table that spreads its four bits
+ * over four port values. A line adds two loads, shifts and XORs per frame,
+ * whatever its data, so a frame for eight lines costs about as much as one
+ * bit-timing ISR of gpio_uart.c.
+ *
+ * PxOUT is written whole: the port bits that are not lines get rest, the
+ * level they had when the stream was set up, and must not be driven by
+ * software meanwhile. Peripheral and input pins are not affected.
+ *
+ * Portable: no driverlib, the MSP432 stream lives in pattern_uart_msp432.c.
+ * Writers and the expansion may run in different contexts; every line's
+ * queue has one writer.
+ *
+ *******************************************************************************/
+#ifndef PATTERN_UART_H_
+#define PATTERN_UART_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "ring_buffer.h"
+
+#define PATTERN_UART_MAX_LINES  8
+
+/* Port values per frame: start, eight data bits, stop */
+#define PATTERN_UART_FRAME_BITS 10
+
+#ifndef PATTERN_UART_TX_RING_SIZE
+#define PATTERN_UART_TX_RING_SIZE   64
+#endif
+
+typedef struct
+{
+    uint8_t lineMask;               /* Port bits driven as lines           */
+    uint8_t rest;                   /* Level of the other port bits        */
+    uint8_t lines;
+    uint8_t pin[PATTERN_UART_MAX_LINES];    /* Port bit of each line       */
+
+    RingBuffer txRing[PATTERN_UART_MAX_LINES];
+    uint8_t txStorage[PATTERN_UART_MAX_LINES][PATTERN_UART_TX_RING_SIZE];
+} PatternUart;
+
+/* Empties the line table and clears rest */
+extern void pattern_uart_init(PatternUart *tx);
+
+/* Adds a line on port bit pin (0..7). Returns the line index, or -1 if
+ * the bit is taken or the table is full. */
+extern int pattern_uart_addLine(PatternUart *tx, uint_fast8_t pin);
+
+/* Expands up to frames frames into out, which must hold
+ * frames * PATTERN_UART_FRAME_BITS bytes. A frame is written while any
+ * line has a byte queued. Returns the number written. */
+extern uint16_t pattern_uart_expand(PatternUart *tx, uint8_t *out,
+                                    uint16_t frames);
+
+/* Queues up to len bytes on a line. Returns the number queued. */
+static inline uint16_t pattern_uart_write(PatternUart *tx, uint_fast8_t line,
+                                          const uint8_t *buf, uint16_t len)
+{
+    return ring_write(&tx->txRing[line], buf, len);
+}
+
+/* True while any line has bytes left to expand */
+static inline bool pattern_uart_pending(const PatternUart *tx)
+{
+    uint_fast8_t n;
+
+    for(n = 0; n < tx->lines; n++)
+        if(!ring_isEmpty(&tx->txRing[n]))
+            return true;
+    return false;
+}
+
+#endif /* PATTERN_UART_H_ */
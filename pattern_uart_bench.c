@@ -0,0 +1,215 @@
+/******************************************************************************
+ * Pattern UART expansion benchmark - host
+ *
+ * Description: Times pattern_uart_expand() against a bit-by-bit reference
+ * on the same traffic for 1, 2, 4 and 8 lines and prints one CSV line per
+ * method and line count:
+ *
+ *     method,lines,frames,bytes,ns_per_frame,ns_per_byte,errors
+ *
+ * Each round queues a different amount on every line, so frames mix busy
+ * and idle lines, and expands the queues in batches of BENCH_FRAMES as
+ * the DMA ISR does. Only the expansion is timed. errors counts bytes
+ * that do not come back when the output is sampled per line like a
+ * receiver would, and must be 0.
+ *
+ * The figures are host timings, not Cortex-M4 ones: the ratio between
+ * the two methods is what carries over.
+ *
+ * Host only: the target build sees an empty file. Build and run with:
+ *
+ *     cc -std=gnu11 -O2 -I. pattern_uart_bench.c pattern_uart.c \
+ *        -o pattern_uart_bench
+ *     ./pattern_uart_bench
+ *
+ *******************************************************************************/
+#ifndef __MSP432P401R__
+
+#include <stdio.h>
+#include <time.h>
+
+#include "pattern_uart.h"
+
+/* Frames per expansion call, as in pattern_uart_msp432.h */
+#define BENCH_FRAMES        8
+
+#define BENCH_ROUNDS        20000
+
+/* Port bits the lines take, out of order; the others hold BENCH_REST */
+static const uint8_t linePins[PATTERN_UART_MAX_LINES] = { 0, 5, 6, 7, 1, 3, 2, 4 };
+#define BENCH_REST          0xA5
+
+typedef uint16_t (*BenchExpand)(PatternUart *tx, uint8_t *out,
+                                uint16_t frames);
+
+/* Reference: every bit of every line placed on its own */
+static uint16_t bitwise_expand(PatternUart *tx, uint8_t *out, uint16_t frames)
+{
+    const uint8_t idle = tx->rest | tx->lineMask;
+    uint16_t done;
+
+    for(done = 0; done < frames; done++)
+    {
+        bool any = false;
+        uint_fast8_t n;
+        uint_fast8_t k;
+
+        for(k = 0; k < PATTERN_UART_FRAME_BITS; k++)
+            out[k] = idle;
+
+        for(n = 0; n < tx->lines; n++)
+        {
+            uint8_t mask = (uint8_t)(1u << tx->pin[n]);
+            uint8_t byte;
+
+            if(!ring_get(&tx->txRing[n], &byte))
+                continue;
+
+            any = true;
+            out[0] &= (uint8_t)~mask;
+            for(k = 0; k < 8; k++)
+                if(!(byte & (1u << k)))
+                    out[1 + k] &= (uint8_t)~mask;
+        }
+
+        if(!any)
+            break;
+        out += PATTERN_UART_FRAME_BITS;
+    }
+
+    return done;
+}
+
+static uint32_t rng = 0x2545F491;
+
+static uint8_t bench_random(void)
+{
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return (uint8_t)rng;
+}
+
+/* Samples each line of frames port values like a receiver and compares
+ * the bytes with what was queued. Returns the number that differ. */
+static uint32_t bench_check(const PatternUart *tx, const uint8_t *out,
+                            uint16_t frames,
+                            uint8_t sent[][PATTERN_UART_TX_RING_SIZE],
+                            uint16_t *seen)
+{
+    uint32_t errors = 0;
+    uint16_t f;
+    uint_fast8_t n;
+
+    for(f = 0; f < frames; f++, out += PATTERN_UART_FRAME_BITS)
+    {
+        for(n = 0; n < tx->lines; n++)
+        {
+            uint8_t mask = (uint8_t)(1u << tx->pin[n]);
+            uint8_t byte = 0;
+            uint_fast8_t k;
+
+            if((out[PATTERN_UART_FRAME_BITS - 1] & mask) == 0)
+                errors++;
+            if(out[0] & mask)
+                continue;
+
+            for(k = 0; k < 8; k++)
+                if(out[1 + k] & mask)
+                    byte |= (uint8_t)(1u << k);
+            if(byte != sent[n][seen[n]++])
+                errors++;
+        }
+
+        /* The other port bits keep rest */
+        for(n = 0; n < PATTERN_UART_FRAME_BITS; n++)
+            if((out[n] & (uint8_t)~tx->lineMask) != tx->rest)
+                errors++;
+    }
+
+    return errors;
+}
+
+static void bench_run(const char *method, BenchExpand expand,
+                      uint_fast8_t lines)
+{
+    static PatternUart tx;
+    static uint8_t sent[PATTERN_UART_MAX_LINES][PATTERN_UART_TX_RING_SIZE];
+    static uint8_t out[BENCH_FRAMES * PATTERN_UART_FRAME_BITS];
+    uint16_t queued[PATTERN_UART_MAX_LINES];
+    uint64_t ns = 0;
+    uint32_t frames = 0;
+    uint32_t bytes = 0;
+    uint32_t errors = 0;
+    uint32_t round;
+    uint_fast8_t n;
+
+    pattern_uart_init(&tx);
+    for(n = 0; n < lines; n++)
+        pattern_uart_addLine(&tx, linePins[n]);
+    tx.rest = BENCH_REST & (uint8_t)~tx.lineMask;
+    rng = 0x2545F491;
+
+    for(round = 0; round < BENCH_ROUNDS; round++)
+    {
+        uint16_t seen[PATTERN_UART_MAX_LINES] = { 0 };
+        struct timespec t0, t1;
+        uint16_t i;
+
+        for(n = 0; n < lines; n++)
+        {
+            queued[n] = (uint16_t)(PATTERN_UART_TX_RING_SIZE -
+                                   (bench_random() % (PATTERN_UART_TX_RING_SIZE / 2)));
+            for(i = 0; i < queued[n]; i++)
+                sent[n][i] = bench_random();
+            pattern_uart_write(&tx, n, sent[n], queued[n]);
+            bytes += queued[n];
+        }
+
+        /* Timed: expansion only, the check replays it below */
+        clock_gettime(CLOCK_MONOTONIC, &t0);
+        while(expand(&tx, out, BENCH_FRAMES) == BENCH_FRAMES)
+            ;
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+        ns += (uint64_t)(t1.tv_sec - t0.tv_sec) * 1000000000u +
+              (uint64_t)(t1.tv_nsec - t0.tv_nsec);
+
+        /* Untimed replay of the round in one go for the check */
+        for(n = 0; n < lines; n++)
+            pattern_uart_write(&tx, n, sent[n], queued[n]);
+        for(;;)
+        {
+            uint16_t f = expand(&tx, out, BENCH_FRAMES);
+
+            if(!f)
+                break;
+            errors += bench_check(&tx, out, f, sent, seen);
+            frames += f;
+        }
+        for(n = 0; n < lines; n++)
+            if(seen[n] != queued[n])
+                errors += (uint32_t)(queued[n] > seen[n] ?
+                                     queued[n] - seen[n] : seen[n] - queued[n]);
+    }
+
+    printf("%s,%u,%lu,%lu,%.2f,%.2f,%lu\n", method, (unsigned)lines,
+           (unsigned long)frames, (unsigned long)bytes,
+           (double)ns / frames, (double)ns / bytes, (unsigned long)errors);
+}
+
+int main(void)
+{
+    static const uint8_t lineCounts[] = { 1, 2, 4, 8 };
+    uint_fast8_t n;
+
+    printf("method,lines,frames,bytes,ns_per_frame,ns_per_byte,errors\n");
+    for(n = 0; n < sizeof(lineCounts); n++)
+    {
+        bench_run("lut", pattern_uart_expand, lineCounts[n]);
+        bench_run("bitwise", bitwise_expand, lineCounts[n]);
+    }
+
+    return 0;
+}
+
+#endif /* __MSP432P401R__ */
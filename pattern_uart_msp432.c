@@ -0,0 +1,181 @@
+/******************************************************************************
+ * Software UART transmitter from port bit patterns - MSP432 binding
+ *
+ * See pattern_uart_msp432.h. Each half is armed with only the frames it
+ * got, and a half with none is left stopped. The controller ends the
+ * stream when it switches to a stopped half; service then restarts it
+ * from the half due next if anything was queued meanwhile, or stops the
+ * timer. service runs from the DMA ISR and from writers with that ISR
+ * masked, so it is also the only reader of the lines' queues.
+ *
+ *******************************************************************************/
+/* DriverLib Includes */
+#include <ti/devices/msp432p4xx/driverlib/driverlib.h>
+
+#include "pattern_uart_msp432.h"
+#include "dma_msp432.h"
+#include "noinit.h"
+
+#define PATTERN_UART_DMA_CH     DMA_CH6_TIMERA3CCR0
+#define PATTERN_UART_HALF       (PATTERN_UART_FRAMES * PATTERN_UART_FRAME_BITS)
+
+#define DIO_OFS_OUT             0x02
+
+_Static_assert(PATTERN_UART_FRAMES >= 1 &&
+               PATTERN_UART_HALF <= 1024,
+               "PATTERN_UART_FRAMES: 1 to 102 frames, a transfer of 1024");
+
+static NOINIT uint8_t pattern[2 * PATTERN_UART_HALF];
+static PatternUart *patternTx = 0;
+static volatile uint8_t *patternOut;
+static uint_fast8_t armed;          /* Halves handed to the controller   */
+static uint_fast8_t slot;           /* Half the controller finishes next */
+static bool running;
+
+/* Expands the next frames into a half and arms it. Returns false, leaving
+ * the half stopped, if every line is idle. */
+static bool pattern_uart_msp432_fill(uint_fast8_t s)
+{
+    uint16_t frames = pattern_uart_expand(patternTx,
+                                          &pattern[s * PATTERN_UART_HALF],
+                                          PATTERN_UART_FRAMES);
+
+    if(!frames)
+        return false;
+
+    MAP_DMA_setChannelTransfer(PATTERN_UART_DMA_CH | DMA_MSP432_SLOT_SEL(s),
+            UDMA_MODE_PINGPONG, &pattern[s * PATTERN_UART_HALF],
+            (void *)patternOut, frames * PATTERN_UART_FRAME_BITS);
+    armed |= 1u << s;
+    return true;
+}
+
+static void pattern_uart_msp432_service(void)
+{
+    /* Retire the halves the controller is done with */
+    while((armed & (1u << slot)) &&
+          MAP_DMA_getChannelMode(PATTERN_UART_DMA_CH |
+                                 DMA_MSP432_SLOT_SEL(slot)) == UDMA_MODE_STOP)
+    {
+        armed &= ~(1u << slot);
+        slot ^= 1;
+    }
+
+    if(!MAP_DMA_isChannelEnabled(PATTERN_UART_DMA_CH & 0x0F))
+    {
+        if(!(armed & (1u << slot)) && !pattern_uart_msp432_fill(slot))
+        {
+            PATTERN_UART_TIMER->CTL &= ~TIMER_A_CTL_MC_3;
+            running = false;
+            return;
+        }
+
+        if(slot)
+            MAP_DMA_enableChannelAttribute(PATTERN_UART_DMA_CH,
+                                           UDMA_ATTR_ALTSELECT);
+        else
+            MAP_DMA_disableChannelAttribute(PATTERN_UART_DMA_CH,
+                                            UDMA_ATTR_ALTSELECT);
+        MAP_DMA_enableChannel(PATTERN_UART_DMA_CH & 0x0F);
+
+        if(!running)
+        {
+            PATTERN_UART_TIMER->CTL |= TIMER_A_CTL_CLR | TIMER_A_CTL_MC__UP;
+            running = true;
+        }
+    }
+
+    /* Keep the half after the streaming one filled */
+    if(!(armed & (1u << (slot ^ 1))))
+        pattern_uart_msp432_fill(slot ^ 1);
+}
+
+bool pattern_uart_msp432_start(PatternUart *tx, uint_fast8_t port,
+                               uint32_t baud)
+{
+    const uint32_t control = UDMA_SIZE_8 | UDMA_SRC_INC_8 |
+                             UDMA_DST_INC_NONE | UDMA_ARB_1;
+    uint32_t period;
+
+    if(port < GPIO_PORT_P1 || port > GPIO_PORT_P10 || baud == 0)
+        return false;
+
+    period = (MAP_CS_getSMCLK() + baud / 2) / baud;
+    if(period < PATTERN_UART_MIN_BIT_TICKS || period > 0x10000)
+        return false;
+
+    pattern_uart_msp432_stop();
+
+    patternTx = tx;
+    patternOut = (volatile uint8_t *)(DIO_BASE + ((port - 1) >> 1) * 0x20 +
+                                      DIO_OFS_OUT + ((port - 1) & 1));
+    armed = 0;
+    slot = 0;
+
+    /* Lines idle high, the rest of the port keeps its level */
+    tx->rest = *patternOut & (uint8_t)~tx->lineMask;
+    MAP_GPIO_setOutputHighOnPin(port, tx->lineMask);
+    MAP_GPIO_setAsOutputPin(port, tx->lineMask);
+
+    /* Timer_A3 in up mode from SMCLK, CCR0 requests a transfer per bit */
+    PATTERN_UART_TIMER->CTL = TIMER_A_CTL_SSEL__SMCLK | TIMER_A_CTL_CLR;
+    PATTERN_UART_TIMER->CCR[0] = (uint16_t)(period - 1);
+    PATTERN_UART_TIMER->CCTL[0] = 0;
+
+    /* Bit edges must not wait behind bulk transfers */
+    dma_msp432_init();
+    MAP_DMA_assignChannel(PATTERN_UART_DMA_CH);
+    MAP_DMA_disableChannelAttribute(PATTERN_UART_DMA_CH, UDMA_ATTR_ALTSELECT |
+                                    UDMA_ATTR_USEBURST | UDMA_ATTR_REQMASK);
+    MAP_DMA_enableChannelAttribute(PATTERN_UART_DMA_CH,
+                                   UDMA_ATTR_HIGH_PRIORITY);
+    MAP_DMA_setChannelControl(PATTERN_UART_DMA_CH | UDMA_PRI_SELECT, control);
+    MAP_DMA_setChannelControl(PATTERN_UART_DMA_CH | UDMA_ALT_SELECT, control);
+
+    /* Channel 6 is not routed to DMA_INT1..3, its completion raises INT0 */
+    MAP_DMA_clearInterruptFlag(PATTERN_UART_DMA_CH & 0x0F);
+    MAP_Interrupt_enableInterrupt(PATTERN_UART_DMA_INT);
+
+    pattern_uart_msp432_service();
+    return true;
+}
+
+void pattern_uart_msp432_stop(void)
+{
+    MAP_Interrupt_disableInterrupt(PATTERN_UART_DMA_INT);
+    MAP_DMA_disableChannel(PATTERN_UART_DMA_CH & 0x0F);
+    MAP_DMA_clearInterruptFlag(PATTERN_UART_DMA_CH & 0x0F);
+
+    PATTERN_UART_TIMER->CTL = 0;
+    running = false;
+    armed = 0;
+    patternTx = 0;
+}
+
+uint16_t pattern_uart_msp432_write(uint_fast8_t line, const uint8_t *buf,
+                                   uint16_t len)
+{
+    uint16_t n;
+
+    if(!patternTx)
+        return 0;
+
+    n = pattern_uart_write(patternTx, line, buf, len);
+
+    MAP_Interrupt_disableInterrupt(PATTERN_UART_DMA_INT);
+    pattern_uart_msp432_service();
+    MAP_Interrupt_enableInterrupt(PATTERN_UART_DMA_INT);
+
+    return n;
+}
+
+/* DMA channel interrupt 0 - channels not routed to INT1..3 */
+void DMA_INT0_IRQHandler(void)
+{
+    if(!(MAP_DMA_getInterruptStatus() & (1u << (PATTERN_UART_DMA_CH & 0x0F))))
+        return;
+
+    MAP_DMA_clearInterruptFlag(PATTERN_UART_DMA_CH & 0x0F);
+    if(patternTx)
+        pattern_uart_msp432_service();
+}
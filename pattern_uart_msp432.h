@@ -0,0 +1,65 @@
+/******************************************************************************
+ * Software UART transmitter from port bit patterns - MSP432 binding
+ *
+ * Description: Streams the port values built by pattern_uart.c to the
+ * output register of one port with Timer_A3 in up mode as the bit clock.
+ * Every CCR0 period requests uDMA channel 6, which copies the next value
+ * to PxOUT, so no bit edge involves the CPU:
+ *
+ *     TA3.0 period    -> uDMA ch 6 -> PxOUT, one value per bit
+ *     DMA_INT0        <- a half of the pattern buffer is done: expand
+ *                        the next frames into it
+ *
+ * The buffer holds two halves of PATTERN_UART_FRAMES frames each,
+ * streamed ping-pong. A half is refilled from the DMA ISR while the other
+ * one goes out, so the expansion has a whole half, PATTERN_UART_FRAMES
+ * frames, to keep up. When every line has run dry the stream and the
+ * timer stop; pattern_uart_msp432_write() starts them again. Bytes queued
+ * after their half was expanded follow a little late, the lines then idle
+ * for some extra stop level, which a receiver accepts.
+ *
+ * A bit edge lands one DMA arbitration after the compare: up to a transfer
+ * of another channel, a few MCLK cycles, since every channel in the
+ * firmware moves one item per request. PATTERN_UART_MIN_BIT_TICKS keeps
+ * that well inside a bit.
+ *
+ * Timer_A3 is shared with uart_autobaud.c; only one of them may run.
+ *
+ *******************************************************************************/
+#ifndef PATTERN_UART_MSP432_H_
+#define PATTERN_UART_MSP432_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <ti/devices/msp432p4xx/inc/msp.h>
+
+#include "pattern_uart.h"
+
+#define PATTERN_UART_TIMER      TA3
+#define PATTERN_UART_DMA_INT    INT_DMA_INT0
+
+/* Frames per half of the pattern buffer */
+#ifndef PATTERN_UART_FRAMES
+#define PATTERN_UART_FRAMES     8
+#endif
+
+/* Shortest bit period, in SMCLK ticks */
+#define PATTERN_UART_MIN_BIT_TICKS  16
+
+/* Drives every line of tx on port (driverlib GPIO_PORT_P1..P10) high as an
+ * output, takes rest from the other bits of its PxOUT and sets the bit
+ * clock to baud from SMCLK. Lines must be added before. Returns false if
+ * the port or the rate is out of range. */
+extern bool pattern_uart_msp432_start(PatternUart *tx, uint_fast8_t port,
+                                      uint32_t baud);
+
+/* Stops the stream and the timer; queued bytes stay queued */
+extern void pattern_uart_msp432_stop(void);
+
+/* Queues up to len bytes on a line and starts the stream if it is idle.
+ * Returns the number queued. */
+extern uint16_t pattern_uart_msp432_write(uint_fast8_t line,
+                                          const uint8_t *buf, uint16_t len);
+
+#endif /* PATTERN_UART_MSP432_H_ */
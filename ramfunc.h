@@ -0,0 +1,44 @@
+/******************************************************************************
+ * Execution from SRAM
+ *
+ * Description: RAMFUNC marks a function to be run from SRAM_CODE instead
+ * of flash. With MCLK at 48 MHz every flash access takes a wait state; the
+ * prefetch buffer hides that for straight-line code, not for the branches
+ * and literal loads an ISR is made of. SRAM has no wait states.
+ *
+ * The TI compiler puts RAMFUNC functions in .TI.ramfunc, which
+ * msp432p401r.cmd loads into MAIN and the boot code copies to SRAM_CODE
+ * through the BINIT table. The hot paths carry it: the eUSCI, GPIO UART
+ * and bridge ISRs with the functions they call, and the ring_buffer.h
+ * operations, should the compiler not inline them.
+ *
+ * Opt-in: unless RAMFUNC_ENABLE is 1, RAMFUNC is empty and all code stays
+ * in flash. RAMFUNC_ENABLE also has main() move the vector table to the
+ * .vtable section at the start of SRAM (Interrupt_registerInterrupt()
+ * copies it there and points VTOR at it), so vectors are fetched without
+ * wait states and handlers can be swapped at run time with further
+ * Interrupt_registerInterrupt() calls.
+ *
+ * Measuring the effect: build with CYCLE_STATS_ENABLE=1, keep the loopback
+ * busy with a steady stream and send CYCLE_STATS_DUMP_CMD; the EUSCIA2,
+ * SWUART_* and MC_TICK lines give min/mean/max cycles per ISR. Rebuild
+ * with RAMFUNC_ENABLE=1 and repeat. The host build cannot model wait
+ * states, so RAMFUNC is empty there.
+ *
+ *******************************************************************************/
+#ifndef RAMFUNC_H_
+#define RAMFUNC_H_
+
+#ifndef RAMFUNC_ENABLE
+#define RAMFUNC_ENABLE      0
+#endif
+
+#if RAMFUNC_ENABLE && defined(__TI_COMPILER_VERSION__) && !defined(__clang__)
+#define RAMFUNC             __attribute__((ramfunc))
+#elif RAMFUNC_ENABLE && defined(__MSP432P401R__)
+#define RAMFUNC             __attribute__((section(".TI.ramfunc")))
+#else
+#define RAMFUNC
+#endif
+
+#endif /* RAMFUNC_H_ */
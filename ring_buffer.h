@@ -0,0 +1,187 @@
+/******************************************************************************
+ * Lock-free single-producer/single-consumer byte ring
+ *
+ * Description: One side (typically an ISR) only ever calls the put
+ * functions and writes head; the other side (typically the main loop) only
+ * ever calls the get functions and writes tail. No interrupt masking is
+ * needed as long as that split is respected.
+ *
+ * head and tail are free-running 16-bit counters, so head - tail is the fill
+ * level even after they wrap and a full ring needs no sacrificial slot. The
+ * size must be a power of two no larger than 32768.
+ *
+ * The data store is ordered before the index store (and the index load
+ * before the data load): with a DMB on the Cortex-M4, and on a host, where
+ * producer and consumer may be threads on different cores, by loading the
+ * other side's index with acquire and storing one's own with release.
+ * Those are C11 atomics, so ThreadSanitizer can check them (see
+ * ring_buffer_bench.c); plain accesses with fences would be races to it.
+ * RING_BARRIER() is the fence for index pairs kept outside a ring.
+ *
+ * The put and get operations are RAMFUNC (ramfunc.h): any copy the
+ * compiler does not inline into its ISR still runs from SRAM.
+ *
+ *******************************************************************************/
+#ifndef RING_BUFFER_H_
+#define RING_BUFFER_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "ramfunc.h"
+
+#ifdef __MSP432P401R__
+#include <ti/devices/msp432p4xx/inc/msp.h>
+#define RING_BARRIER()      __DMB()
+#define RING_ORDER()        __DMB()
+#define RING_LOAD(index)    (index)
+#define RING_STORE(index, value) ((index) = (value))
+#else
+#define RING_BARRIER()      __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#define RING_ORDER()
+#define RING_LOAD(index)    __atomic_load_n(&(index), __ATOMIC_ACQUIRE)
+#define RING_STORE(index, value)                                              \
+    __atomic_store_n(&(index), (value), __ATOMIC_RELEASE)
+#endif
+
+typedef struct
+{
+    volatile uint16_t head;         /* Written by the producer only */
+    volatile uint16_t tail;         /* Written by the consumer only */
+    uint16_t mask;                  /* size - 1                     */
+    uint8_t *buf;
+} RingBuffer;
+
+/* Defines a ring with static storage. size must be a power of two. */
+#define RING_BUFFER_DEFINE(name, size)                                        \
+    _Static_assert((size) > 0 && (size) <= 32768 &&                           \
+                   ((size) & ((size) - 1)) == 0,                              \
+                   #name ": size must be a power of two <= 32768");           \
+    static uint8_t name##_storage[size];                                      \
+    RingBuffer name = { 0, 0, (size) - 1, name##_storage }
+
+/* Sets up a ring over caller storage. Not safe while either side runs. */
+static inline void ring_init(RingBuffer *ring, uint8_t *storage, uint16_t size)
+{
+    ring->head = 0;
+    ring->tail = 0;
+    ring->mask = size - 1;
+    ring->buf = storage;
+}
+
+static inline uint16_t ring_count(const RingBuffer *ring)
+{
+    return (uint16_t)(RING_LOAD(ring->head) - RING_LOAD(ring->tail));
+}
+
+static inline uint16_t ring_space(const RingBuffer *ring)
+{
+    return (uint16_t)(ring->mask + 1 - ring_count(ring));
+}
+
+static inline bool ring_isEmpty(const RingBuffer *ring)
+{
+    return RING_LOAD(ring->head) == RING_LOAD(ring->tail);
+}
+
+/* Producer side. Returns false, dropping the byte, if the ring is full. */
+RAMFUNC static inline bool ring_put(RingBuffer *ring, uint8_t byte)
+{
+    uint16_t head = ring->head;
+
+    if((uint16_t)(head - RING_LOAD(ring->tail)) > ring->mask)
+        return false;
+
+    ring->buf[head & ring->mask] = byte;
+    RING_ORDER();
+    RING_STORE(ring->head, head + 1);
+    return true;
+}
+
+/* Consumer side. Returns false if the ring is empty. */
+RAMFUNC static inline bool ring_get(RingBuffer *ring, uint8_t *byte)
+{
+    uint16_t tail = ring->tail;
+
+    if(tail == RING_LOAD(ring->head))
+        return false;
+
+    RING_ORDER();
+    *byte = ring->buf[tail & ring->mask];
+    RING_ORDER();
+    RING_STORE(ring->tail, tail + 1);
+    return true;
+}
+
+/* Producer side bulk copy. Returns the number of bytes queued. */
+RAMFUNC static inline uint16_t ring_write(RingBuffer *ring,
+                                          const uint8_t *src, uint16_t len)
+{
+    uint16_t head = ring->head;
+    uint16_t space = (uint16_t)(ring->mask + 1 -
+                                (uint16_t)(head - RING_LOAD(ring->tail)));
+    uint16_t n;
+
+    if(len > space)
+        len = space;
+
+    for(n = 0; n < len; n++)
+        ring->buf[(uint16_t)(head + n) & ring->mask] = src[n];
+
+    RING_ORDER();
+    RING_STORE(ring->head, head + len);
+    return len;
+}
+
+/* Producer side in-place fill: stores byte offset positions past head
+ * without publishing it, for writers that patch earlier bytes (e.g. length
+ * fields) before the data may be consumed. The caller must stay within
+ * ring_space(). */
+RAMFUNC static inline void ring_poke(RingBuffer *ring, uint16_t offset,
+                                     uint8_t byte)
+{
+    ring->buf[(uint16_t)(ring->head + offset) & ring->mask] = byte;
+}
+
+/* Producer side: publishes len bytes stored with ring_poke() */
+RAMFUNC static inline void ring_commit(RingBuffer *ring, uint16_t len)
+{
+    RING_ORDER();
+    RING_STORE(ring->head, ring->head + len);
+}
+
+/* Consumer side bulk copy. Returns the number of bytes taken. */
+RAMFUNC static inline uint16_t ring_read(RingBuffer *ring, uint8_t *dst,
+                                         uint16_t len)
+{
+    uint16_t tail = ring->tail;
+    uint16_t count = (uint16_t)(RING_LOAD(ring->head) - tail);
+    uint16_t n;
+
+    if(len > count)
+        len = count;
+
+    RING_ORDER();
+    for(n = 0; n < len; n++)
+        dst[n] = ring->buf[(uint16_t)(tail + n) & ring->mask];
+
+    RING_ORDER();
+    RING_STORE(ring->tail, tail + len);
+    return len;
+}
+
+/* Consumer side: discards up to len bytes. Returns the number dropped. */
+RAMFUNC static inline uint16_t ring_skip(RingBuffer *ring, uint16_t len)
+{
+    uint16_t tail = ring->tail;
+    uint16_t count = (uint16_t)(RING_LOAD(ring->head) - tail);
+
+    if(len > count)
+        len = count;
+
+    RING_ORDER();
+    RING_STORE(ring->tail, tail + len);
+    return len;
+}
+
+#endif /* RING_BUFFER_H_ */
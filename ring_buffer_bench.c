@@ -0,0 +1,223 @@
+/******************************************************************************
+ * SPSC ring stress test - host
+ *
+ * Description: Runs ring_buffer.h with the producer and the consumer on
+ * two threads, as an ISR and the main loop would be on the target, and
+ * prints one CSV line per ring size:
+ *
+ *     size,bytes,index_wraps,ns_per_byte,errors
+ *
+ * The producer queues a pseudo-random byte sequence through ring_put(),
+ * ring_write() and ring_poke()/ring_commit() in random lengths; the
+ * consumer takes it through ring_get(), ring_read() and ring_skip() and
+ * checks every byte against the same sequence, skipped ones included, so
+ * a byte lost, repeated or out of order shows up as an error. Small rings
+ * keep both sides meeting at the full and empty edges, and BENCH_BYTES
+ * takes the 16-bit indices through index_wraps wraps. errors must be 0.
+ *
+ * Built with -fsanitize=thread, ThreadSanitizer checks that the index
+ * accesses and the barriers publish the data as the header claims: it
+ * must report nothing. ns_per_byte is a host figure and means little
+ * under the sanitizer.
+ *
+ * Host only: the target build sees an empty file. Build and run with:
+ *
+ *     cc -std=gnu11 -O2 -g -I. -fsanitize=thread -pthread \
+ *        ring_buffer_bench.c -o ring_buffer_bench
+ *     ./ring_buffer_bench
+ *
+ *******************************************************************************/
+#ifndef __MSP432P401R__
+
+#include <stdio.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+
+#include "ring_buffer.h"
+
+#define BENCH_BYTES         (2u << 20)
+
+/* Longest bulk call, longer than the smaller rings */
+#define BENCH_CHUNK         48
+
+static const uint16_t sizes[] = { 1, 2, 16, 64, 1024 };
+
+static RingBuffer ring;
+static uint8_t storage[1024];
+
+typedef struct
+{
+    uint32_t seq;                   /* Byte sequence state               */
+    uint32_t rng;                   /* Call pattern state                */
+    uint32_t errors;
+} RingBench_Side;
+
+static uint32_t bench_random(uint32_t *state)
+{
+    uint32_t x = *state;
+
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+static uint8_t bench_next(RingBench_Side *s)
+{
+    return (uint8_t)bench_random(&s->seq);
+}
+
+static void *bench_producer(void *arg)
+{
+    RingBench_Side *s = arg;
+    uint8_t chunk[BENCH_CHUNK];
+    uint32_t sent = 0;
+
+    while(sent < BENCH_BYTES)
+    {
+        uint32_t pick = bench_random(&s->rng);
+        uint16_t len = (uint16_t)(1 + (pick >> 8) % BENCH_CHUNK);
+        uint16_t n;
+
+        if(len > BENCH_BYTES - sent)
+            len = (uint16_t)(BENCH_BYTES - sent);
+
+        switch(pick % 3)
+        {
+        case 0:
+            /* A byte at a time, waiting on a full ring */
+            for(n = 0; n < len; n++)
+            {
+                uint8_t byte = bench_next(s);
+
+                while(!ring_put(&ring, byte))
+                    sched_yield();
+            }
+            sent += len;
+            break;
+
+        case 1:
+            /* Bulk, the remainder put back for the next call */
+            for(n = 0; n < len; n++)
+                chunk[n] = bench_next(s);
+            n = 0;
+            while(n < len)
+            {
+                n += ring_write(&ring, &chunk[n], (uint16_t)(len - n));
+                if(n < len)
+                    sched_yield();
+            }
+            sent += len;
+            break;
+
+        default:
+            /* In place, as much as fits, published at once */
+            n = ring_space(&ring);
+            if(len > n)
+                len = n;
+            for(n = 0; n < len; n++)
+                ring_poke(&ring, n, bench_next(s));
+            ring_commit(&ring, len);
+            if(!len)
+                sched_yield();
+            sent += len;
+            break;
+        }
+    }
+
+    return NULL;
+}
+
+static void *bench_consumer(void *arg)
+{
+    RingBench_Side *s = arg;
+    uint8_t chunk[BENCH_CHUNK];
+    uint32_t taken = 0;
+
+    while(taken < BENCH_BYTES)
+    {
+        uint32_t pick = bench_random(&s->rng);
+        uint16_t len = (uint16_t)(1 + (pick >> 8) % BENCH_CHUNK);
+        uint16_t got;
+        uint16_t n;
+        uint8_t byte;
+
+        if(ring_isEmpty(&ring))
+        {
+            sched_yield();
+            continue;
+        }
+
+        switch(pick % 4)
+        {
+        case 0:
+            if(ring_get(&ring, &byte))
+            {
+                if(byte != bench_next(s))
+                    s->errors++;
+                taken++;
+            }
+            break;
+
+        case 1:
+            /* Skipped bytes still advance the sequence */
+            got = ring_skip(&ring, len);
+            for(n = 0; n < got; n++)
+                bench_next(s);
+            taken += got;
+            break;
+
+        default:
+            got = ring_read(&ring, chunk, len);
+            for(n = 0; n < got; n++)
+                if(chunk[n] != bench_next(s))
+                    s->errors++;
+            taken += got;
+            break;
+        }
+    }
+
+    /* Anything left is a byte the producer never sent */
+    if(!ring_isEmpty(&ring))
+        s->errors++;
+
+    return NULL;
+}
+
+static void bench_run(uint16_t size)
+{
+    RingBench_Side producer = { 0x2545F491, 0x9E3779B9, 0 };
+    RingBench_Side consumer = { 0x2545F491, 0x85EBCA6B, 0 };
+    struct timespec t0;
+    struct timespec t1;
+    pthread_t threads[2];
+    double ns;
+
+    ring_init(&ring, storage, size);
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    pthread_create(&threads[0], NULL, bench_consumer, &consumer);
+    pthread_create(&threads[1], NULL, bench_producer, &producer);
+    pthread_join(threads[1], NULL);
+    pthread_join(threads[0], NULL);
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+
+    ns = (double)(t1.tv_sec - t0.tv_sec) * 1e9 + (double)(t1.tv_nsec - t0.tv_nsec);
+    printf("%u,%u,%u,%.1f,%u\n", size, BENCH_BYTES, BENCH_BYTES >> 16,
+           ns / BENCH_BYTES, consumer.errors);
+}
+
+int main(void)
+{
+    uint_fast8_t n;
+
+    printf("size,bytes,index_wraps,ns_per_byte,errors\n");
+    for(n = 0; n < sizeof(sizes) / sizeof(sizes[0]); n++)
+        bench_run(sizes[n]);
+
+    return 0;
+}
+
+#endif /* __MSP432P401R__ */
@@ -45,6 +45,8 @@
 #include <stdint.h>
 #include <ti/devices/msp432p4xx/inc/msp.h>
 
+#include "cycle_stats.h"
+
 /*--------------------- Configuration Instructions ----------------------------
    1. If you prefer to halt the Watchdog Timer, set __HALT_WDT to 1:
    #define __HALT_WDT       1
@@ -68,7 +70,9 @@
 //     <12000000> 12 MHz
 //     <24000000> 24 MHz
 //     <48000000> 48 MHz
-#define  __SYSTEM_CLOCK    3000000
+// CLOCK_PROFILE_BOOT of clock_profile.h: MCLK 48 MHz, SMCLK 24 MHz, VCORE1,
+// set up once here so main() never runs on the 3 MHz reset clock
+#define  __SYSTEM_CLOCK    48000000
 
 /*--------------------- Power Regulator Configuration -----------------------*/
 //  Power Regulator Mode
@@ -261,6 +265,10 @@ void SystemCoreClockUpdate(void)
  */
 void SystemInit(void)
 {
+    #if CYCLE_STATS_ENABLE
+    cycle_stats_start();                                   // Boot time counts from here
+    #endif
+
     // Enable FPU if used
     #if (__FPU_USED == 1)                                  // __FPU_USED is defined in core_cm4.h
     SCB->CPACR |= ((3UL << 10 * 2) |                       // Set CP10 Full Access
@@ -384,8 +392,10 @@ void SystemInit(void)
     FLCTL->BANK0_RDCTL = (FLCTL->BANK0_RDCTL & ~FLCTL_BANK0_RDCTL_WAIT_MASK) | FLCTL_BANK0_RDCTL_WAIT_1;
     FLCTL->BANK1_RDCTL = (FLCTL->BANK1_RDCTL & ~FLCTL_BANK1_RDCTL_WAIT_MASK) | FLCTL_BANK1_RDCTL_WAIT_1;
 
-    // DCO = 48 MHz; MCLK = source
+    // DCO = 48 MHz; MCLK = source; SMCLK = source / 2 (SMCLK max is 24 MHz)
     CS->KEY = CS_KEY_VAL;                                  // Unlock CS module for register access
+    CS->CTL1 = (CS->CTL1 & ~CS_CTL1_DIVS_MASK) | CS_CTL1_DIVS__2;
+                                                           // Halve SMCLK before the DCO speeds up
     CS->CTL0 = CS_CTL0_DCORSEL_5;                          // Set DCO to 48MHz
     CS->CTL1 = (CS->CTL1 & ~(CS_CTL1_SELM_MASK | CS_CTL1_DIVM_MASK)) | CS_CTL1_SELM__DCOCLK;
 	                                                       // Select MCLK as DCO source
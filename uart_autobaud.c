@@ -0,0 +1,159 @@
+/******************************************************************************
+ * Automatic baud-rate detection for the eUSCI_A2 UART
+ *
+ * Both edges are needed but a port pin only interrupts on one, so the edge
+ * select is flipped in the ISR after every edge. The flag is cleared after
+ * the flip, which would otherwise raise a spurious one.
+ *
+ *******************************************************************************/
+/* DriverLib Includes */
+#include <ti/devices/msp432p4xx/driverlib/driverlib.h>
+
+#include "uart_autobaud.h"
+#include "autobaud.h"
+#include "cycle_stats.h"
+
+#define AUTOBAUD_PORT       GPIO_PORT_P3
+#define AUTOBAUD_PIN        GPIO_PIN2
+#define AUTOBAUD_PORT_REGS  P3
+
+#define AUTOBAUD_CCTL       UART_AUTOBAUD_TIMER->CCTL[UART_AUTOBAUD_TIMEOUT_CCR]
+#define AUTOBAUD_CCR        UART_AUTOBAUD_TIMER->CCR[UART_AUTOBAUD_TIMEOUT_CCR]
+
+static AutoBaud autoBaud;
+static uint32_t autoBaudTimerHz;
+static volatile bool autoBaudBusy = false;
+static Uart_Callback autoBaudDone = 0;
+static uint32_t autoBaudRate = 0;
+static int32_t autoBaudErrorPpm = 0;
+
+/* Waits for the falling edge of a start bit with an empty edge history */
+static void uart_autobaud_rearm(void)
+{
+    autobaud_reset(&autoBaud);
+    AUTOBAUD_CCTL = 0;
+    AUTOBAUD_PORT_REGS->IES |= AUTOBAUD_PIN;
+    AUTOBAUD_PORT_REGS->IFG &= ~AUTOBAUD_PIN;
+    AUTOBAUD_PORT_REGS->IE |= AUTOBAUD_PIN;
+}
+
+/* Hands the pin back to the eUSCI and stops the measurement hardware */
+static void uart_autobaud_stop(void)
+{
+    AUTOBAUD_PORT_REGS->IE &= ~AUTOBAUD_PIN;
+    AUTOBAUD_PORT_REGS->IFG &= ~AUTOBAUD_PIN;
+    AUTOBAUD_CCTL = 0;
+    UART_AUTOBAUD_TIMER->CTL = 0;
+
+    MAP_GPIO_setAsPeripheralModuleFunctionInputPin(AUTOBAUD_PORT, AUTOBAUD_PIN,
+            GPIO_PRIMARY_MODULE_FUNCTION);
+    autoBaudBusy = false;
+}
+
+/* Applies a measured bit time, or starts over if it is unusable */
+static void uart_autobaud_lock(uint32_t bitTicks)
+{
+    uint32_t baud = autobaud_toBaud(autoBaudTimerHz, bitTicks);
+    UartBaud_Divisors div;
+
+    if(!uart_baud_compute(autoBaudTimerHz, baud, &div))
+    {
+        uart_autobaud_rearm();
+        return;
+    }
+
+    uart_autobaud_stop();
+    uart_setBaudRate(&uartA2, baud, &autoBaudErrorPpm);
+    autoBaudRate = baud;
+
+    if(autoBaudDone)
+        autoBaudDone();
+    MAP_Interrupt_disableSleepOnIsrExit();
+}
+
+void uart_autobaud_start(Uart_Callback done)
+{
+    autoBaudDone = done;
+    autoBaudTimerHz = MAP_CS_getSMCLK();
+
+    MAP_UART_disableModule(EUSCI_A2_BASE);
+    MAP_GPIO_setAsInputPin(AUTOBAUD_PORT, AUTOBAUD_PIN);
+
+    /* Timer_A3 free running from SMCLK: the same clock as BRCLK, so the
+     * measured ticks translate straight into divisors */
+    UART_AUTOBAUD_TIMER->CTL = TIMER_A_CTL_SSEL__SMCLK | TIMER_A_CTL_CLR;
+    UART_AUTOBAUD_TIMER->CTL |= TIMER_A_CTL_MC__CONTINUOUS;
+
+    autoBaudBusy = true;
+    uart_autobaud_rearm();
+
+    MAP_Interrupt_enableInterrupt(UART_AUTOBAUD_TIMER_INT);
+    MAP_Interrupt_enableInterrupt(UART_AUTOBAUD_EDGE_INT);
+}
+
+void uart_autobaud_cancel(void)
+{
+    if(!autoBaudBusy)
+        return;
+
+    MAP_Interrupt_disableInterrupt(UART_AUTOBAUD_EDGE_INT);
+    MAP_Interrupt_disableInterrupt(UART_AUTOBAUD_TIMER_INT);
+    uart_autobaud_stop();
+    MAP_UART_enableModule(EUSCI_A2_BASE);
+    MAP_UART_enableInterrupt(EUSCI_A2_BASE, EUSCI_A_UART_RECEIVE_INTERRUPT);
+}
+
+bool uart_autobaud_busy(void)
+{
+    return autoBaudBusy;
+}
+
+uint32_t uart_autobaud_baud(int32_t *errorPpm)
+{
+    if(errorPpm)
+        *errorPpm = autoBaudErrorPpm;
+    return autoBaudRate;
+}
+
+void PORT3_IRQHandler(void)
+{
+    uint16_t now = UART_AUTOBAUD_TIMER->R;
+    CYCLE_STATS_ISR_ENTER(AUTOBAUD_EDGE);
+    uint32_t bitTicks;
+
+    if(AUTOBAUD_PORT_REGS->IFG & AUTOBAUD_PIN)
+    {
+        AUTOBAUD_PORT_REGS->IES ^= AUTOBAUD_PIN;
+        AUTOBAUD_PORT_REGS->IFG &= ~AUTOBAUD_PIN;
+
+        /* Idle timeout: a full timer wrap without another edge */
+        AUTOBAUD_CCR = now;
+        AUTOBAUD_CCTL = TIMER_A_CCTLN_CCIE;
+
+        bitTicks = autobaud_edge(&autoBaud, now);
+        if(bitTicks)
+            uart_autobaud_lock(bitTicks);
+        else if(autobaud_full(&autoBaud))
+            uart_autobaud_lock(autobaud_estimate(&autoBaud));
+    }
+
+    CYCLE_STATS_ISR_EXIT(AUTOBAUD_EDGE);
+}
+
+void TA3_N_IRQHandler(void)
+{
+    CYCLE_STATS_ISR_ENTER(AUTOBAUD_TIMEOUT);
+
+    if(AUTOBAUD_CCTL & TIMER_A_CCTLN_CCIFG)
+    {
+        AUTOBAUD_CCTL &= ~TIMER_A_CCTLN_CCIFG;
+
+        /* Line went idle: a single edge carries no timing, more may */
+        if(autoBaud.edges > 2)
+            uart_autobaud_lock(autobaud_estimate(&autoBaud));
+        else
+            uart_autobaud_rearm();
+    }
+
+    CYCLE_STATS_ISR_EXIT(AUTOBAUD_TIMEOUT);
+}
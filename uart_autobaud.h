@@ -0,0 +1,58 @@
+/******************************************************************************
+ * Automatic baud-rate detection for the eUSCI_A2 UART
+ *
+ * Description: Measures the bit time of incoming traffic on P3.2 (UCA2RXD)
+ * and reprograms EUSCI_A2 through uart_setBaudRate() once it has locked.
+ *
+ * P3.2 has no Timer_A capture input, so while detection runs the pin is
+ * switched to GPIO and every edge raises a PORT3 interrupt that timestamps
+ * itself from Timer_A3 running free from SMCLK. The interrupt latency is
+ * the same for every edge and drops out of the differences the estimator
+ * works on (see autobaud.h). PORT3 must therefore sit at the bit-timing
+ * priority, alongside the software UART vectors (irq_priority.h).
+ *
+ *     PORT3 edge      -> timestamp, feed autobaud_edge()
+ *     TA3.1 compare   -> idle timeout, one timer wrap after the last edge
+ *
+ * A 0x55 sync byte locks at its last edge; other traffic locks after
+ * AUTOBAUD_MAX_EDGES edges or on the idle timeout. The eUSCI is held in
+ * reset while measuring, so the characters used for detection are not
+ * delivered to the RX ring.
+ *
+ * With SMCLK at 24 MHz the measurable range is roughly 3600 baud (a nine
+ * bit run must fit one timer wrap) up to 1 Mbaud; a sync byte extends the
+ * low end to about 400 baud.
+ *
+ * Timer_A3 is shared with pattern_uart_msp432.c; only one of them may run.
+ *
+ *******************************************************************************/
+#ifndef UART_AUTOBAUD_H_
+#define UART_AUTOBAUD_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <ti/devices/msp432p4xx/inc/msp.h>
+
+#include "uart_driver.h"
+
+#define UART_AUTOBAUD_TIMER         TA3
+#define UART_AUTOBAUD_TIMER_INT     INT_TA3_N
+#define UART_AUTOBAUD_TIMEOUT_CCR   1
+#define UART_AUTOBAUD_EDGE_INT      INT_PORT3
+
+/* Stops the eUSCI and starts listening on P3.2. The callback runs in
+ * interrupt context once the new rate is in effect; NULL for none. Must be
+ * called after uart_init(). */
+extern void uart_autobaud_start(Uart_Callback done);
+
+/* Abandons a running detection and restarts the eUSCI at its old rate */
+extern void uart_autobaud_cancel(void);
+
+/* True while detection is running */
+extern bool uart_autobaud_busy(void);
+
+/* Rate and worst-case bit error of the last lock, 0 before the first one */
+extern uint32_t uart_autobaud_baud(int32_t *errorPpm);
+
+#endif /* UART_AUTOBAUD_H_ */
@@ -0,0 +1,179 @@
+/******************************************************************************
+ * RX batching wake count - host simulation
+ *
+ * Description: Feeds uartA2 scripted bursts through hal_host_uartFeed(),
+ * loopback off, and runs a main loop that reads everything waiting and
+ * sleeps on exit until uart_rxBatchReady(), as the loopback demo does.
+ * One CSV line per rate, wake level and idle timeout:
+ *
+ *     baud,wake_level,idle_bits,bursts,bytes,main_passes,interrupts,
+ *     latency_max_us,bound_us,errors
+ *
+ * The traffic is BENCH_BURSTS bursts of 1 to BENCH_BURST_MAX back-to-back
+ * bytes, 1 to 5 ms apart, the same for every case. main_passes counts the
+ * main loop's trips round, each one a wake from the ISR or the idle
+ * timeout but the first, interrupts every eUSCI_A2 interrupt. latency_max
+ * is the longest time from the last byte of a burst landing in RXBUF to
+ * the main loop having read it; bound is the idle timeout plus a byte
+ * time, or a byte time at wake level 1. errors counts bytes read out of
+ * sequence and bursts later than bound, and must be 0. An idle timeout of
+ * 10 bit times or less runs out between back-to-back 8N1 bytes, so it
+ * wakes the main loop for every byte as wake level 1 does.
+ *
+ * Host only: the target build sees an empty file. Build and run with:
+ *
+ *     cc -std=gnu11 -O2 -I. uart_batch_bench.c uart_driver.c uart_baud.c \
+ *        cycle_stats.c hal_host.c -o uart_batch_bench
+ *     ./uart_batch_bench
+ *
+ *******************************************************************************/
+#ifndef __MSP432P401R__
+
+#include <stdio.h>
+
+#include "uart_driver.h"
+#include "hal.h"
+
+#define BENCH_CLOCK_HZ      24000000
+#define BENCH_BURSTS        300
+#define BENCH_BURST_MAX     120
+
+typedef struct
+{
+    uint32_t baud;
+    uint16_t wakeLevel;
+    uint16_t idleBits;
+} UartBatchBench_Case;
+
+static const UartBatchBench_Case cases[] =
+{
+    { 115200, 1, 0 },               /* A wake per byte                   */
+    { 115200, 16, 30 },
+    { 115200, 64, 30 },
+    { 115200, 128, 30 },
+    { 115200, 64, 10 },             /* A frame: fires between bytes      */
+    { 115200, 64, 11 },
+    { 115200, 64, 100 },
+    { 921600, 1, 0 },
+    { 921600, 64, 30 },
+};
+
+static uint32_t rng;
+
+static uint32_t bench_random(void)
+{
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return rng;
+}
+
+/* The script: bytes sent so far, and where and when each burst ended */
+static uint32_t bursts;
+static uint32_t left;
+static uint32_t sent;
+static uint32_t burstEnd[BENCH_BURSTS];
+static uint64_t burstAt[BENCH_BURSTS];
+
+static bool bench_feed(uint8_t *byte, uint32_t *gap)
+{
+    /* Called as the last byte lands in RXBUF */
+    if(sent)
+        burstAt[bursts - 1] = hal_host_now();
+
+    if(left == 0)
+    {
+        if(bursts == BENCH_BURSTS)
+            return false;
+
+        left = 1 + bench_random() % BENCH_BURST_MAX;
+        *gap = BENCH_CLOCK_HZ / 1000 * (1 + bench_random() % 5);
+        burstEnd[bursts++] = sent + left;
+    }
+    else
+    {
+        *gap = 0;
+    }
+
+    *byte = (uint8_t)sent++;
+    left--;
+    return true;
+}
+
+static void bench_run(const UartBatchBench_Case *c)
+{
+    const Hal_UartConfig cfg = UART_CONFIG_8N1(BENCH_CLOCK_HZ, c->baud);
+    uint32_t byteTicks = BENCH_CLOCK_HZ / c->baud * 10;
+    uint64_t bound = byteTicks + (uint64_t)c->idleBits * byteTicks / 10;
+    uint32_t interrupts = halHostUartStats[HAL_UART_A2].interrupts;
+    uint64_t latency = 0;
+    uint32_t passes = 0;
+    uint32_t received = 0;
+    uint32_t done = 0;
+    uint32_t errors = 0;
+
+    rng = 0x2545F491;
+    bursts = left = sent = 0;
+
+    uart_init(&uartA2, &cfg);
+    if(!uart_setRxBatch(&uartA2, c->wakeLevel, c->idleBits))
+    {
+        printf("%u,%u,%u,rejected\n", c->baud, c->wakeLevel, c->idleBits);
+        return;
+    }
+    hal_host_uartFeed(HAL_UART_A2, bench_feed);
+
+    while(done < BENCH_BURSTS)
+    {
+        uint8_t buf[256];
+        uint16_t got = uart_read(&uartA2, buf, sizeof(buf));
+        uint16_t n;
+
+        passes++;
+        for(n = 0; n < got; n++)
+            if(buf[n] != (uint8_t)received++)
+                errors++;
+
+        while(done < bursts && received >= burstEnd[done])
+        {
+            uint64_t late = hal_host_now() - burstAt[done++];
+
+            if(late > latency)
+                latency = late;
+            if(late > bound)
+                errors++;
+        }
+        if(done == BENCH_BURSTS)
+            break;
+
+        hal_irq_disable();
+        if(!uart_rxBatchReady(&uartA2))
+        {
+            hal_sleepOnExit(true);
+            hal_sleep();
+        }
+        hal_irq_enable();
+    }
+
+    printf("%u,%u,%u,%u,%u,%u,%u,%u,%u,%u\n", c->baud, c->wakeLevel,
+           c->idleBits, BENCH_BURSTS, received, passes,
+           halHostUartStats[HAL_UART_A2].interrupts - interrupts,
+           (uint32_t)(latency * 1000000 / BENCH_CLOCK_HZ),
+           (uint32_t)(bound * 1000000 / BENCH_CLOCK_HZ), errors);
+}
+
+int main(void)
+{
+    uint_fast8_t n;
+
+    hal_host_uartLoopback(HAL_UART_A2, false);
+
+    printf("baud,wake_level,idle_bits,bursts,bytes,main_passes,interrupts,"
+           "latency_max_us,bound_us,errors\n");
+    for(n = 0; n < sizeof(cases) / sizeof(cases[0]); n++)
+        bench_run(&cases[n]);
+
+    return 0;
+}
+
+#endif /* __MSP432P401R__ */
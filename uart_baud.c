@@ -0,0 +1,86 @@
+/******************************************************************************
+ * eUSCI_A UART baud-rate divisor calculator
+ *
+ * See uart_baud.h. Integer arithmetic only, so it is cheap enough to run
+ * whenever the clock or the baud rate changes.
+ *
+ * Error model (TRM "Transmit Bit Timing - Error calculation"): bit i of the
+ * frame lasts 16*UCBRx + UCBRFx + m(i) BRCLK cycles with oversampling, or
+ * UCBRx + m(i) without, where m(i) is bit (i mod 8) of UCBRSx. The error of
+ * edge i is the distance between where it lands and where it should land.
+ *
+ *******************************************************************************/
+#include "uart_baud.h"
+
+/* Start + 8 data + stop */
+#define UART_BAUD_FRAME_BITS    10
+
+#define UART_BAUD_BRS_ENTRY_(f, threshold, brs)  { threshold, brs },
+
+static const struct
+{
+    uint16_t threshold;
+    uint8_t  brs;
+} brsTable[] =
+{
+    UART_BAUD_BRS_TABLE(UART_BAUD_BRS_ENTRY_, 0)
+};
+
+static uint8_t uart_baud_lookupBrs(uint32_t clkHz, uint32_t baud)
+{
+    uint32_t frac = UART_BAUD_FRAC(clkHz, baud);
+    uint_fast8_t n;
+
+    for(n = 0; n < sizeof(brsTable) / sizeof(brsTable[0]); n++)
+    {
+        if(frac >= brsTable[n].threshold)
+            return brsTable[n].brs;
+    }
+
+    return 0x00;
+}
+
+int32_t uart_baud_error(uint32_t clkHz, uint32_t baud,
+                        const UartBaud_Divisors *div)
+{
+    uint32_t base = div->overSampling ? 16u * div->brdiv + div->brf
+                                      : div->brdiv;
+    uint64_t cycles = 0;
+    int64_t worst = 0;
+    uint_fast8_t i;
+
+    for(i = 0; i < UART_BAUD_FRAME_BITS; i++)
+    {
+        int64_t err;
+
+        cycles += base + ((div->brs >> (i & 7)) & 1);
+
+        /* (actual - ideal) / bit = (cycles*baud - (i+1)*clk) / clk */
+        err = ((int64_t)(cycles * baud) - (int64_t)(i + 1) * clkHz) *
+              1000000 / clkHz;
+        if((err < 0 ? -err : err) > (worst < 0 ? -worst : worst))
+            worst = err;
+    }
+
+    return (int32_t)worst;
+}
+
+bool uart_baud_compute(uint32_t clkHz, uint32_t baud, UartBaud_Divisors *out)
+{
+    uint32_t n;
+
+    if(baud == 0)
+        return false;
+
+    n = clkHz / baud;
+    if(n == 0 || n / 16 > 0xFFFF)
+        return false;
+
+    out->overSampling = n >= 16;
+    out->brdiv = (uint16_t)(out->overSampling ? n / 16 : n);
+    out->brf = (uint8_t)(out->overSampling ? n % 16 : 0);
+    out->brs = uart_baud_lookupBrs(clkHz, baud);
+    out->errorPpm = uart_baud_error(clkHz, baud, out);
+
+    return true;
+}
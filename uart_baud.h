@@ -0,0 +1,73 @@
+/******************************************************************************
+ * eUSCI_A UART baud-rate divisor calculator
+ *
+ * Description: Computes UCBRx/UCBRFx/UCBRSx and the oversampling mode for
+ * a given BRCLK and baud rate, following the eUSCI_A "Setting a Baud Rate"
+ * procedure of the MSP432P4xx technical reference manual:
+ *
+ *     N = fBRCLK / baud
+ *     N >= 16:  UCOS16 = 1, UCBRx = INT(N/16), UCBRFx = INT(N) mod 16
+ *     N <  16:  UCOS16 = 0, UCBRx = INT(N)
+ *     UCBRSx  = table entry for the fractional part of N
+ *
+ * uart_baud_compute() does this at run time and also reports the worst
+ * TX bit-edge error of an 8N1 frame. UART_BAUD_BRDIV() & co. do the same
+ * in constant expressions for configurations fixed at build time. Both are
+ * driven by the one UART_BAUD_BRS_TABLE below.
+ *
+ *******************************************************************************/
+#ifndef UART_BAUD_H_
+#define UART_BAUD_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* UCBRSx settings for the fractional part of N (TRM table "UCBRSx Settings
+ * for Fractional Portion of N"), threshold in 1/10000, highest first. */
+#define UART_BAUD_BRS_TABLE(X, f)                                             \
+    X(f, 9288, 0xFE) X(f, 9170, 0xFD) X(f, 9004, 0xFB) X(f, 8751, 0xF7)      \
+    X(f, 8572, 0xEF) X(f, 8464, 0xDF) X(f, 8333, 0xBF) X(f, 8004, 0xEE)      \
+    X(f, 7861, 0xED) X(f, 7503, 0xDD) X(f, 7147, 0xBB) X(f, 7001, 0xB7)      \
+    X(f, 6667, 0xD6) X(f, 6432, 0xB6) X(f, 6254, 0xB5) X(f, 6003, 0xAD)      \
+    X(f, 5715, 0x6B) X(f, 5002, 0xAA) X(f, 4378, 0x55) X(f, 4286, 0x53)      \
+    X(f, 4003, 0x92) X(f, 3753, 0x52) X(f, 3575, 0x4A) X(f, 3335, 0x49)      \
+    X(f, 3000, 0x25) X(f, 2503, 0x44) X(f, 2224, 0x22) X(f, 2147, 0x21)      \
+    X(f, 1670, 0x11) X(f, 1430, 0x20) X(f, 1252, 0x10) X(f, 1001, 0x08)      \
+    X(f,  835, 0x04) X(f,  715, 0x02) X(f,  529, 0x01)
+
+#define UART_BAUD_BRS_SELECT_(f, threshold, brs)  ((f) >= (threshold)) ? (brs) :
+
+/* Constant-expression divisors. Arguments are evaluated several times. */
+#define UART_BAUD_N(clk, baud)          ((uint32_t)(clk) / (uint32_t)(baud))
+#define UART_BAUD_OS16(clk, baud)       (UART_BAUD_N(clk, baud) >= 16)
+#define UART_BAUD_BRDIV(clk, baud)      (UART_BAUD_OS16(clk, baud) ?          \
+                                         UART_BAUD_N(clk, baud) / 16 :        \
+                                         UART_BAUD_N(clk, baud))
+#define UART_BAUD_BRF(clk, baud)        (UART_BAUD_OS16(clk, baud) ?          \
+                                         UART_BAUD_N(clk, baud) % 16 : 0)
+#define UART_BAUD_FRAC(clk, baud)       ((uint32_t)(((uint64_t)(clk) %        \
+                                         (baud)) * 10000 / (baud)))
+#define UART_BAUD_BRS(clk, baud)                                              \
+    (UART_BAUD_BRS_TABLE(UART_BAUD_BRS_SELECT_, UART_BAUD_FRAC(clk, baud)) 0x00)
+
+typedef struct
+{
+    uint16_t brdiv;                 /* UCBRx                               */
+    uint8_t  brf;                   /* UCBRFx, 0 unless overSampling       */
+    uint8_t  brs;                   /* UCBRSx                              */
+    bool     overSampling;          /* UCOS16                              */
+    int32_t  errorPpm;              /* Worst TX bit-edge error over an 8N1
+                                     * frame, in millionths of a bit       */
+} UartBaud_Divisors;
+
+/* Fills out for clkHz/baud. Returns false if the rate is unreachable
+ * (UCBRx would be 0 or overflow). */
+extern bool uart_baud_compute(uint32_t clkHz, uint32_t baud,
+                              UartBaud_Divisors *out);
+
+/* Worst TX bit-edge error of an 8N1 frame for the given divisors, in
+ * millionths of a bit */
+extern int32_t uart_baud_error(uint32_t clkHz, uint32_t baud,
+                               const UartBaud_Divisors *div);
+
+#endif /* UART_BAUD_H_ */
@@ -0,0 +1,144 @@
+/******************************************************************************
+ * eUSCI_A baud divisor sweep - host
+ *
+ * Description: Runs uart_baud_compute() over the standard rates from 9600
+ * to 3 Mbaud at BRCLK = 3, 12, 24 and 48 MHz and prints one CSV line per
+ * pair:
+ *
+ *     clock_hz,baud,os16,brdiv,brf,brs,error_ppm,errors
+ *
+ * error_ppm is the worst TX bit-edge error of an 8N1 frame that
+ * uart_baud_error() reports. errors counts the checks the pair fails, and
+ * must be 0:
+ *
+ *     - the divisors give N back: 16*UCBRx + UCBRFx or UCBRx
+ *     - error_ppm within 1 ppm of a floating-point model of the frame
+ *     - UART_BAUD_BRDIV() & co. agree with uart_baud_compute()
+ *     - the settings the TRM table "Recommended Settings for Typical
+ *       Crystals and Baud Rates" lists for the pair, where it lists one
+ *
+ * A rate BRCLK cannot reach prints "rejected". The TRM gives the bit
+ * error a receiver can take; this sweep only reports the TX side.
+ *
+ * Host only: the target build sees an empty file. Build and run with:
+ *
+ *     cc -std=gnu11 -O2 -I. uart_baud_bench.c uart_baud.c -lm \
+ *        -o uart_baud_bench
+ *     ./uart_baud_bench
+ *
+ *******************************************************************************/
+#ifndef __MSP432P401R__
+
+#include <stdio.h>
+#include <math.h>
+
+#include "uart_baud.h"
+
+typedef struct
+{
+    uint32_t clockHz;
+    uint32_t baud;
+    uint16_t brdiv;
+    uint8_t  brf;
+    uint8_t  brs;
+} UartBaudBench_Known;
+
+static const uint32_t clocks[] = { 3000000, 12000000, 24000000, 48000000 };
+
+static const uint32_t rates[] = { 9600, 19200, 38400, 57600, 115200, 230400,
+                                  460800, 921600, 1000000, 1500000, 2000000,
+                                  3000000 };
+
+/* From the TRM table, UCOS16 = 1 in all of them */
+static const UartBaudBench_Known known[] =
+{
+    { 12000000, 9600, 78, 2, 0x00 },
+    { 12000000, 115200, 6, 8, 0x20 },
+    { 24000000, 115200, 13, 0, 0x25 },
+};
+
+/* Worst edge error of an 8N1 frame, in millionths of a bit, in double */
+static double bench_errorModel(uint32_t clkHz, uint32_t baud,
+                               const UartBaud_Divisors *div)
+{
+    double base = div->overSampling ? 16.0 * div->brdiv + div->brf
+                                    : div->brdiv;
+    double t = 0.0;
+    double worst = 0.0;
+    uint_fast8_t i;
+
+    for(i = 0; i < 10; i++)
+    {
+        double err;
+
+        t += (base + ((div->brs >> (i & 7)) & 1)) / clkHz;
+        err = (t - (i + 1) / (double)baud) * baud * 1e6;
+        if(fabs(err) > fabs(worst))
+            worst = err;
+    }
+
+    return worst;
+}
+
+static uint32_t bench_check(uint32_t clkHz, uint32_t baud,
+                            const UartBaud_Divisors *div)
+{
+    uint32_t n = clkHz / baud;
+    uint32_t errors = 0;
+    uint_fast8_t k;
+
+    if((div->overSampling ? 16u * div->brdiv + div->brf : div->brdiv) != n ||
+       div->overSampling != (n >= 16))
+        errors++;
+
+    if(fabs(bench_errorModel(clkHz, baud, div) - div->errorPpm) > 1.0)
+        errors++;
+
+    if(div->brdiv != UART_BAUD_BRDIV(clkHz, baud) ||
+       div->brf != UART_BAUD_BRF(clkHz, baud) ||
+       div->brs != UART_BAUD_BRS(clkHz, baud))
+        errors++;
+
+    for(k = 0; k < sizeof(known) / sizeof(known[0]); k++)
+    {
+        if(known[k].clockHz == clkHz && known[k].baud == baud &&
+           (!div->overSampling || div->brdiv != known[k].brdiv ||
+            div->brf != known[k].brf || div->brs != known[k].brs))
+            errors++;
+    }
+
+    return errors;
+}
+
+int main(void)
+{
+    uint32_t failed = 0;
+    uint_fast8_t c;
+    uint_fast8_t r;
+
+    printf("clock_hz,baud,os16,brdiv,brf,brs,error_ppm,errors\n");
+    for(c = 0; c < sizeof(clocks) / sizeof(clocks[0]); c++)
+    {
+        for(r = 0; r < sizeof(rates) / sizeof(rates[0]); r++)
+        {
+            UartBaud_Divisors div;
+            uint32_t errors;
+
+            if(!uart_baud_compute(clocks[c], rates[r], &div))
+            {
+                printf("%u,%u,rejected\n", clocks[c], rates[r]);
+                continue;
+            }
+
+            errors = bench_check(clocks[c], rates[r], &div);
+            failed += errors;
+            printf("%u,%u,%u,%u,%u,0x%02X,%d,%u\n", clocks[c], rates[r],
+                   div.overSampling, div.brdiv, div.brf, div.brs,
+                   div.errorPpm, errors);
+        }
+    }
+
+    return failed != 0;
+}
+
+#endif /* __MSP432P401R__ */
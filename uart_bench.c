@@ -0,0 +1,491 @@
+/******************************************************************************
+ * UART loopback benchmark
+ *
+ * See uart_bench.h. The stream is the byte sequence 0, 1, 2, ... and each
+ * byte's write time is kept in a table indexed by its value, so latency
+ * needs no per-byte headers on the wire. With at most UART_BENCH_MAX_CHUNK
+ * bytes in flight a received value is unambiguous: a value ahead of the
+ * expected one by less than half the sequence space means the bytes in
+ * between were dropped, anything else is corruption.
+ *
+ * Up to two chunks are in flight, so a run measures the driver with the
+ * next write queued behind the current one, as a streaming application
+ * would use it, without building a backlog that would count as latency.
+ *
+ * Latencies go into a log-linear histogram (four buckets per octave), so
+ * the percentiles are exact to within 1/8 of their value (capped at the
+ * exact maximum).
+ *
+ *******************************************************************************/
+#include <string.h>
+
+#include "uart_bench.h"
+#include "uart_driver.h"
+#include "cycle_stats.h"
+#include "hal.h"
+
+#ifdef __MSP432P401R__
+#include "uart_dma.h"
+#define UART_BENCH_CPU_HZ()     SystemCoreClock
+#else
+#define UART_BENCH_CPU_HZ()     hal_clock_smclkHz()
+#endif
+
+/* A run gives up after this many frame times without RX progress */
+#define UART_BENCH_TIMEOUT_FRAMES   64
+
+#define UART_BENCH_HIST_BUCKETS     128
+
+static uint32_t txTime[256];
+static uint32_t latHist[UART_BENCH_HIST_BUCKETS];
+
+static uint_fast8_t uart_bench_bucket(uint32_t v)
+{
+    uint_fast8_t msb = 0;
+
+    if(v < 4)
+        return (uint_fast8_t)v;
+    while(v >> (msb + 1))
+        msb++;
+
+    return (uint_fast8_t)(msb * 4 + ((v >> (msb - 2)) & 3));
+}
+
+/* Midpoint of a histogram bucket */
+static uint32_t uart_bench_bucketValue(uint_fast8_t b)
+{
+    uint_fast8_t msb = b / 4;
+    uint32_t base;
+
+    if(b < 4)
+        return b;
+
+    base = ((uint32_t)(4 | (b & 3))) << (msb - 2);
+    return base + ((1u << (msb - 2)) >> 1);
+}
+
+static uint32_t uart_bench_percentile(uint32_t count, uint_fast8_t pct,
+                                      uint32_t max)
+{
+    uint32_t want = (uint32_t)(((uint64_t)count * pct + 99) / 100);
+    uint32_t seen = 0;
+    uint_fast8_t b;
+
+    for(b = 0; b < UART_BENCH_HIST_BUCKETS; b++)
+    {
+        seen += latHist[b];
+        if(seen >= want && seen)
+        {
+            uint32_t value = uart_bench_bucketValue(b);
+            return value < max ? value : max;
+        }
+    }
+
+    return 0;
+}
+
+#if CYCLE_STATS_ENABLE
+static uint32_t uart_bench_isrCycles(const CycleStats *stats)
+{
+    uint64_t total = 0;
+    uint_fast8_t n;
+
+    for(n = 0; n < CYCLE_PROBE_COUNT; n++)
+    {
+        if(n != CYCLE_PROBE_SCHED)
+            total += stats->probe[n].total;
+    }
+
+    return (uint32_t)total;
+}
+#endif
+
+bool uart_bench_run(const UartBench_Driver *drv, uint32_t baud,
+                    uint16_t chunk, uint32_t bytes, UartBench_Result *out)
+{
+    uint8_t buf[UART_BENCH_MAX_CHUNK];
+    uint32_t frameCycles = (uint32_t)((uint64_t)UART_BENCH_CPU_HZ() * 10 / baud);
+    uint32_t timeout = frameCycles * UART_BENCH_TIMEOUT_FRAMES;
+    uint32_t window = chunk * 2u > UART_BENCH_MAX_CHUNK ?
+            UART_BENCH_MAX_CHUNK : chunk * 2u;
+    uint32_t sent = 0;              /* Bytes accepted by the driver      */
+    uint32_t settled = 0;           /* Received, dropped or corrupted    */
+    uint32_t good = 0;
+    uint8_t expected = 0;
+    uint32_t start, lastProgress, now;
+#if CYCLE_STATS_ENABLE
+    static CycleStats stats;
+#endif
+
+    if(chunk == 0 || chunk > UART_BENCH_MAX_CHUNK || !drv->start(baud, chunk))
+        return false;
+
+    memset(out, 0, sizeof(*out));
+    memset(latHist, 0, sizeof(latHist));
+    out->mode = drv->name;
+    out->baud = baud;
+    out->chunk = chunk;
+    out->bytes = bytes;
+
+#if CYCLE_STATS_ENABLE
+    cycle_stats_snapshot(&stats);
+#endif
+    start = CYCLE_STATS_NOW();
+    lastProgress = start;
+
+    while(settled < bytes)
+    {
+        uint16_t n;
+        uint16_t i;
+
+        /* Top up the loop, one chunk at a time */
+        if(sent < bytes && sent - settled + chunk <= window)
+        {
+            uint16_t len = bytes - sent < chunk ? (uint16_t)(bytes - sent) : chunk;
+
+            for(i = 0; i < len; i++)
+                buf[i] = (uint8_t)(sent + i);
+            n = drv->write(buf, len);
+
+            now = CYCLE_STATS_NOW();
+            for(i = 0; i < n; i++)
+                txTime[(uint8_t)(sent + i)] = now;
+            sent += n;
+        }
+
+        n = drv->read(buf, sizeof(buf));
+        now = CYCLE_STATS_NOW();
+
+        for(i = 0; i < n; i++)
+        {
+            uint8_t ahead = (uint8_t)(buf[i] - expected);
+
+            if(ahead < 128)
+            {
+                uint32_t latency = now - txTime[buf[i]];
+
+                out->dropped += ahead;
+                settled += ahead + 1u;
+                good++;
+                expected = buf[i] + 1;
+
+                latHist[uart_bench_bucket(latency)]++;
+                if(latency > out->latMax)
+                    out->latMax = latency;
+            }
+            else
+            {
+                out->corrupted++;
+                settled++;
+                expected++;
+            }
+        }
+
+        if(n != 0)
+        {
+            lastProgress = now;
+        }
+        else if(sent > settled)
+        {
+            if(now - lastProgress > timeout)
+            {
+                out->dropped += sent - settled;
+                settled = sent;
+                break;
+            }
+            if(drv->idle)
+                drv->idle();
+        }
+    }
+
+    out->cycles = CYCLE_STATS_NOW() - start;
+    drv->stop();
+
+#if CYCLE_STATS_ENABLE
+    cycle_stats_snapshot(&stats);
+    out->isrCyclesPerByte = good ? uart_bench_isrCycles(&stats) / good : 0;
+#endif
+
+    out->bytesPerSec = out->cycles ?
+            (uint32_t)((uint64_t)good * UART_BENCH_CPU_HZ() / out->cycles) : 0;
+    out->latP50 = uart_bench_percentile(good, 50, out->latMax);
+    out->latP90 = uart_bench_percentile(good, 90, out->latMax);
+    out->latP99 = uart_bench_percentile(good, 99, out->latMax);
+
+    return true;
+}
+
+static char *uart_bench_putUint(char *dst, uint32_t value)
+{
+    char digits[10];
+    uint_fast8_t n = 0;
+
+    do
+    {
+        digits[n++] = (char)('0' + value % 10);
+        value /= 10;
+    } while(value);
+
+    while(n)
+        *dst++ = digits[--n];
+    *dst++ = ',';
+    return dst;
+}
+
+uint16_t uart_bench_csvHeader(char *buf)
+{
+    static const char header[] =
+        "mode,baud,chunk,bytes,cycles,bytes_per_s,isr_cycles_per_byte,"
+        "lat_p50,lat_p90,lat_p99,lat_max,dropped,corrupted\r\n";
+
+    memcpy(buf, header, sizeof(header) - 1);
+    return sizeof(header) - 1;
+}
+
+uint16_t uart_bench_csv(const UartBench_Result *r, char *buf)
+{
+    char *p = buf;
+    const char *name = r->mode;
+
+    while(*name)
+        *p++ = *name++;
+    *p++ = ',';
+    p = uart_bench_putUint(p, r->baud);
+    p = uart_bench_putUint(p, r->chunk);
+    p = uart_bench_putUint(p, r->bytes);
+    p = uart_bench_putUint(p, r->cycles);
+    p = uart_bench_putUint(p, r->bytesPerSec);
+    p = uart_bench_putUint(p, r->isrCyclesPerByte);
+    p = uart_bench_putUint(p, r->latP50);
+    p = uart_bench_putUint(p, r->latP90);
+    p = uart_bench_putUint(p, r->latP99);
+    p = uart_bench_putUint(p, r->latMax);
+    p = uart_bench_putUint(p, r->dropped);
+    p = uart_bench_putUint(p, r->corrupted);
+
+    /* Last field: the comma becomes the line end */
+    p[-1] = '\r';
+    *p++ = '\n';
+    return (uint16_t)(p - buf);
+}
+
+void uart_bench_suite(const UartBench_Driver *const *drivers,
+                      uint_fast8_t count, UartBench_Report report)
+{
+    static const uint32_t bauds[] = UART_BENCH_BAUDS;
+    static const uint16_t chunks[] = UART_BENCH_CHUNKS;
+    char line[UART_BENCH_LINE_MAX];
+    UartBench_Result result;
+    uint_fast8_t d, b, c;
+
+    cycle_stats_init();
+    report(line, uart_bench_csvHeader(line));
+
+    for(d = 0; d < count; d++)
+    {
+        for(b = 0; b < sizeof(bauds) / sizeof(bauds[0]); b++)
+        {
+            for(c = 0; c < sizeof(chunks) / sizeof(chunks[0]); c++)
+            {
+                /* About 1/8 s of traffic, whole chunks */
+                uint32_t bytes = bauds[b] / 80 < 512 ? 512 : bauds[b] / 80;
+
+                bytes -= bytes % chunks[c];
+                if(uart_bench_run(drivers[d], bauds[b], chunks[c], bytes,
+                                  &result))
+                    report(line, uart_bench_csv(&result, line));
+            }
+        }
+    }
+}
+
+/* Polling: all eUSCI interrupts off, flags tested in the caller's loop */
+
+static bool uart_bench_pollStart(uint32_t baud, uint16_t chunk)
+{
+    (void)chunk;
+
+    if(!uart_setBaudRate(&uartA2, baud, 0))
+        return false;
+    hal_uart_rxIe(HAL_UART_A2, false);
+    return true;
+}
+
+static uint16_t uart_bench_pollWrite(const uint8_t *buf, uint16_t len)
+{
+    uint16_t n = 0;
+
+    while(n < len && (hal_uart_flags(HAL_UART_A2) & HAL_UART_TX_FLAG))
+        hal_uart_write(HAL_UART_A2, buf[n++]);
+    return n;
+}
+
+static uint16_t uart_bench_pollRead(uint8_t *buf, uint16_t len)
+{
+    uint16_t n = 0;
+
+    while(n < len && (hal_uart_flags(HAL_UART_A2) & HAL_UART_RX_FLAG))
+        buf[n++] = hal_uart_read(HAL_UART_A2);
+    return n;
+}
+
+static void uart_bench_pollStop(void)
+{
+    hal_uart_rxIe(HAL_UART_A2, true);
+}
+
+const UartBench_Driver uartBenchPolling =
+{
+    "polling", uart_bench_pollStart, uart_bench_pollWrite,
+    uart_bench_pollRead, 0, uart_bench_pollStop
+};
+
+/* Interrupt-driven: uart_driver.c rings */
+
+static bool uart_bench_irqStart(uint32_t baud, uint16_t chunk)
+{
+    uint8_t drain[16];
+
+    (void)chunk;
+
+    if(!uart_setBaudRate(&uartA2, baud, 0))
+        return false;
+    while(uart_read(&uartA2, drain, sizeof(drain)))
+        ;
+    return true;
+}
+
+static uint16_t uart_bench_irqWrite(const uint8_t *buf, uint16_t len)
+{
+    return uart_write(&uartA2, buf, len);
+}
+
+static uint16_t uart_bench_irqRead(uint8_t *buf, uint16_t len)
+{
+    return uart_read(&uartA2, buf, len);
+}
+
+static void uart_bench_irqIdle(void)
+{
+    /* Wake on any interrupt, not only RX: keep SLEEPONEXIT off */
+    hal_sleepOnExit(false);
+    hal_irq_disable();
+    if(ring_isEmpty(&uartA2.rxRing))
+        hal_sleep();
+    hal_irq_enable();
+}
+
+static void uart_bench_irqStop(void)
+{
+    uart_flush(&uartA2);
+}
+
+const UartBench_Driver uartBenchIrq =
+{
+    "irq", uart_bench_irqStart, uart_bench_irqWrite, uart_bench_irqRead,
+    uart_bench_irqIdle, uart_bench_irqStop
+};
+
+#ifdef __MSP432P401R__
+
+/* uDMA: ping-pong RX buffers of one chunk each, TX copied into two slots */
+
+static uint8_t dmaRxBuf[2][UART_BENCH_MAX_CHUNK];
+static uint8_t dmaTxBuf[2][UART_BENCH_MAX_CHUNK];
+static volatile uint8_t dmaTxFree;      /* Bit per free TX slot      */
+static volatile uint8_t dmaRxReady;     /* Filled RX buffers waiting */
+static uint16_t dmaChunk;
+
+static void uart_bench_dmaRxDone(uint8_t *buf, uint16_t len)
+{
+    (void)buf;
+    (void)len;
+    dmaRxReady++;
+}
+
+static void uart_bench_dmaTxDone(uint8_t *buf, uint16_t len)
+{
+    (void)len;
+    dmaTxFree |= buf == dmaTxBuf[0] ? 1 : 2;
+}
+
+static bool uart_bench_dmaStart(uint32_t baud, uint16_t chunk)
+{
+    if(!uart_setBaudRate(&uartA2, baud, 0))
+        return false;
+
+    dmaChunk = chunk;
+    dmaTxFree = 3;
+    dmaRxReady = 0;
+    uart_dma_init(uart_bench_dmaRxDone, uart_bench_dmaTxDone);
+    uart_dma_rxGive(dmaRxBuf[0], chunk);
+    uart_dma_rxGive(dmaRxBuf[1], chunk);
+    return true;
+}
+
+static uint16_t uart_bench_dmaWrite(const uint8_t *buf, uint16_t len)
+{
+    uint_fast8_t slot;
+
+    if(!dmaTxFree)
+        return 0;
+
+    slot = (dmaTxFree & 1) ? 0 : 1;
+    memcpy(dmaTxBuf[slot], buf, len);
+    dmaTxFree &= ~(1u << slot);
+    if(!uart_dma_write(dmaTxBuf[slot], len))
+    {
+        dmaTxFree |= 1u << slot;
+        return 0;
+    }
+    return len;
+}
+
+static uint16_t uart_bench_dmaRead(uint8_t *buf, uint16_t len)
+{
+    uint16_t got;
+    uint8_t *full = uart_dma_rxTake(&got);
+
+    if(!full)
+        return 0;
+
+    MAP_Interrupt_disableMaster();
+    dmaRxReady--;
+    MAP_Interrupt_enableMaster();
+
+    if(got > len)
+        got = len;
+    memcpy(buf, full, got);
+    uart_dma_rxGive(full, dmaChunk);
+    return got;
+}
+
+static void uart_bench_dmaIdle(void)
+{
+    hal_sleepOnExit(false);
+    hal_irq_disable();
+    if(!dmaRxReady)
+        hal_sleep();
+    hal_irq_enable();
+}
+
+static void uart_bench_dmaStop(void)
+{
+    while(uart_dma_txBusy())
+        ;
+    uart_dma_stop();
+}
+
+const UartBench_Driver uartBenchDma =
+{
+    "dma", uart_bench_dmaStart, uart_bench_dmaWrite, uart_bench_dmaRead,
+    uart_bench_dmaIdle, uart_bench_dmaStop
+};
+
+/* Wakes the idle loops so a run whose last byte never arrives still
+ * reaches its timeout */
+void SysTick_Handler(void)
+{
+}
+
+#endif
@@ -0,0 +1,103 @@
+/******************************************************************************
+ * UART loopback benchmark
+ *
+ * Description: Pushes a numbered byte stream through a TX->RX loopback and
+ * measures, per run:
+ *
+ *     bytes/s             bytes received in order over the run time
+ *     ISR cycles/byte     cycles of every instrumented ISR over the run
+ *                         (needs CYCLE_STATS_ENABLE, 0 otherwise)
+ *     latency p50/p90/p99/max
+ *                         CPU cycles from the write call accepting a byte
+ *                         to the read call returning it
+ *     dropped, corrupted  bytes missing from / out of the sequence
+ *
+ * Drivers plug in through UartBench_Driver; uart_bench.c provides the
+ * eUSCI_A2 ones (polling, interrupt-driven, uDMA on the target). The
+ * application adds others, e.g. the software GPIO UART in main().
+ * uart_bench_suite() runs every driver across UART_BENCH_BAUDS and
+ * UART_BENCH_CHUNKS and reports each run as one CSV line:
+ *
+ *     mode,baud,chunk,bytes,cycles,bytes_per_s,isr_cycles_per_byte,
+ *     lat_p50,lat_p90,lat_p99,lat_max,dropped,corrupted
+ *
+ * The cycle source is DWT->CYCCNT on the target and simulated SMCLK cycles
+ * (see hal_host.h) on the host.
+ *
+ *******************************************************************************/
+#ifndef UART_BENCH_H_
+#define UART_BENCH_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define UART_BENCH_BAUDS        { 9600, 115200, 460800, 921600 }
+#define UART_BENCH_CHUNKS       { 1, 16, 64, 128 }
+
+/* Largest chunk; also bounds the bytes in flight so that the 8-bit
+ * sequence number identifies every byte */
+#define UART_BENCH_MAX_CHUNK    128
+
+/* Longest line uart_bench_csv() produces, including the CR LF */
+#define UART_BENCH_LINE_MAX     160
+
+typedef struct
+{
+    const char *name;
+
+    /* Prepares a run; false if the rate cannot be served */
+    bool (*start)(uint32_t baud, uint16_t chunk);
+
+    /* Non-blocking: return the number of bytes accepted / delivered */
+    uint16_t (*write)(const uint8_t *buf, uint16_t len);
+    uint16_t (*read)(uint8_t *buf, uint16_t len);
+
+    /* Waits for the next RX progress, e.g. in LPM0; NULL to spin */
+    void (*idle)(void);
+
+    void (*stop)(void);
+} UartBench_Driver;
+
+typedef struct
+{
+    const char *mode;
+    uint32_t baud;
+    uint16_t chunk;
+    uint32_t bytes;
+    uint32_t cycles;
+    uint32_t bytesPerSec;
+    uint32_t isrCyclesPerByte;
+    uint32_t latP50;
+    uint32_t latP90;
+    uint32_t latP99;
+    uint32_t latMax;
+    uint32_t dropped;
+    uint32_t corrupted;
+} UartBench_Result;
+
+/* Receives one CSV line at a time */
+typedef void (*UartBench_Report)(const char *line, uint16_t len);
+
+extern const UartBench_Driver uartBenchPolling;
+extern const UartBench_Driver uartBenchIrq;
+#ifdef __MSP432P401R__
+extern const UartBench_Driver uartBenchDma;
+#endif
+
+/* Runs bytes through drv in writes of chunk bytes. Returns false if the
+ * driver refused the configuration. */
+extern bool uart_bench_run(const UartBench_Driver *drv, uint32_t baud,
+                           uint16_t chunk, uint32_t bytes,
+                           UartBench_Result *out);
+
+/* Formats the CSV header or one result into buf, which must hold
+ * UART_BENCH_LINE_MAX bytes. Returns the length. */
+extern uint16_t uart_bench_csvHeader(char *buf);
+extern uint16_t uart_bench_csv(const UartBench_Result *result, char *buf);
+
+/* Runs every driver over the whole baud/chunk matrix, reporting the header
+ * and then each run as it finishes */
+extern void uart_bench_suite(const UartBench_Driver *const *drivers,
+                             uint_fast8_t count, UartBench_Report report);
+
+#endif /* UART_BENCH_H_ */
@@ -0,0 +1,220 @@
+/******************************************************************************
+ * uDMA mode for the eUSCI_A2 UART
+ *
+ * All controller restarts happen in the channel's ISR: the thread side only
+ * programs descriptors of FREE slots, marks them ARMED and, if the channel
+ * had run dry, pends the ISR in software. The ISR is then the only context
+ * that decides which descriptor a stopped channel resumes from.
+ *
+ * A finished descriptor reads back as UDMA_MODE_STOP, which tells the ISR
+ * how many slots completed regardless of whether it was entered by the
+ * controller or by a software pend.
+ *
+ *******************************************************************************/
+/* DriverLib Includes */
+#include <ti/devices/msp432p4xx/driverlib/driverlib.h>
+
+#include "uart_dma.h"
+#include "dma_msp432.h"
+#include "cycle_stats.h"
+#include "hal.h"
+
+#define UART_DMA_BASE       EUSCI_A2_BASE
+#define UART_DMA_REGS       EUSCI_A2
+#define UART_DMA_RX_CH      DMA_CH5_EUSCIA2RX
+#define UART_DMA_TX_CH      DMA_CH4_EUSCIA2TX
+#define UART_DMA_RX_INT     INT_DMA_INT1
+#define UART_DMA_TX_INT     INT_DMA_INT2
+
+#define UART_DMA_SLOT_SEL(slot) DMA_MSP432_SLOT_SEL(slot)
+
+typedef struct
+{
+    DmaPingPong pp;
+    uint32_t channel;
+    uint32_t interrupt;
+    bool rx;
+    UartDma_Callback callback;
+} UartDma_Channel;
+
+static UartDma_Channel rxChannel;
+static UartDma_Channel txChannel;
+
+static void uart_dma_setupChannel(UartDma_Channel *c, uint32_t channel,
+                                  uint32_t dmaInt, uint32_t interrupt,
+                                  bool rx, UartDma_Callback callback)
+{
+    uint32_t control = UDMA_SIZE_8 | UDMA_ARB_1 |
+                       (rx ? (UDMA_SRC_INC_NONE | UDMA_DST_INC_8)
+                           : (UDMA_SRC_INC_8 | UDMA_DST_INC_NONE));
+
+    dma_pp_init(&c->pp);
+    c->channel = channel;
+    c->interrupt = interrupt;
+    c->rx = rx;
+    c->callback = callback;
+
+    MAP_DMA_assignChannel(channel);
+    MAP_DMA_disableChannelAttribute(channel, UDMA_ATTR_ALTSELECT |
+                                    UDMA_ATTR_USEBURST |
+                                    UDMA_ATTR_HIGH_PRIORITY |
+                                    UDMA_ATTR_REQMASK);
+    MAP_DMA_setChannelControl(channel | UDMA_PRI_SELECT, control);
+    MAP_DMA_setChannelControl(channel | UDMA_ALT_SELECT, control);
+
+    MAP_DMA_assignInterrupt(dmaInt, channel & 0x0F);
+    MAP_DMA_clearInterruptFlag(channel & 0x0F);
+    MAP_Interrupt_enableInterrupt(interrupt);
+}
+
+void uart_dma_init(UartDma_Callback rxCallback, UartDma_Callback txCallback)
+{
+    dma_msp432_init();
+
+    /* From here on the controller moves the bytes */
+    MAP_UART_disableInterrupt(UART_DMA_BASE, EUSCI_A_UART_RECEIVE_INTERRUPT |
+                              EUSCI_A_UART_TRANSMIT_INTERRUPT |
+                              EUSCI_A_UART_TRANSMIT_COMPLETE_INTERRUPT);
+
+    uart_dma_setupChannel(&rxChannel, UART_DMA_RX_CH, DMA_INT1,
+                          UART_DMA_RX_INT, true, rxCallback);
+    uart_dma_setupChannel(&txChannel, UART_DMA_TX_CH, DMA_INT2,
+                          UART_DMA_TX_INT, false, txCallback);
+}
+
+static void uart_dma_stopChannel(UartDma_Channel *c)
+{
+    MAP_Interrupt_disableInterrupt(c->interrupt);
+    MAP_DMA_disableChannel(c->channel & 0x0F);
+    MAP_DMA_clearInterruptFlag(c->channel & 0x0F);
+    dma_pp_init(&c->pp);
+}
+
+void uart_dma_stop(void)
+{
+    uart_dma_stopChannel(&rxChannel);
+    uart_dma_stopChannel(&txChannel);
+}
+
+/* Thread side: programs the next FREE slot and arms it */
+static bool uart_dma_give(UartDma_Channel *c, uint8_t *buf, uint16_t len)
+{
+    int slot = dma_pp_giveSlot(&c->pp);
+
+    if(slot < 0 || len == 0 || len > UART_DMA_MAX_TRANSFER)
+        return false;
+
+    if(c->rx)
+    {
+        MAP_DMA_setChannelTransfer(c->channel | UART_DMA_SLOT_SEL(slot),
+                UDMA_MODE_PINGPONG,
+                (void *)MAP_UART_getReceiveBufferAddressForDMA(UART_DMA_BASE),
+                buf, len);
+    }
+    else
+    {
+        MAP_DMA_setChannelTransfer(c->channel | UART_DMA_SLOT_SEL(slot),
+                UDMA_MODE_PINGPONG, buf,
+                (void *)MAP_UART_getTransmitBufferAddressForDMA(UART_DMA_BASE),
+                len);
+    }
+
+    dma_pp_give(&c->pp, buf, len);
+
+    if(!c->pp.running)
+        MAP_Interrupt_pendInterrupt(c->interrupt);
+
+    return true;
+}
+
+/* ISR side: retires finished slots and restarts a channel that ran dry */
+static void uart_dma_service(UartDma_Channel *c)
+{
+    int slot;
+
+    MAP_DMA_clearInterruptFlag(c->channel & 0x0F);
+
+    while((slot = dma_pp_activeSlot(&c->pp)) >= 0 &&
+          MAP_DMA_getChannelMode(c->channel | UART_DMA_SLOT_SEL(slot))
+              == UDMA_MODE_STOP)
+    {
+        dma_pp_complete(&c->pp);
+        if(c->callback)
+            c->callback(c->pp.buf[slot], c->pp.len[slot]);
+        hal_sleepOnExit(false);
+    }
+
+    if(MAP_DMA_isChannelEnabled(c->channel & 0x0F))
+        return;
+
+    slot = dma_pp_activeSlot(&c->pp);
+    if(slot < 0)
+    {
+        if(c->rx && c->pp.running)
+            c->pp.stalls++;
+        c->pp.running = false;
+        return;
+    }
+
+    if(slot)
+        MAP_DMA_enableChannelAttribute(c->channel, UDMA_ATTR_ALTSELECT);
+    else
+        MAP_DMA_disableChannelAttribute(c->channel, UDMA_ATTR_ALTSELECT);
+
+    c->pp.running = true;
+    MAP_DMA_enableChannel(c->channel & 0x0F);
+
+    /* The TX request is edge triggered off TXIFG, which is already set
+     * while the transmitter idles: re-raise it to start the first byte. */
+    if(!c->rx)
+    {
+        BITBAND_PERI(UART_DMA_REGS->IFG, EUSCI_A_IFG_TXIFG_OFS) = 0;
+        BITBAND_PERI(UART_DMA_REGS->IFG, EUSCI_A_IFG_TXIFG_OFS) = 1;
+    }
+}
+
+bool uart_dma_rxGive(uint8_t *buf, uint16_t len)
+{
+    return uart_dma_give(&rxChannel, buf, len);
+}
+
+uint8_t *uart_dma_rxTake(uint16_t *len)
+{
+    return dma_pp_take(&rxChannel.pp, len);
+}
+
+bool uart_dma_write(uint8_t *buf, uint16_t len)
+{
+    /* Reclaim buffers the controller has finished with */
+    while(dma_pp_take(&txChannel.pp, 0))
+        ;
+
+    return uart_dma_give(&txChannel, buf, len);
+}
+
+bool uart_dma_txBusy(void)
+{
+    return txChannel.pp.state[0] == DMA_PP_ARMED ||
+           txChannel.pp.state[1] == DMA_PP_ARMED;
+}
+
+uint16_t uart_dma_rxStalls(void)
+{
+    return rxChannel.pp.stalls;
+}
+
+/* DMA channel interrupt 1 - eUSCI_A2 RX buffer complete */
+void DMA_INT1_IRQHandler(void)
+{
+    CYCLE_STATS_ISR_ENTER(DMA_RX);
+    uart_dma_service(&rxChannel);
+    CYCLE_STATS_ISR_EXIT(DMA_RX);
+}
+
+/* DMA channel interrupt 2 - eUSCI_A2 TX buffer complete */
+void DMA_INT2_IRQHandler(void)
+{
+    CYCLE_STATS_ISR_ENTER(DMA_TX);
+    uart_dma_service(&txChannel);
+    CYCLE_STATS_ISR_EXIT(DMA_TX);
+}
@@ -0,0 +1,63 @@
+/******************************************************************************
+ * uDMA mode for the eUSCI_A2 UART
+ *
+ * Description: Moves RX and TX bytes between eUSCI_A2 and caller buffers
+ * with uDMA channels in ping-pong mode (channel 5 = A2 RX, channel 4 = A2
+ * TX), so the CPU takes one interrupt per buffer instead of one per byte:
+ *
+ *     DMA_INT1  <- RX descriptor complete
+ *     DMA_INT2  <- TX descriptor complete
+ *
+ * Buffers are handed over, never copied. RX: give two empty buffers with
+ * uart_dma_rxGive(); each one comes back full from uart_dma_rxTake() and
+ * must be given again before the other one fills, or reception stalls and
+ * is counted in uart_dma_rxStalls(). TX: uart_dma_write() queues up to two
+ * buffers; each is owned by the controller until the TX callback returns
+ * it (or the next uart_dma_write() reclaims it).
+ *
+ * The byte-per-interrupt path of uart_driver.c is switched off for the
+ * directions running on DMA.
+ *
+ *******************************************************************************/
+#ifndef UART_DMA_H_
+#define UART_DMA_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "dma_pingpong.h"
+
+/* One uDMA descriptor moves at most this many bytes */
+#define UART_DMA_MAX_TRANSFER   1024
+
+/* Runs in interrupt context with a buffer the controller just released */
+typedef void (*UartDma_Callback)(uint8_t *buf, uint16_t len);
+
+/* Sets up the controller and both channels; RX starts once a buffer is
+ * given. Either callback may be NULL. */
+extern void uart_dma_init(UartDma_Callback rxCallback,
+                          UartDma_Callback txCallback);
+
+/* Stops both channels and their interrupts; buffers still owned by the
+ * controller are dropped. The eUSCI interrupts stay off until the next
+ * uart_init() or uart_setBaudRate(). */
+extern void uart_dma_stop(void);
+
+/* Hands an empty buffer to the receiver. Returns false if both slots are
+ * still owned by the controller or the application has not taken them. */
+extern bool uart_dma_rxGive(uint8_t *buf, uint16_t len);
+
+/* Takes the oldest filled RX buffer, or NULL if none is ready. */
+extern uint8_t *uart_dma_rxTake(uint16_t *len);
+
+/* Queues buf for transmission without copying it. Returns false if both TX
+ * slots are in flight. */
+extern bool uart_dma_write(uint8_t *buf, uint16_t len);
+
+/* True while a TX buffer is still owned by the controller */
+extern bool uart_dma_txBusy(void);
+
+/* Times RX ran out of armed buffers, wrap-around */
+extern uint16_t uart_dma_rxStalls(void);
+
+#endif /* UART_DMA_H_ */
@@ -0,0 +1,597 @@
+/******************************************************************************
+ * Interrupt-driven eUSCI_A UART driver
+ *
+ * TX interrupt enables are toggled one bit at a time (bit-band stores on
+ * the target, see hal_msp432.h): the ISR and uart_write() both change
+ * them, and a single store cannot be torn by the other side the way a
+ * read-modify-write of UCAxIE can.
+ *
+ * uart_isr() is forced inline into each vector with the object's address
+ * as a constant, so every field access is a fixed offset from a literal
+ * and the UART_FLOW_UART test resolves at compile time.
+ *
+ * The one-shot timer is restarted by every received byte of the instance
+ * holding it, so it only runs out once that line has been quiet for the
+ * whole timeout.
+ *
+ * Block TX: the producer fills a slot before publishing txBlockHead and
+ * the ISR advances txBlockTail once the block is done with, with the same
+ * barriers as ring_buffer.h. txBlockPos is the ISR's alone.
+ *
+ * Flow control: rxThrottled is set by the ISR only and cleared by
+ * uart_read() only, with interrupts masked, so RTS follows it without a
+ * lost update. The CTS edge interrupt is armed before the pin is sampled
+ * again, so an assertion between the two is never missed.
+ *
+ *******************************************************************************/
+#include "uart_driver.h"
+#include "cycle_stats.h"
+#include "noinit.h"
+#include "ramfunc.h"
+
+#define UART_ISR_INLINE     static inline __attribute__((always_inline))
+
+_Static_assert(UART_RX_RING_SIZE <= 32768 &&
+               (UART_RX_RING_SIZE & (UART_RX_RING_SIZE - 1)) == 0,
+               "UART_RX_RING_SIZE must be a power of two <= 32768");
+_Static_assert(UART_TX_RING_SIZE <= 32768 &&
+               (UART_TX_RING_SIZE & (UART_TX_RING_SIZE - 1)) == 0,
+               "UART_TX_RING_SIZE must be a power of two <= 32768");
+
+#if UART_TX_BLOCKS
+_Static_assert(UART_TX_BLOCKS <= 128 &&
+               (UART_TX_BLOCKS & (UART_TX_BLOCKS - 1)) == 0,
+               "UART_TX_BLOCKS must be a power of two <= 128");
+#endif
+
+#if UART_RX_TAG_ERRORS
+#define UART_STATUS_RING(name)                                                \
+    .rxStatusRing = { 0, 0, UART_RX_RING_SIZE - 1, name##_status },
+#define UART_STATUS_STORAGE(name)                                             \
+    static NOINIT uint8_t name##_status[UART_RX_RING_SIZE];
+#else
+#define UART_STATUS_RING(name)
+#define UART_STATUS_STORAGE(name)
+#endif
+
+/* Defines an instance bound to an eUSCI_A module, with static ring storage
+ * the start-up code does not clear */
+#define UART_DEFINE(name, module)                                             \
+    static NOINIT uint8_t name##_rx[UART_RX_RING_SIZE];                       \
+    static NOINIT uint8_t name##_tx[UART_TX_RING_SIZE];                       \
+    UART_STATUS_STORAGE(name)                                                 \
+    Uart name =                                                               \
+    {                                                                         \
+        .hw = module,                                                         \
+        .rxRing = { 0, 0, UART_RX_RING_SIZE - 1, name##_rx },                 \
+        .txRing = { 0, 0, UART_TX_RING_SIZE - 1, name##_tx },                 \
+        UART_STATUS_RING(name)                                                \
+        .rxWakeLevel = 1                                                      \
+    }
+
+#if UART_MODULES & (1u << 0)
+UART_DEFINE(uartA0, HAL_UART_A0);
+#endif
+#if UART_MODULES & (1u << 1)
+UART_DEFINE(uartA1, HAL_UART_A1);
+#endif
+#if UART_MODULES & (1u << 2)
+UART_DEFINE(uartA2, HAL_UART_A2);
+#endif
+#if UART_MODULES & (1u << 3)
+UART_DEFINE(uartA3, HAL_UART_A3);
+#endif
+
+/* Instance the Timer32 one-shot currently times, if any */
+static Uart *volatile idleOwner = 0;
+
+/* True if anything is queued for TXBUF */
+static inline bool uart_txQueued(const Uart *uart)
+{
+#if UART_TX_BLOCKS
+    if(uart->txBlockHead != uart->txBlockTail)
+        return true;
+#endif
+    return !ring_isEmpty(&uart->txRing);
+}
+
+#if UART_FLOW_CONTROL
+#define UART_FLOW(uart)     ((uart) == &UART_FLOW_UART)
+#define UART_CTS_BLOCKED()  hal_gpio_read(UART_CTS_PORT, UART_CTS_PIN)
+
+/* Parks the transmitter until CTS falls. Returns false if it already has,
+ * in which case the caller carries on sending. */
+RAMFUNC static bool uart_ctsStall(Uart *uart)
+{
+    hal_uart_txIe(uart->hw, false);
+    hal_gpio_edgeClear(UART_CTS_PORT, UART_CTS_PIN);
+    hal_gpio_edgeIe(UART_CTS_PORT, UART_CTS_PIN, true);
+
+    if(UART_CTS_BLOCKED())
+    {
+        uart->ctsStalls++;
+        return true;
+    }
+
+    hal_gpio_edgeIe(UART_CTS_PORT, UART_CTS_PIN, false);
+    hal_uart_txIe(uart->hw, true);
+    return false;
+}
+
+/* True if the byte due for TXBUF has to wait for CTS */
+#define UART_TX_HELD(uart)                                                    \
+    (UART_FLOW(uart) && uart_txQueued(uart) &&                                \
+     UART_CTS_BLOCKED() && uart_ctsStall(uart))
+#else
+#define UART_FLOW(uart)     false
+#define UART_TX_HELD(uart)  false
+#endif
+
+/* MCLK cycles of bitTimes bit periods at the current divisors */
+static uint64_t uart_idleTicks(const Uart *uart, uint16_t bitTimes)
+{
+    const Hal_UartConfig *cfg = &uart->config;
+    uint32_t bitCycles = cfg->overSampling ?
+            (uint32_t)cfg->brdiv * 16 + cfg->brf : cfg->brdiv;
+
+    return (uint64_t)bitTimes * bitCycles * hal_clock_mclkHz() /
+           hal_clock_smclkHz();
+}
+
+/* Reloads the idle timeout after a divisor change, saturating */
+static void uart_idleUpdate(Uart *uart)
+{
+    uint64_t ticks = uart_idleTicks(uart, uart->idleBits);
+
+    if(idleOwner == uart)
+        hal_oneshot_stop();
+    uart->idleTicks = ticks > UINT32_MAX ? UINT32_MAX : (uint32_t)ticks;
+}
+
+bool uart_init(Uart *uart, const Hal_UartConfig *config)
+{
+    if(!hal_uart_configure(uart->hw, config))
+        return false;
+
+    uart->config = *config;
+    hal_oneshot_init();
+    uart_idleUpdate(uart);
+
+    hal_uart_enable(uart->hw);
+    hal_uart_rxIe(uart->hw, true);
+    hal_uart_irqEnable(uart->hw);
+
+#if UART_FLOW_CONTROL
+    if(UART_FLOW(uart))
+    {
+        /* RTS asserted: ready to receive */
+        hal_gpio_low(UART_RTS_PORT, UART_RTS_PIN);
+        hal_gpio_output(UART_RTS_PORT, UART_RTS_PIN);
+        uart->rxThrottled = false;
+
+        hal_gpio_input(UART_CTS_PORT, UART_CTS_PIN);
+        hal_gpio_edgeSelect(UART_CTS_PORT, UART_CTS_PIN, true);
+        hal_gpio_edgeClear(UART_CTS_PORT, UART_CTS_PIN);
+        hal_gpio_irqEnable(UART_CTS_PORT);
+    }
+#endif
+
+    return true;
+}
+
+bool uart_setBaudRate(Uart *uart, uint32_t baud, int32_t *errorPpm)
+{
+    UartBaud_Divisors div;
+    Hal_UartConfig config;
+
+    if(!uart_baud_compute(hal_clock_smclkHz(), baud, &div))
+        return false;
+
+    config.brdiv = div.brdiv;
+    config.brf = div.brf;
+    config.brs = div.brs;
+    config.overSampling = div.overSampling;
+    if(errorPpm)
+        *errorPpm = div.errorPpm;
+
+    /* Configuring puts the module in reset, which also clears UCAxIE */
+    if(!hal_uart_configure(uart->hw, &config))
+        return false;
+
+    uart->config = config;
+    uart_idleUpdate(uart);
+    hal_uart_enable(uart->hw);
+    hal_uart_rxIe(uart->hw, true);
+    if(uart->txBusy)
+        hal_uart_txIe(uart->hw, true);
+
+    return true;
+}
+
+uint16_t uart_write(Uart *uart, const uint8_t *buf, uint16_t len)
+{
+    uint16_t queued = ring_write(&uart->txRing, buf, len);
+
+    if(queued != 0)
+        uart_startTx(uart);
+
+    return queued;
+}
+
+RAMFUNC void uart_startTx(Uart *uart)
+{
+    /* Completion belongs to the end of this burst, not an older one */
+    hal_uart_txCptIe(uart->hw, false);
+    uart->txBusy = true;
+    hal_uart_txIe(uart->hw, true);
+}
+
+#if UART_TX_BLOCKS
+RAMFUNC bool uart_writeBlock(Uart *uart, uint8_t *block, uint16_t len)
+{
+    uint8_t head = uart->txBlockHead;
+    uint8_t slot = head & (UART_TX_BLOCKS - 1);
+
+    if((uint8_t)(head - uart->txBlockTail) >= UART_TX_BLOCKS)
+        return false;
+
+    uart->txBlock[slot] = block;
+    uart->txBlockLen[slot] = len;
+    RING_BARRIER();
+    uart->txBlockHead = head + 1;
+
+    uart_startTx(uart);
+    return true;
+}
+
+void uart_setTxBlockCallback(Uart *uart, Uart_BlockCallback callback)
+{
+    uart->txBlockDone = callback;
+}
+
+/* Next byte of the oldest lent block, returning the block once it has
+ * been read out. False if no block is queued. */
+RAMFUNC static inline bool uart_txBlockGet(Uart *uart, uint8_t *byte)
+{
+    uint8_t tail = uart->txBlockTail;
+    uint8_t slot = tail & (UART_TX_BLOCKS - 1);
+    uint8_t *block;
+
+    if(tail == uart->txBlockHead)
+        return false;
+
+    RING_BARRIER();
+    block = uart->txBlock[slot];
+    *byte = block[uart->txBlockPos];
+
+    if(++uart->txBlockPos == uart->txBlockLen[slot])
+    {
+        uart->txBlockPos = 0;
+        RING_BARRIER();
+        uart->txBlockTail = tail + 1;
+        if(uart->txBlockDone)
+            uart->txBlockDone(uart, block);
+    }
+
+    return true;
+}
+#endif
+
+/* Reasserts RTS once a read has drained the ring below the low watermark */
+static void uart_rtsUpdate(Uart *uart)
+{
+#if UART_FLOW_CONTROL
+    if(uart->rxThrottled && ring_count(&uart->rxRing) < UART_RTS_LOW_WATER)
+    {
+        hal_irq_disable();
+        uart->rxThrottled = false;
+        hal_gpio_low(UART_RTS_PORT, UART_RTS_PIN);
+        hal_irq_enable();
+    }
+#else
+    (void)uart;
+#endif
+}
+
+#if UART_RX_TAG_ERRORS
+uint16_t uart_readStatus(Uart *uart, uint8_t *buf, uint8_t *status,
+                         uint16_t len)
+{
+    uint16_t n;
+
+    /* Cleared before the read: a gap ending after it still counts */
+    uart->rxIdle = false;
+
+    /* The ISR queues the status first, so it is there for every byte */
+    n = ring_read(&uart->rxRing, buf, len);
+
+    if(status)
+        ring_read(&uart->rxStatusRing, status, n);
+    else
+        ring_skip(&uart->rxStatusRing, n);
+
+    uart_rtsUpdate(uart);
+    return n;
+}
+
+uint16_t uart_read(Uart *uart, uint8_t *buf, uint16_t len)
+{
+    return uart_readStatus(uart, buf, 0, len);
+}
+#else
+uint16_t uart_read(Uart *uart, uint8_t *buf, uint16_t len)
+{
+    uint16_t n;
+
+    /* Cleared before the read: a gap ending after it still counts */
+    uart->rxIdle = false;
+    n = ring_read(&uart->rxRing, buf, len);
+
+    uart_rtsUpdate(uart);
+    return n;
+}
+#endif
+
+void uart_setTxDoneCallback(Uart *uart, Uart_Callback callback)
+{
+    uart->txDoneCallback = callback;
+}
+
+void uart_setRxHandler(Uart *uart, Uart_RxHandler handler)
+{
+    uart->rxHandler = handler;
+}
+
+void uart_setEventHandler(Uart *uart, Uart_EventHandler handler)
+{
+    uart->eventHandler = handler;
+}
+
+bool uart_setIdleTimeout(Uart *uart, uint16_t bitTimes)
+{
+    if(uart_idleTicks(uart, bitTimes) > UINT32_MAX)
+        return false;
+
+    if(bitTimes == 0)
+    {
+        if(idleOwner == uart)
+        {
+            hal_oneshot_stop();
+            idleOwner = 0;
+        }
+    }
+    else if(idleOwner && idleOwner != uart)
+    {
+        return false;
+    }
+    else
+    {
+        idleOwner = uart;
+    }
+
+    uart->idleBits = bitTimes;
+    uart_idleUpdate(uart);
+    return true;
+}
+
+bool uart_setRxBatch(Uart *uart, uint16_t wakeLevel, uint16_t idleBitTimes)
+{
+    /* Past the high watermark the peer stops and the level never comes */
+    const uint16_t maxLevel = UART_FLOW(uart) ?
+            UART_RTS_HIGH_WATER : UART_RX_RING_SIZE;
+
+    if(wakeLevel == 0 || wakeLevel > maxLevel ||
+       (wakeLevel > 1 && idleBitTimes == 0))
+        return false;
+
+    if(!uart_setIdleTimeout(uart, idleBitTimes))
+        return false;
+
+    uart->rxWakeLevel = wakeLevel;
+    return true;
+}
+
+bool uart_rxBatchReady(const Uart *uart)
+{
+    uint16_t count = ring_count(&uart->rxRing);
+
+    return count >= uart->rxWakeLevel || (uart->rxIdle && count != 0);
+}
+
+void uart_flush(Uart *uart)
+{
+    /* txBusy is tested with interrupts masked so the completion IRQ cannot
+     * slip in between the test and the WFI; it still ends the WFI. */
+    hal_irq_disable();
+    while(uart->txBusy)
+    {
+        hal_sleep();
+        hal_irq_enable();
+        hal_irq_disable();
+    }
+    hal_irq_enable();
+}
+
+/* Counts the errors flagged with one byte. Returns true if the byte is
+ * still to be delivered. */
+RAMFUNC static bool uart_rxError(Uart *uart, uint_fast8_t err)
+{
+    Uart_EventHandler events = uart->eventHandler;
+
+    if(err & HAL_UART_ERR_OE)
+        uart->rxErrors.overrun++;
+
+    /* A break also fails the stop bit: count it once, as a break */
+    if(err & HAL_UART_ERR_BRK)
+    {
+        uart->rxErrors.brk++;
+        if(events)
+            events(UART_EVENT_BREAK);
+        hal_sleepOnExit(false);
+    }
+    else
+    {
+        if(err & HAL_UART_ERR_FE)
+            uart->rxErrors.framing++;
+        if(err & HAL_UART_ERR_PE)
+            uart->rxErrors.parity++;
+    }
+
+    return UART_RX_TAG_ERRORS ||
+           !(err & (HAL_UART_ERR_BRK | HAL_UART_ERR_FE | HAL_UART_ERR_PE));
+}
+
+RAMFUNC static inline bool uart_rxPut(Uart *uart, uint8_t byte,
+                                      uint_fast8_t err)
+{
+#if UART_RX_TAG_ERRORS
+    return ring_space(&uart->rxRing) != 0 &&
+           ring_put(&uart->rxStatusRing, (uint8_t)err) &&
+           ring_put(&uart->rxRing, byte);
+#else
+    (void)err;
+    return ring_put(&uart->rxRing, byte);
+#endif
+}
+
+/* Handler body shared by the eUSCI_A vectors */
+UART_ISR_INLINE void uart_isr(Uart *uart)
+{
+    uint_fast8_t status = hal_uart_pending(uart->hw);
+    Uart_RxHandler handler = uart->rxHandler;
+    uint8_t byte;
+
+    if(status & HAL_UART_RX_FLAG){
+        /* STATW first: reading RXBUF clears it */
+        uint_fast8_t err = hal_uart_rxErrors(uart->hw);
+
+        byte = hal_uart_read(uart->hw);
+        if(uart->idleTicks){
+            hal_oneshot_start(uart->idleTicks);
+        }
+
+        if(err == 0 || uart_rxError(uart, err)){
+            if(handler){
+                handler(byte);
+            }else if(!uart_rxPut(uart, byte, err)){
+                uart->rxDropped++;
+            }
+#if UART_FLOW_CONTROL
+            else if(UART_FLOW(uart) && !uart->rxThrottled &&
+                    ring_count(&uart->rxRing) >= UART_RTS_HIGH_WATER){
+                uart->rxThrottled = true;
+                hal_gpio_high(UART_RTS_PORT, UART_RTS_PIN);
+            }
+#endif
+            /* A full ring is always past the wake level */
+            if(handler){
+                hal_sleepOnExit(false);
+            }else if(ring_count(&uart->rxRing) >= uart->rxWakeLevel){
+                Uart_EventHandler events = uart->eventHandler;
+
+                if(events){
+                    events(UART_EVENT_RX_READY);
+                }
+                hal_sleepOnExit(false);
+            }
+        }
+    }
+
+    if((status & HAL_UART_TX_FLAG) && !UART_TX_HELD(uart)){
+        if(ring_get(&uart->txRing, &byte)){
+            hal_uart_write(uart->hw, byte);
+        }
+#if UART_TX_BLOCKS
+        else if(uart_txBlockGet(uart, &byte)){
+            hal_uart_write(uart->hw, byte);
+        }
+#endif
+        else{
+            /* Last byte is in the shift register: wait for it to finish */
+            hal_uart_txIe(uart->hw, false);
+            hal_uart_txCptClear(uart->hw);
+            hal_uart_txCptIe(uart->hw, true);
+        }
+    }
+
+    if(status & HAL_UART_TXCPT_FLAG){
+        hal_uart_txCptIe(uart->hw, false);
+        uart->txBusy = false;
+        if(uart->txDoneCallback){
+            uart->txDoneCallback();
+        }
+        hal_sleepOnExit(false);
+    }
+}
+
+#if UART_MODULES & (1u << 0)
+/* EUSCI A0 UART ISR */
+RAMFUNC void EUSCIA0_IRQHandler(void)
+{
+    CYCLE_STATS_ISR_ENTER(EUSCIA0);
+    uart_isr(&uartA0);
+    CYCLE_STATS_ISR_EXIT(EUSCIA0);
+}
+#endif
+
+#if UART_MODULES & (1u << 1)
+/* EUSCI A1 UART ISR */
+RAMFUNC void EUSCIA1_IRQHandler(void)
+{
+    CYCLE_STATS_ISR_ENTER(EUSCIA1);
+    uart_isr(&uartA1);
+    CYCLE_STATS_ISR_EXIT(EUSCIA1);
+}
+#endif
+
+#if UART_MODULES & (1u << 2)
+/* EUSCI A2 UART ISR */
+RAMFUNC void EUSCIA2_IRQHandler(void)
+{
+    CYCLE_STATS_ISR_ENTER(EUSCIA2);
+    uart_isr(&uartA2);
+    CYCLE_STATS_ISR_EXIT(EUSCIA2);
+}
+#endif
+
+#if UART_MODULES & (1u << 3)
+/* EUSCI A3 UART ISR */
+RAMFUNC void EUSCIA3_IRQHandler(void)
+{
+    CYCLE_STATS_ISR_ENTER(EUSCIA3);
+    uart_isr(&uartA3);
+    CYCLE_STATS_ISR_EXIT(EUSCIA3);
+}
+#endif
+
+/* Timer32 module 1 ISR - RX line idle */
+RAMFUNC void T32_INT1_IRQHandler(void)
+{
+    Uart *uart = idleOwner;
+    Uart_EventHandler events;
+
+    hal_oneshot_clear();
+    if(!uart){
+        return;
+    }
+
+    uart->rxIdle = true;
+    events = uart->eventHandler;
+    if(events){
+        events(UART_EVENT_IDLE);
+    }
+    hal_sleepOnExit(false);
+}
+
+#if UART_FLOW_CONTROL
+/* CTS falling edge - the peer can take data again */
+RAMFUNC void UART_CTS_IRQ_HANDLER(void)
+{
+    hal_gpio_edgeIe(UART_CTS_PORT, UART_CTS_PIN, false);
+    hal_gpio_edgeClear(UART_CTS_PORT, UART_CTS_PIN);
+
+    if(UART_FLOW_UART.txBusy){
+        hal_uart_txIe(UART_FLOW_UART.hw, true);
+    }
+}
+#endif
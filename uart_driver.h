@@ -0,0 +1,292 @@
+/******************************************************************************
+ * Interrupt-driven eUSCI_A UART driver
+ *
+ * Description: One Uart object per eUSCI_A module (uartA0..uartA3), each
+ * with its own RX/TX rings, callbacks and statistics; UART_MODULES picks
+ * the ones the driver owns. Received bytes are queued into the RX ring by
+ * the ISR; uart_write() queues bytes into the TX ring and the ISR feeds
+ * them to TXBUF on every TXIFG, so the caller never spins on the
+ * transmitter and can sit in LPM0 while a frame is in flight.
+ *
+ * Every EUSCIAx_IRQHandler expands the same handler body with its own
+ * object, so the instance is a constant in each vector: no lookup, and
+ * per-instance options (flow control) fold away where they do not apply.
+ * Enabling another module adds its vector and storage and costs the
+ * others nothing.
+ *
+ * Completion is reported once the last byte has left the shift register
+ * (TXCPTIFG): uart_txBusy() goes false and the optional callback runs in
+ * interrupt context.
+ *
+ * Both RX data and TX completion clear SLEEPONEXIT, so a main loop parked
+ * in LPM0 with sleep-on-ISR-exit runs one more pass after either event.
+ *
+ * RX batching (uart_setRxBatch()): the ISR keeps queueing bytes with the
+ * CPU going back to sleep after each one, and only clears SLEEPONEXIT
+ * once a wake level of bytes is queued or the line has been idle for a
+ * number of bit times. Bursty traffic then costs one main loop pass per
+ * message or per wake level rather than one per byte, and a short
+ * message still gets through within the idle timeout.
+ *
+ * Receive errors: the ISR reads UCAxSTATW with every byte and counts
+ * overruns, framing and parity errors and breaks in rxErrors. A byte
+ * with a framing or parity error, and the NUL of a break, are discarded
+ * unless UART_RX_TAG_ERRORS is set, in which case every byte is queued
+ * and its status goes into rxStatusRing alongside it (see
+ * uart_readStatus()). A byte flagged with an overrun is itself intact: the
+ * one before it was lost.
+ *
+ * Line events go to an optional handler in interrupt context: a break as
+ * it is received, and idle once no byte has arrived for the configured
+ * number of bit times (uart_setIdleTimeout(), timed by Timer32 module 1,
+ * which the driver owns and lends to one instance at a time). Both clear
+ * SLEEPONEXIT.
+ *
+ * Block TX (UART_TX_BLOCKS): uart_writeBlock() lends the driver a whole
+ * buffer instead of copying it into txRing. The TX ISR feeds TXBUF
+ * straight from it once txRing is empty, and hands it back through the
+ * instance's block callback as soon as its last byte is in TXBUF. Blocks
+ * go out in the order they were lent; bytes queued with uart_write() go
+ * ahead of any block still waiting. There must be one producer of blocks
+ * per instance, or producers that cannot preempt each other.
+ *
+ * Optional RTS/CTS flow control (UART_FLOW_CONTROL) on two spare GPIOs
+ * for one instance (UART_FLOW_UART), both active low:
+ *
+ *     RTS (output)   deasserted by the ISR once the RX ring holds
+ *                    UART_RTS_HIGH_WATER bytes, reasserted by uart_read()
+ *                    when it drains below UART_RTS_LOW_WATER. The bytes
+ *                    above the high watermark are headroom for what the
+ *                    peer still sends after seeing RTS go high.
+ *     CTS (input)    checked by the ISR before each byte is fed to TXBUF.
+ *                    While it is high, TXIE stays off and a falling-edge
+ *                    interrupt on the pin restarts the transmitter, so
+ *                    nothing polls. The eUSCI has no CTS of its own: the
+ *                    byte in TXBUF and the one shifting out still go.
+ *
+ * The CTS port interrupt belongs to the driver (UART_CTS_IRQ_HANDLER), so
+ * no other pin on that port may use edge interrupts.
+ *
+ * All hardware access goes through hal.h, so the driver also runs against
+ * the simulated eUSCIs of the host backend.
+ *
+ *******************************************************************************/
+#ifndef UART_DRIVER_H_
+#define UART_DRIVER_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "hal.h"
+#include "ring_buffer.h"
+#include "uart_baud.h"
+
+/* eUSCI_A modules owned by the driver, bit n for EUSCI_An */
+#ifndef UART_MODULES
+#define UART_MODULES        (1u << 2)
+#endif
+
+#define UART_RX_RING_SIZE   256
+#define UART_TX_RING_SIZE   256
+
+#ifndef UART_RX_TAG_ERRORS
+#define UART_RX_TAG_ERRORS  0
+#endif
+
+/* Blocks uart_writeBlock() can queue per instance, a power of two <= 128;
+ * 0 leaves block TX out */
+#ifndef UART_TX_BLOCKS
+#define UART_TX_BLOCKS      0
+#endif
+
+#ifndef UART_FLOW_CONTROL
+#define UART_FLOW_CONTROL   0
+#endif
+
+#define UART_FLOW_UART      uartA2
+#define UART_RTS_PORT       HAL_PORT_P5
+#define UART_RTS_PIN        HAL_PIN0
+#define UART_CTS_PORT       HAL_PORT_P5
+#define UART_CTS_PIN        HAL_PIN1
+#define UART_CTS_IRQ_HANDLER    PORT5_IRQHandler
+
+/* RX ring fill levels that deassert and reassert RTS */
+#define UART_RTS_HIGH_WATER (UART_RX_RING_SIZE - 16)
+#define UART_RTS_LOW_WATER  (UART_RX_RING_SIZE / 2)
+
+/* 8N1 configuration from SMCLK, divisors resolved at compile time */
+#define UART_CONFIG_8N1(smclkHz, baud)                                        \
+{                                                                             \
+        UART_BAUD_BRDIV(smclkHz, baud),                                       \
+        UART_BAUD_BRF(smclkHz, baud),                                         \
+        UART_BAUD_BRS(smclkHz, baud),                                         \
+        UART_BAUD_OS16(smclkHz, baud)                                         \
+}
+
+typedef enum
+{
+    UART_EVENT_BREAK,
+    UART_EVENT_IDLE,
+    UART_EVENT_RX_READY             /* Ring at the wake level, per byte  */
+} Uart_Event;
+
+typedef void (*Uart_Callback)(void);
+typedef void (*Uart_RxHandler)(uint8_t byte);
+typedef void (*Uart_EventHandler)(Uart_Event event);
+
+struct Uart;
+typedef void (*Uart_BlockCallback)(struct Uart *uart, uint8_t *block);
+
+/* Receive error counters. They wrap around: take the difference of two
+ * snapshots as uint16_t and it stays right across the wrap. */
+typedef struct
+{
+    uint16_t overrun;               /* UCOE: the byte before was lost    */
+    uint16_t framing;               /* UCFE: stop bit low                */
+    uint16_t parity;                /* UCPE                              */
+    uint16_t brk;                   /* UCBRK: line low a whole frame     */
+} Uart_RxErrors;
+
+typedef struct Uart
+{
+    Hal_Uart hw;
+
+    RingBuffer rxRing;
+    RingBuffer txRing;
+#if UART_RX_TAG_ERRORS
+    /* HAL_UART_ERR_* status of each byte in rxRing, 0 for a good one */
+    RingBuffer rxStatusRing;
+#endif
+
+    volatile bool txBusy;
+    Uart_Callback txDoneCallback;
+    volatile Uart_RxHandler rxHandler;
+    volatile Uart_EventHandler eventHandler;
+
+#if UART_TX_BLOCKS
+    /* Blocks lent by uart_writeBlock(), head written by the producer and
+     * tail by the TX ISR, as in a RingBuffer */
+    uint8_t *txBlock[UART_TX_BLOCKS];
+    uint16_t txBlockLen[UART_TX_BLOCKS];
+    volatile uint8_t txBlockHead;
+    volatile uint8_t txBlockTail;
+    uint16_t txBlockPos;            /* Next byte of the oldest block     */
+    Uart_BlockCallback txBlockDone;
+#endif
+
+    Hal_UartConfig config;          /* Divisors in use                   */
+    uint16_t idleBits;
+    volatile uint32_t idleTicks;    /* 0: idle timer off                 */
+    volatile uint16_t rxWakeLevel;
+    volatile bool rxIdle;           /* Gap seen since the last read      */
+
+    /* Statistics, wrap-around */
+    volatile uint16_t rxDropped;    /* RX ring full                      */
+    volatile Uart_RxErrors rxErrors;
+#if UART_FLOW_CONTROL
+    volatile bool rxThrottled;      /* RTS deasserted                    */
+    volatile uint16_t ctsStalls;    /* CTS high with data to send        */
+#endif
+} Uart;
+
+extern Uart uartA0;
+extern Uart uartA1;
+extern Uart uartA2;
+extern Uart uartA3;
+
+/* Interrupt handlers of the instances in UART_MODULES, e.g. for
+ * Interrupt_registerInterrupt() */
+extern void EUSCIA0_IRQHandler(void);
+extern void EUSCIA1_IRQHandler(void);
+extern void EUSCIA2_IRQHandler(void);
+extern void EUSCIA3_IRQHandler(void);
+
+/* Configures and enables the module with RX interrupts. Pins must already
+ * be routed to it; the RTS/CTS pins, if enabled, are set up here. */
+extern bool uart_init(Uart *uart, const Hal_UartConfig *config);
+
+/* Recomputes the divisors for baud from the current SMCLK and restarts
+ * the module with them. Any byte in flight is lost. Returns false if the
+ * rate is unreachable, or if the module rejects the divisors, which leaves
+ * it in reset as uart_init() would. The worst-case bit error is returned
+ * through errorPpm if not NULL. */
+extern bool uart_setBaudRate(Uart *uart, uint32_t baud, int32_t *errorPpm);
+
+/* Queues up to len bytes for transmission and starts the transmitter.
+ * Returns the number of bytes accepted, which is less than len when the TX
+ * ring fills up. */
+extern uint16_t uart_write(Uart *uart, const uint8_t *buf, uint16_t len);
+
+/* Starts the transmitter for bytes queued into txRing directly, e.g. by
+ * packet_send(). uart_write() does this itself. */
+extern void uart_startTx(Uart *uart);
+
+#if UART_TX_BLOCKS
+/* Lends len (> 0) bytes at block to the transmitter without copying them
+ * and starts it. The block belongs to the driver until the callback set
+ * with uart_setTxBlockCallback() returns it. Returns false, keeping
+ * nothing, if UART_TX_BLOCKS blocks are already queued. Callable from an
+ * ISR. */
+extern bool uart_writeBlock(Uart *uart, uint8_t *block, uint16_t len);
+
+/* Blocks lent and not yet returned */
+static inline uint8_t uart_txBlocks(const Uart *uart)
+{
+    return (uint8_t)(uart->txBlockHead - uart->txBlockTail);
+}
+
+/* Called from the TX ISR with each block once its last byte is in TXBUF */
+extern void uart_setTxBlockCallback(Uart *uart, Uart_BlockCallback callback);
+#endif
+
+/* Takes up to len received bytes. Returns the number of bytes copied. */
+extern uint16_t uart_read(Uart *uart, uint8_t *buf, uint16_t len);
+
+#if UART_RX_TAG_ERRORS
+/* As uart_read(), also copying each byte's HAL_UART_ERR_* status */
+extern uint16_t uart_readStatus(Uart *uart, uint8_t *buf, uint8_t *status,
+                                uint16_t len);
+#endif
+
+/* True until the last queued byte has been shifted out */
+static inline bool uart_txBusy(const Uart *uart)
+{
+    return uart->txBusy;
+}
+
+/* Called from the ISR when the transmitter goes idle; NULL to disable */
+extern void uart_setTxDoneCallback(Uart *uart, Uart_Callback callback);
+
+/* Hands every received byte to handler from the ISR instead of queueing it
+ * in rxRing, e.g. packet_rxByte(); NULL goes back to the ring */
+extern void uart_setRxHandler(Uart *uart, Uart_RxHandler handler);
+
+/* Receives break, idle and RX wake-level events from the ISRs; NULL to
+ * disable */
+extern void uart_setEventHandler(Uart *uart, Uart_EventHandler handler);
+
+/* Raises UART_EVENT_IDLE after bitTimes bit periods without a received
+ * byte, once per gap; 0 turns the timer off and releases it. Follows
+ * uart_setBaudRate(). Returns false if the timeout does not fit the timer
+ * or another instance holds it. */
+extern bool uart_setIdleTimeout(Uart *uart, uint16_t bitTimes);
+
+/* Wakes the main loop only once wakeLevel bytes are queued or after
+ * idleBitTimes quiet bit periods (uart_setIdleTimeout()). A wake level of
+ * 1 wakes on every byte, the default. Returns false if wakeLevel exceeds
+ * the RX ring (or the RTS high watermark), or if it is above 1 with no
+ * idle timeout to bound the latency. A handler set with
+ * uart_setRxHandler() is still called for, and wakes on, every byte. */
+extern bool uart_setRxBatch(Uart *uart, uint16_t wakeLevel,
+                            uint16_t idleBitTimes);
+
+/* True once the current batch is due: wakeLevel bytes are queued, or the
+ * line went idle with bytes queued since the last uart_read(). For the
+ * main loop's decision to sleep. */
+extern bool uart_rxBatchReady(const Uart *uart);
+
+/* Sleeps in LPM0 until every queued byte has been shifted out. With flow
+ * control this waits for as long as the peer holds CTS high. */
+extern void uart_flush(Uart *uart);
+
+#endif /* UART_DRIVER_H_ */
@@ -0,0 +1,261 @@
+/******************************************************************************
+ * Receive error accounting - host simulation
+ *
+ * Description: Injects RX bytes with HAL_UART_ERR_* status into uartA2
+ * through hal_host_uartInjectError(), loopback off, and checks what the
+ * driver makes of them. One CSV line per case:
+ *
+ *     case,bytes,delivered,overrun,framing,parity,brk,break_events,
+ *     idle_events,host_overruns,errors
+ *
+ * Bytes go in chunks of up to BENCH_CHUNK back to back, each followed by
+ * a quiet line longer than the idle timeout. The counters are the
+ * differences of rxErrors across the case, the events those the handler
+ * saw. Every injected error must be counted once: OE as an overrun, BRK
+ * as a break with one UART_EVENT_BREAK and nothing else, FE and PE as
+ * framing and parity errors; every chunk must end in one UART_EVENT_IDLE.
+ * The ring must hold the bytes without FE, PE or BRK in order or, in a
+ * UART_RX_TAG_ERRORS build, every byte with its status. The "blocked"
+ * case makes real overruns instead: 2 to 4 bytes arrive with interrupts
+ * off, the last one comes out flagged UCOE, the ones before it are lost
+ * (host_overruns counts those) and the driver counts one overrun.
+ * errors counts every count, event and byte that differs and must be 0.
+ *
+ * Host only: the target build sees an empty file. Build and run with
+ * (-DUART_RX_TAG_ERRORS=1 for the tagged variant):
+ *
+ *     cc -std=gnu11 -O2 -I. uart_error_bench.c uart_driver.c uart_baud.c \
+ *        cycle_stats.c hal_host.c -o uart_error_bench
+ *     ./uart_error_bench
+ *
+ *******************************************************************************/
+#ifndef __MSP432P401R__
+
+#include <stdio.h>
+#include <string.h>
+
+#include "uart_driver.h"
+#include "hal.h"
+
+#define BENCH_CLOCK_HZ      24000000
+#define BENCH_BAUD          115200
+#define BENCH_CHUNKS        2000
+
+/* Bytes per chunk, within the host's RX queue */
+#define BENCH_CHUNK         48
+
+#define BENCH_IDLE_BITS     20
+
+/* Errors that discard the byte unless it is tagged */
+#define BENCH_ERR_BAD       (HAL_UART_ERR_BRK | HAL_UART_ERR_FE |            \
+                             HAL_UART_ERR_PE)
+
+typedef enum
+{
+    CASE_CLEAN,
+    CASE_FRAMING,
+    CASE_PARITY,
+    CASE_BREAK,
+    CASE_OVERRUN,
+    CASE_MIXED,
+    CASE_BLOCKED
+} UartErrorBench_Case;
+
+static const char *const caseNames[] = { "clean", "framing", "parity",
+                                         "break", "overrun", "mixed",
+                                         "blocked" };
+
+/* The status a mixed stream draws from */
+static const uint8_t mixed[] =
+{
+    HAL_UART_ERR_FE, HAL_UART_ERR_PE, HAL_UART_ERR_FE | HAL_UART_ERR_PE,
+    HAL_UART_ERR_BRK | HAL_UART_ERR_FE, HAL_UART_ERR_OE,
+    HAL_UART_ERR_OE | HAL_UART_ERR_FE, HAL_UART_ERR_OE | HAL_UART_ERR_PE
+};
+
+#define BENCH_BYTE_TICKS    (BENCH_CLOCK_HZ / BENCH_BAUD * 10)
+
+static uint32_t rng = 0x2545F491;
+
+static uint32_t bench_random(void)
+{
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return rng;
+}
+
+static uint32_t breakEvents;
+static uint32_t idleEvents;
+
+static void bench_event(Uart_Event event)
+{
+    if(event == UART_EVENT_BREAK)
+        breakEvents++;
+    else if(event == UART_EVENT_IDLE)
+        idleEvents++;
+}
+
+/* Counters the case should end on */
+static Uart_RxErrors want;
+
+/* The status of the next byte of a case */
+static uint8_t bench_status(UartErrorBench_Case c)
+{
+    static const uint8_t single[] = { 0, HAL_UART_ERR_FE, HAL_UART_ERR_PE,
+                                      HAL_UART_ERR_BRK | HAL_UART_ERR_FE,
+                                      HAL_UART_ERR_OE };
+
+    if(c == CASE_CLEAN || bench_random() % 4)
+        return 0;
+    if(c == CASE_MIXED)
+        return mixed[bench_random() % sizeof(mixed)];
+    return single[c];
+}
+
+static void bench_count(uint8_t err)
+{
+    if(err & HAL_UART_ERR_OE)
+        want.overrun++;
+    if(err & HAL_UART_ERR_BRK)
+    {
+        want.brk++;
+    }
+    else
+    {
+        if(err & HAL_UART_ERR_FE)
+            want.framing++;
+        if(err & HAL_UART_ERR_PE)
+            want.parity++;
+    }
+}
+
+/* Reads everything queued, counting a mismatch with the expected bytes
+ * as an error. Returns the bytes read. */
+static uint16_t bench_take(const uint8_t *bytes, const uint8_t *status,
+                           uint16_t count, uint32_t *errors)
+{
+    uint8_t buf[BENCH_CHUNK + 1];
+    uint16_t got;
+    uint16_t n;
+
+#if UART_RX_TAG_ERRORS
+    uint8_t st[BENCH_CHUNK + 1];
+
+    got = uart_readStatus(&uartA2, buf, st, sizeof(buf));
+    for(n = 0; n < got; n++)
+        if(n >= count || buf[n] != bytes[n] || st[n] != status[n])
+            break;
+    *errors += n != count || got != count;
+#else
+    uint16_t k = 0;
+
+    got = uart_read(&uartA2, buf, sizeof(buf));
+    for(n = 0; n < count; n++)
+        if(!(status[n] & BENCH_ERR_BAD) && (k >= got || buf[k++] != bytes[n]))
+            break;
+    *errors += n != count || k != got;
+#endif
+
+    return got;
+}
+
+static void bench_run(UartErrorBench_Case c)
+{
+    Uart_RxErrors start = uartA2.rxErrors;
+    uint32_t hostStart = halHostUartStats[HAL_UART_A2].rxOverruns;
+    uint32_t delivered = 0;
+    uint32_t hostLost = 0;
+    uint32_t bytes = 0;
+    uint32_t errors = 0;
+    uint8_t seq = 0;
+    uint32_t chunk;
+
+    memset(&want, 0, sizeof(want));
+    breakEvents = idleEvents = 0;
+
+    for(chunk = 0; chunk < BENCH_CHUNKS; chunk++)
+    {
+        uint8_t value[BENCH_CHUNK];
+        uint8_t status[BENCH_CHUNK];
+        uint16_t count;
+        uint16_t n;
+
+        if(c == CASE_BLOCKED)
+        {
+            /* Nothing read between them: all but the last one are lost */
+            count = (uint16_t)(2 + bench_random() % 3);
+            hal_irq_disable();
+            for(n = 0; n < count; n++)
+                hal_host_uartInject(HAL_UART_A2, seq++);
+            hal_host_run((uint64_t)BENCH_BYTE_TICKS * (count + 1));
+            hal_irq_enable();
+
+            value[0] = (uint8_t)(seq - 1);
+            status[0] = HAL_UART_ERR_OE;
+            bench_count(HAL_UART_ERR_OE);
+            hostLost += count - 1u;
+            bytes += count;
+            count = 1;
+        }
+        else
+        {
+            count = (uint16_t)(1 + bench_random() % BENCH_CHUNK);
+            for(n = 0; n < count; n++)
+            {
+                status[n] = bench_status(c);
+                value[n] = status[n] & HAL_UART_ERR_BRK ? 0 : seq++;
+                bench_count(status[n]);
+                hal_host_uartInjectError(HAL_UART_A2, value[n], status[n]);
+            }
+            bytes += count;
+        }
+
+        /* The rest of the chunk, then a quiet line past the timeout */
+        hal_host_run((uint64_t)BENCH_BYTE_TICKS * (count + 2 +
+                                                   BENCH_IDLE_BITS / 10));
+
+        delivered += bench_take(value, status, count, &errors);
+    }
+
+    errors += (uint16_t)(uartA2.rxErrors.overrun - start.overrun) !=
+              want.overrun;
+    errors += (uint16_t)(uartA2.rxErrors.framing - start.framing) !=
+              want.framing;
+    errors += (uint16_t)(uartA2.rxErrors.parity - start.parity) !=
+              want.parity;
+    errors += (uint16_t)(uartA2.rxErrors.brk - start.brk) != want.brk;
+    errors += breakEvents != want.brk;
+    errors += idleEvents != BENCH_CHUNKS;
+    errors += halHostUartStats[HAL_UART_A2].rxOverruns - hostStart !=
+              hostLost;
+
+    printf("%s,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u\n", caseNames[c], bytes,
+           delivered, (uint16_t)(uartA2.rxErrors.overrun - start.overrun),
+           (uint16_t)(uartA2.rxErrors.framing - start.framing),
+           (uint16_t)(uartA2.rxErrors.parity - start.parity),
+           (uint16_t)(uartA2.rxErrors.brk - start.brk), breakEvents,
+           idleEvents, halHostUartStats[HAL_UART_A2].rxOverruns - hostStart,
+           errors);
+}
+
+int main(void)
+{
+    static const Hal_UartConfig cfg = UART_CONFIG_8N1(BENCH_CLOCK_HZ,
+                                                      BENCH_BAUD);
+    uint_fast8_t c;
+
+    hal_host_uartLoopback(HAL_UART_A2, false);
+    uart_init(&uartA2, &cfg);
+    uart_setEventHandler(&uartA2, bench_event);
+    uart_setIdleTimeout(&uartA2, BENCH_IDLE_BITS);
+
+    printf("case,bytes,delivered,overrun,framing,parity,brk,break_events,"
+           "idle_events,host_overruns,errors\n");
+    for(c = CASE_CLEAN; c <= CASE_BLOCKED; c++)
+        bench_run((UartErrorBench_Case)c);
+
+    return 0;
+}
+
+#endif /* __MSP432P401R__ */
@@ -0,0 +1,177 @@
+/******************************************************************************
+ * RTS/CTS flow control with a slow consumer - host simulation
+ *
+ * Description: Runs uart_driver.c's flow control on UART_FLOW_UART in
+ * loopback, its RTS jumpered to its own CTS, so the transmitter is a peer
+ * that honours RTS. The application keeps the TX ring full and reads the
+ * RX ring chunk bytes at a time, taking three times as long per byte as
+ * the line. One CSV line per rate, chunk and jumper case:
+ *
+ *     baud,chunk,wired,received,throttles,cts_stalls,assert_min,
+ *     assert_max,release_max,peak,dropped,overruns,errors
+ *
+ * Time advances a quarter byte at a time and the RTS pin is sampled at
+ * each step. assert_min and assert_max are the RX ring level the first
+ * time a step sees RTS deasserted, release_max the highest level left by
+ * the uart_read() that asserts it again, peak the highest level seen.
+ * RTS must deassert at UART_RTS_HIGH_WATER, the odd byte later at most,
+ * and assert again only below UART_RTS_LOW_WATER. errors counts bytes
+ * read out of sequence, one per gap. Wired, dropped, overruns and errors
+ * must be 0 and peak must stay short of UART_RX_RING_SIZE. Unwired, CTS
+ * is held asserted and the ring has to drop what the consumer cannot
+ * take: the control case.
+ *
+ * Host only: the target build sees an empty file. Build and run with:
+ *
+ *     cc -std=gnu11 -O2 -I. -DUART_FLOW_CONTROL=1 uart_flow_bench.c \
+ *        uart_driver.c uart_baud.c cycle_stats.c hal_host.c \
+ *        -o uart_flow_bench
+ *     ./uart_flow_bench
+ *
+ *******************************************************************************/
+#ifndef __MSP432P401R__
+
+#include <stdio.h>
+
+#include "uart_driver.h"
+#include "hal.h"
+
+#if !UART_FLOW_CONTROL
+#error "uart_flow_bench.c needs UART_FLOW_CONTROL=1"
+#endif
+
+#define BENCH_CLOCK_HZ      24000000
+#define BENCH_BYTES         50000
+
+/* The consumer's cost per byte, in byte times */
+#define BENCH_SLOWDOWN      3
+
+typedef struct
+{
+    uint32_t baud;
+    uint16_t chunk;                 /* Bytes per uart_read()             */
+    bool     wired;                 /* RTS jumpered to CTS               */
+} UartFlowBench_Case;
+
+static const UartFlowBench_Case cases[] =
+{
+    { 921600, 1, false },           /* First: a jumper stays on          */
+    { 115200, 1, true },
+    { 115200, 32, true },
+    { 921600, 1, true },
+    { 921600, 32, true },
+    { 3000000, 1, true },
+    { 3000000, 32, true },
+};
+
+/* RTS deasserted: the receiver asks the peer to stop */
+#define BENCH_RTS_HIGH()                                                      \
+    ((halHostGpioOut[UART_RTS_PORT] & UART_RTS_PIN) != 0)
+
+/* Byte sequence state, carried from one case to the next */
+static uint8_t sent;
+static uint8_t expect;
+
+static void bench_run(const UartFlowBench_Case *c)
+{
+    const Hal_UartConfig cfg = UART_CONFIG_8N1(BENCH_CLOCK_HZ, c->baud);
+    Uart *uart = &UART_FLOW_UART;
+    uint32_t byteTicks = BENCH_CLOCK_HZ / c->baud * 10;
+    uint32_t step = byteTicks / 4;
+    uint32_t received = 0;
+    uint32_t throttles = 0;
+    uint32_t errors = 0;
+    uint16_t assertMin = UART_RX_RING_SIZE;
+    uint16_t assertMax = 0;
+    uint16_t releaseMax = 0;
+    uint16_t peak = 0;
+    uint64_t readAt = 0;
+    uint32_t overruns = halHostUartStats[uart->hw].rxOverruns;
+    bool rtsHigh = false;
+    uint8_t buf[64];
+
+    uart->rxDropped = 0;
+    uart->ctsStalls = 0;
+    uart_init(uart, &cfg);
+    if(c->wired)
+        hal_host_gpioWire(UART_RTS_PORT, UART_RTS_PIN, UART_CTS_PORT,
+                          UART_CTS_PIN);
+    else
+        hal_host_gpioDrive(UART_CTS_PORT, UART_CTS_PIN, false);
+
+    while(received < BENCH_BYTES)
+    {
+        uint16_t level;
+        uint16_t n;
+
+        n = ring_space(&uart->txRing);
+        if(n > sizeof(buf))
+            n = sizeof(buf);
+        for(level = 0; level < n; level++)
+            buf[level] = (uint8_t)(sent + level);
+        sent = (uint8_t)(sent + uart_write(uart, buf, n));
+
+        hal_host_run(step);
+
+        level = ring_count(&uart->rxRing);
+        if(level > peak)
+            peak = level;
+        if(BENCH_RTS_HIGH() && !rtsHigh)
+        {
+            throttles++;
+            if(level < assertMin)
+                assertMin = level;
+            if(level > assertMax)
+                assertMax = level;
+        }
+        rtsHigh = BENCH_RTS_HIGH();
+
+        /* The consumer, when done with the last chunk */
+        if(hal_host_now() < readAt)
+            continue;
+
+        n = uart_read(uart, buf, c->chunk);
+        for(level = 0; level < n; level++)
+            if(buf[level] != expect++)
+            {
+                errors++;
+                expect = (uint8_t)(buf[level] + 1);
+            }
+        received += n;
+        readAt = hal_host_now() + (uint64_t)n * BENCH_SLOWDOWN * byteTicks;
+
+        if(rtsHigh && !BENCH_RTS_HIGH())
+        {
+            level = ring_count(&uart->rxRing);
+            if(level > releaseMax)
+                releaseMax = level;
+            rtsHigh = false;
+        }
+    }
+
+    printf("%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u\n", c->baud, c->chunk,
+           c->wired, received, throttles, uart->ctsStalls,
+           throttles ? assertMin : 0, assertMax, releaseMax, peak,
+           uart->rxDropped, halHostUartStats[uart->hw].rxOverruns - overruns,
+           errors);
+
+    /* Drain what is still on the way before the next case */
+    do
+        hal_host_run((uint64_t)byteTicks * 4);
+    while(uart_read(uart, buf, sizeof(buf)) || !ring_isEmpty(&uart->txRing));
+    expect = sent;
+}
+
+int main(void)
+{
+    uint_fast8_t n;
+
+    printf("baud,chunk,wired,received,throttles,cts_stalls,assert_min,"
+           "assert_max,release_max,peak,dropped,overruns,errors\n");
+    for(n = 0; n < sizeof(cases) / sizeof(cases[0]); n++)
+        bench_run(&cases[n]);
+
+    return 0;
+}
+
+#endif /* __MSP432P401R__ */
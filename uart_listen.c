@@ -0,0 +1,100 @@
+/******************************************************************************
+ * Low-power listen mode for the eUSCI_A2 UART
+ *
+ * See uart_listen.h. Changing the pin function or the edge select can set
+ * the port flag, so the flag is cleared after the pin is reconfigured and
+ * the pin level checked afterwards: a start bit already under way would
+ * leave no edge to wake on.
+ *
+ *******************************************************************************/
+/* DriverLib Includes */
+#include <ti/devices/msp432p4xx/driverlib/driverlib.h>
+
+#include "uart_listen.h"
+#include "cycle_stats.h"
+
+#define LISTEN_PORT_REGS    P3
+#define LISTEN_PIN          GPIO_PIN2
+#define LISTEN_UART         uartA2
+
+#define LISTEN_SWRST        BITBAND_PERI(EUSCI_A2->CTLW0, EUSCI_A_CTLW0_SWRST_OFS)
+
+void uart_listen_init(void)
+{
+    LISTEN_PORT_REGS->IE &= ~LISTEN_PIN;
+    LISTEN_PORT_REGS->IES |= LISTEN_PIN;
+    LISTEN_PORT_REGS->IFG &= ~LISTEN_PIN;
+
+#if UART_LISTEN_PROBE
+    MAP_GPIO_setOutputLowOnPin(UART_LISTEN_PROBE_PORT, UART_LISTEN_PROBE_PIN);
+    MAP_GPIO_setAsOutputPin(UART_LISTEN_PROBE_PORT, UART_LISTEN_PROBE_PIN);
+#endif
+
+    MAP_Interrupt_enableInterrupt(UART_LISTEN_EDGE_INT);
+}
+
+/* Nothing in flight: no frame on the line either way and no idle timeout
+ * waiting for the MCLK that LPM3 stops */
+static bool uart_listen_idle(void)
+{
+    if(uart_txBusy(&LISTEN_UART) || (EUSCI_A2->STATW & EUSCI_A_STATW_BUSY))
+        return false;
+
+    return LISTEN_UART.idleTicks == 0 || HAL_ONESHOT_REGS->VALUE == 0;
+}
+
+/* Hands P3.2 back to the eUSCI and drops the wake edge */
+static void uart_listen_rearm(void)
+{
+    /* The DCO runs again, SMCLK may not yet be */
+    while(!(CS->STAT & CS_STAT_SMCLK_READY))
+        ;
+
+    LISTEN_PORT_REGS->SEL0 |= LISTEN_PIN;
+    LISTEN_SWRST = 0;
+    hal_uart_rxIe(EUSCI_A2, true);
+
+    LISTEN_PORT_REGS->IE &= ~LISTEN_PIN;
+    LISTEN_PORT_REGS->IFG &= ~LISTEN_PIN;
+    MAP_Interrupt_unpendInterrupt(UART_LISTEN_EDGE_INT);
+
+#if UART_LISTEN_PROBE
+    MAP_GPIO_setOutputLowOnPin(UART_LISTEN_PROBE_PORT, UART_LISTEN_PROBE_PIN);
+#endif
+}
+
+bool uart_listen_sleep(void)
+{
+    bool slept;
+
+    if(!uart_listen_idle())
+        return false;
+
+    /* Reset clears RXIE; rearm sets it again */
+    LISTEN_SWRST = 1;
+    LISTEN_PORT_REGS->SEL0 &= ~LISTEN_PIN;
+    LISTEN_PORT_REGS->IFG &= ~LISTEN_PIN;
+    LISTEN_PORT_REGS->IE |= LISTEN_PIN;
+
+    if(!(LISTEN_PORT_REGS->IN & LISTEN_PIN))
+    {
+        uart_listen_rearm();
+        return false;
+    }
+
+#if UART_LISTEN_PROBE
+    MAP_GPIO_setOutputHighOnPin(UART_LISTEN_PROBE_PORT, UART_LISTEN_PROBE_PIN);
+#endif
+
+#if UART_LISTEN_LPM4
+    slept = MAP_PCM_gotoLPM4();
+#else
+    slept = MAP_PCM_gotoLPM3();
+#endif
+
+    CYCLE_STATS_BEGIN(LISTEN_WAKE);
+    uart_listen_rearm();
+    CYCLE_STATS_END(LISTEN_WAKE);
+
+    return slept;
+}
@@ -0,0 +1,87 @@
+/******************************************************************************
+ * Low-power listen mode for the eUSCI_A2 UART
+ *
+ * Description: Parks the device in LPM3 (or LPM4) while the line is idle
+ * and wakes it on the falling edge of the next start bit on P3.2
+ * (UCA2RXD). LPM0 keeps the DCO and SMCLK running; LPM3 stops both, which
+ * also stops the eUSCI, so it cannot wake the CPU by itself. While
+ * listening the pin is switched to GPIO with a falling-edge port
+ * interrupt and the eUSCI is held in reset.
+ *
+ *     uart_listen_sleep()     eUSCI idle?  -> reset, P3.2 to GPIO, LPM3
+ *     start bit on P3.2       LPM3 exit, DCO restarts with its settings
+ *     back in uart_listen_sleep()
+ *                             SMCLK ready -> P3.2 to UCA2RXD, eUSCI out
+ *                             of reset, RXIE on
+ *
+ * The wake is handled in thread mode, straight after the WFI: the caller
+ * has interrupts masked, so the port interrupt only ends the sleep and is
+ * then cleared without its handler ever running. PORT3 must be enabled in
+ * the NVIC for that, which uart_listen_init() does.
+ *
+ * The first byte: the eUSCI only starts receiving on a falling edge, and
+ * the edge that woke the device is gone by the time it runs again, so the
+ * byte whose start bit ends the sleep is always lost. A sender that may
+ * find the device asleep leads with a 0xFF preamble: its start bit is the
+ * only low period in it, so the eUSCI, ready at any point before the next
+ * start bit, picks up the following byte cleanly. Any other preamble may
+ * come out as a framing error or a stray byte.
+ *
+ * Wake-to-ready latency is the device's LPM3 wake-up time (datasheet)
+ * plus the re-arm in software, from the WFI return to RXIE on. The
+ * software part is the LISTEN_WAKE probe of cycle_stats.h. The whole of
+ * it shows on a scope with UART_LISTEN_PROBE set: the probe pin goes high
+ * as the device parks and low once the eUSCI is ready again, so it is
+ * the time from the RX falling edge to the probe's falling edge.
+ *
+ * Lossless wake needs the eUSCI ready before the start bit following the
+ * preamble, 10 bit times after the edge for back-to-back 8N1 frames, so
+ * the highest rate is
+ *
+ *     baud_max = 10 / t_wake_to_ready
+ *
+ * Conditions: uart_listen_sleep() parks only while the eUSCI is neither
+ * sending nor receiving and the RX idle timer (uart_setIdleTimeout()) is
+ * not counting, and returns false otherwise so the caller can fall back
+ * to LPM0. Other peripherals running from SMCLK or MCLK (Timer_A, SysTick,
+ * the software UARTs) are stopped in LPM3 as well, and the PCM may refuse
+ * the transition while they request their clock. The CPU cycle counter
+ * stops too, so cycle_stats.h does not count LPM3 time as sleep.
+ *
+ *******************************************************************************/
+#ifndef UART_LISTEN_H_
+#define UART_LISTEN_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <ti/devices/msp432p4xx/inc/msp.h>
+
+#include "uart_driver.h"
+
+/* 1: LPM4 instead of LPM3, with the RTC and watchdog stopped too */
+#ifndef UART_LISTEN_LPM4
+#define UART_LISTEN_LPM4            0
+#endif
+
+/* 1: drive UART_LISTEN_PROBE_PORT/PIN high while parked, for a scope */
+#ifndef UART_LISTEN_PROBE
+#define UART_LISTEN_PROBE           0
+#endif
+
+#define UART_LISTEN_PROBE_PORT      GPIO_PORT_P2
+#define UART_LISTEN_PROBE_PIN       GPIO_PIN2
+
+#define UART_LISTEN_EDGE_INT        INT_PORT3
+
+/* Sets up P3.2 for the wake edge and enables PORT3 in the NVIC. Must be
+ * called after uart_init(&uartA2). */
+extern void uart_listen_init(void);
+
+/* With interrupts masked: parks in LPM3 until the next start bit or any
+ * other interrupt, and returns with the eUSCI receiving again. Returns
+ * false at once, without sleeping, if the UART is busy or a start bit
+ * came in while arming, and false if the PCM refused the low-power mode. */
+extern bool uart_listen_sleep(void);
+
+#endif /* UART_LISTEN_H_ */
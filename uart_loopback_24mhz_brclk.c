@@ -37,7 +37,8 @@
  * and interrupts to receive and transmit data. If data is incorrect P1.0 LED
  * is turned ON.
  *
- *  MCLK = HSMCLK = SMCLK = DCO of 24MHz
+ *  MCLK = HSMCLK = DCO of 48MHz, SMCLK = DCO/2 = 24MHz (max-throughput
+ *  clock profile, see clock_profile.h)
  *
  *               MSP432P401
  *             -----------------
@@ -49,95 +50,505 @@
  *            |                 |
  *            |             P1.0|---> LED
  *            |                 |
+ *            |        P6.0/GPIO|----|
+ *            |                 |    |
+ *            |        P6.1/GPIO|----|
+ *            |                 |
+ *            |         P5.0/RTS|----|   (UART_FLOW_CONTROL)
+ *            |                 |    |
+ *            |         P5.1/CTS|----|
+ *            |                 |
  *
  *******************************************************************************/
+#ifdef __MSP432P401R__
 /* DriverLib Includes */
 #include <ti/devices/msp432p4xx/driverlib/driverlib.h>
 #include <ti/devices/msp432p4xx/inc/msp.h>
+#endif
 
 /* Standard Includes */
 #include <stdint.h>
 #include <stdbool.h>
+#include <string.h>
+
+#include "clock_profile.h"
+#include "cycle_stats.h"
+#include "hal.h"
+#include "noinit.h"
+#include "ramfunc.h"
+#include "event_sched.h"
+#include "uart_driver.h"
+
+/* Set to 1 to run the loopback benchmark suite (uart_bench.h) at start-up
+ * instead of the echo demo. Results go out as CSV on the eUSCI at
+ * UART_BAUD, so the host sees them with the TX-RX jumper removed. */
+#ifndef UART_BENCH
+#define UART_BENCH      0
+#endif
+
+/* Set to 1 to park in LPM3 between messages and wake on the start bit of
+ * the next one (uart_listen.h); senders lead with a 0xFF preamble. Target
+ * only. The software UARTs are not started: their timers would hold SMCLK
+ * and keep the device out of LPM3. */
+#if !defined(UART_LISTEN) || !defined(__MSP432P401R__)
+#undef UART_LISTEN
+#define UART_LISTEN     0
+#endif
+
+#if UART_LISTEN
+#include "uart_listen.h"
+#endif
+
+/* Set to a bit rate to also receive on P2.5 with the edge-timestamp
+ * decoder (edge_uart_msp432.h), 0 to leave Timer_A0 and uDMA channel 1
+ * alone. Target only, and not while listening: the capture timer would
+ * hold SMCLK. */
+#if !defined(EDGE_UART_BAUD) || !defined(__MSP432P401R__) || UART_LISTEN
+#undef EDGE_UART_BAUD
+#define EDGE_UART_BAUD  0
+#endif
+
+#if EDGE_UART_BAUD
+#include "edge_uart_msp432.h"
+
+EdgeUart edgeUart;
+#endif
+
+/* Set to a bit rate to also transmit on P3.0 and P3.5..P3.7 from the
+ * DMA-streamed port patterns (pattern_uart_msp432.h), 0 to leave Timer_A3
+ * and uDMA channel 6 alone. Target only, and not while listening. */
+#if !defined(PATTERN_UART_BAUD) || !defined(__MSP432P401R__) || UART_LISTEN
+#undef PATTERN_UART_BAUD
+#define PATTERN_UART_BAUD   0
+#endif
+
+#if PATTERN_UART_BAUD
+#include "pattern_uart_msp432.h"
+
+#define PATTERN_LINES   4
+static const uint8_t patternPins[PATTERN_LINES] = { 0, 5, 6, 7 };
+PatternUart patternUart;
+#endif
+
+#if UART_BENCH
+#include "uart_bench.h"
+#ifndef __MSP432P401R__
+#include <stdio.h>
+#endif
+#endif
+
+uint8_t TXData = 's';
+NOINIT uint8_t data[UART_TX_RING_SIZE];
 
-uint8_t TXData = 1;
-uint8_t RXData = 0;
-uint_fast8_t data[256];
+/* Scheduler events, highest priority first (event_sched.h) */
+enum
+{
+    EVENT_SWUART_RX,        /* Deferred: software UART bytes to check    */
+    EVENT_EDGE_RX,          /* Deferred: edge captures to decode         */
+    EVENT_ECHO              /* Thread: an eUSCI RX batch is due          */
+};
+
+/* The software UARTs need Timer_A and port interrupts, which the host
+ * backend of hal.h does not simulate: a host build runs the eUSCI
+ * loopback only. */
+#ifdef __MSP432P401R__
+#include "gpio_uart_msp432.h"
+#include "irq_priority.h"
+
+/* Software UART on P6.0/P6.1 */
+GpioUart swUart;
+
+/* Multi-channel software UART on port 4 */
+#define MC_CHANNELS     4
+GpioUartMc mcUart;
+#endif
 
 /* UART Configuration Parameter. These are the configuration parameters to
- * make the eUSCI A UART module to operate with a 115200 baud rate. These
- * values were calculated using the online calculator that TI provides
- * at:
- * http://software-dl.ti.com/msp430/msp430_public_sw/mcu/msp430/MSP430BaudRateConverter/index.html
+ * make the eUSCI A UART module to operate with a 115200 baud rate from the
+ * 24MHz SMCLK. The divisors (BRDIV = 13, UCxBRF = 0, UCxBRS = 37) are
+ * worked out at compile time by uart_baud.h; use uart_setBaudRate() to
+ * change the rate at run time.
  */
-const eUSCI_UART_ConfigV1 uartConfig =
-{
-        EUSCI_A_UART_CLOCKSOURCE_SMCLK,          // SMCLK Clock Source
-        13,                                      // BRDIV = 13
-        0,                                       // UCxBRF = 0
-        37,                                      // UCxBRS = 37
-        EUSCI_A_UART_NO_PARITY,                  // No Parity
-        EUSCI_A_UART_LSB_FIRST,                  // LSB First
-        EUSCI_A_UART_ONE_STOP_BIT,               // One stop bit
-        EUSCI_A_UART_MODE,                       // UART mode
-        EUSCI_A_UART_OVERSAMPLING_BAUDRATE_GENERATION,  // Oversampling
-        EUSCI_A_UART_8_BIT_LEN                  // 8 bit data length
+#define UART_SMCLK_HZ   CLOCK_MAX_THROUGHPUT_SMCLK_HZ
+#define UART_BAUD       115200
+
+const Hal_UartConfig uartConfig = UART_CONFIG_8N1(UART_SMCLK_HZ, UART_BAUD);
+
+/* RX batching: the echo loop runs once 64 bytes are queued, or once the
+ * line has been quiet for three characters */
+#define RX_WAKE_LEVEL   64
+#define RX_IDLE_BITS    30
+
+/* CPU cycles per Timer_A tick, to report timer latencies in cycles */
+#define CYCLES_PER_TICK (CLOCK_MAX_THROUGHPUT_MCLK_HZ / UART_SMCLK_HZ)
+
+#if UART_BENCH
+#ifdef __MSP432P401R__
+/* Benchmark driver for the software UART on the P6.0/P6.1 loopback */
+static bool bench_gpioStart(uint32_t baud, uint16_t chunk)
+{
+    uint8_t rx;
+
+    (void)chunk;
+    while(gpio_uart_txBusy(&swUart))
+        ;
+    if(!gpio_uart_msp432_init(&swUart, GPIO_PORT_P6, GPIO_PIN0,
+                              GPIO_PORT_P6, GPIO_PIN1, baud)){
+        return false;
+    }
+    while(gpio_uart_getc(&swUart, &rx))
+        ;
+    return true;
+}
+
+static uint16_t bench_gpioWrite(const uint8_t *buf, uint16_t len)
+{
+    uint16_t n = 0;
+
+    while(n < len && gpio_uart_putc(&swUart, buf[n]))
+        ++n;
+    return n;
+}
+
+static uint16_t bench_gpioRead(uint8_t *buf, uint16_t len)
+{
+    uint16_t n = 0;
+
+    while(n < len && gpio_uart_getc(&swUart, &buf[n]))
+        ++n;
+    return n;
+}
+
+static void bench_gpioIdle(void)
+{
+    hal_irq_disable();
+    if(!swUart.rxFull){
+        hal_sleep();
+    }
+    hal_irq_enable();
+}
+
+static void bench_gpioStop(void)
+{
+    while(gpio_uart_txBusy(&swUart))
+        ;
+}
+
+static const UartBench_Driver benchGpio =
+{
+    "gpio", bench_gpioStart, bench_gpioWrite, bench_gpioRead,
+    bench_gpioIdle, bench_gpioStop
+};
+#endif
+
+static const UartBench_Driver *const benchDrivers[] =
+{
+    &uartBenchPolling,
+    &uartBenchIrq,
+#ifdef __MSP432P401R__
+    &uartBenchDma,
+    &benchGpio,
+#endif
 };
 
+/* Sends one CSV line at UART_BAUD and discards its loopback echo. The
+ * host build prints it instead. */
+static void bench_report(const char *line, uint16_t len)
+{
+#ifdef __MSP432P401R__
+    uint8_t echo[16];
+
+    uart_setBaudRate(&uartA2, UART_BAUD, 0);
+    while(len){
+        uint16_t n = uart_write(&uartA2, (const uint8_t *)line, len);
+        line += n;
+        len -= n;
+        uart_flush(&uartA2);
+    }
+    while(uart_read(&uartA2, echo, sizeof(echo)))
+        ;
+#else
+    uart_setBaudRate(&uartA2, UART_BAUD, 0);
+    fwrite(line, 1, len, stdout);
+    fflush(stdout);
+#endif
+}
+#endif
+
+#if CYCLE_STATS_ENABLE
+/* Sends the statistics of the window just ended, a line at a time */
+static void stats_dump(void)
+{
+    static CycleStats snapshot;
+    char line[CYCLE_STATS_LINE_MAX];
+    uint16_t len;
+
+    cycle_stats_snapshot(&snapshot);
+    for(uint_fast8_t n = 0; n < CYCLE_STATS_LINES; ++n){
+        len = cycle_stats_line(&snapshot, n, line);
+        if(ring_space(&uartA2.txRing) < len){
+            uart_flush(&uartA2);
+        }
+        uart_write(&uartA2, (const uint8_t *)line, len);
+    }
+}
+#endif
+
+/* Echoes whatever has been received since the last pass. The TX ISR
+ * sends it while the core sleeps. */
+static void echo(void)
+{
+    uint16_t len = uart_read(&uartA2, data, ring_space(&uartA2.txRing));
+    uart_write(&uartA2, data, len);
+
+#if CYCLE_STATS_ENABLE
+    if(memchr(data, CYCLE_STATS_DUMP_CMD, len)){
+        stats_dump();
+    }
+#endif
+}
+
+/* eUSCI ISRs: a batch is due at the wake level or once the line idles */
+static void echo_uartEvent(Uart_Event event)
+{
+    if(event != UART_EVENT_BREAK){
+        sched_post(EVENT_ECHO);
+    }
+}
+
+/* TX ISR: the line is free, echo whatever is queued without waiting for
+ * the batch, as the loop did on this wake-up before */
+static void echo_txDone(void)
+{
+    if(!ring_isEmpty(&uartA2.rxRing)){
+        sched_post(EVENT_ECHO);
+    }
+}
+
+/* Hooks the echo to the eUSCI and sends the first byte */
+static void echo_start(void)
+{
+    uart_setRxBatch(&uartA2, RX_WAKE_LEVEL, RX_IDLE_BITS);
+    uart_setEventHandler(&uartA2, echo_uartEvent);
+    uart_setTxDoneCallback(&uartA2, echo_txDone);
+
+    /* The TX ISR has moved it to TXBUF by the time this returns */
+    uart_write(&uartA2, &TXData, 1);
+    CYCLE_STATS_BOOT();
+}
+
+#ifdef __MSP432P401R__
+/* Checks the bytes the software UARTs received, off the bit-timing level */
+static void swuart_rx(void)
+{
+    uint8_t rx;
+
+#if !UART_BENCH
+    if(gpio_uart_getc(&swUart, &rx) && rx != 's'){
+        MAP_GPIO_setOutputHighOnPin(GPIO_PORT_P1, GPIO_PIN0);
+    }
+#endif
+    for(int ch = 0; ch < MC_CHANNELS; ++ch){
+        if(gpio_uart_mc_getc(&mcUart, ch, &rx) && rx != 's'){
+            MAP_GPIO_setOutputHighOnPin(GPIO_PORT_P1, GPIO_PIN0);
+        }
+    }
+}
+#endif
+
+#if EDGE_UART_BAUD
+/* Decodes the captured edges and checks the bytes */
+static void edge_rx(void)
+{
+    uint8_t rx;
+
+    edge_uart_msp432_poll();
+    while(edge_uart_getc(&edgeUart, &rx)){
+        if(rx != 's'){
+            MAP_GPIO_setOutputHighOnPin(GPIO_PORT_P1, GPIO_PIN0);
+        }
+    }
+}
+
+/* DMA and compare ISRs: a poll is due */
+static void edge_ready(void)
+{
+    sched_post(EVENT_EDGE_RX);
+}
+#endif
+
 int main(void)
 {
-    /* Halting WDT  */
-    MAP_WDT_A_holdTimer();
+    /* SystemInit() has held the WDT and brought up the final clocks,
+     * CLOCK_PROFILE_BOOT: MCLK 48MHz for protocol headroom, SMCLK 24MHz.
+     * The eUSCI comes first so the first byte leaves before the rest of
+     * the set-up runs. */
+#if CYCLE_STATS_ENABLE
+    cycle_stats_init();
+#endif
+
+    sched_init();
+    sched_register(EVENT_ECHO, SCHED_THREAD, echo);
+#ifdef __MSP432P401R__
+    sched_register(EVENT_SWUART_RX, SCHED_DEFERRED, swuart_rx);
+#endif
+#if EDGE_UART_BAUD
+    sched_register(EVENT_EDGE_RX, SCHED_DEFERRED, edge_rx);
+#endif
+
+#if UART_FLOW_CONTROL && !defined(__MSP432P401R__)
+    /* The RTS-CTS jumper */
+    hal_host_gpioWire(UART_RTS_PORT, UART_RTS_PIN, UART_CTS_PORT, UART_CTS_PIN);
+#endif
+
+    /* Selecting P3.2 and P3.3 in UART mode, configuring the UART module,
+     * enabling it and its interrupts */
+    hal_gpio_peripheral(HAL_PORT_P3, HAL_PIN2 | HAL_PIN3);
+    uart_init(&uartA2, &uartConfig);
+#if !UART_BENCH
+    echo_start();
+#endif
 
-    /* Selecting P1.2 and P1.3 in UART mode and P1.0 as output (LED) */
-    MAP_GPIO_setAsPeripheralModuleFunctionInputPin(GPIO_PORT_P3,
-             GPIO_PIN2 | GPIO_PIN3, GPIO_PRIMARY_MODULE_FUNCTION);
-    MAP_GPIO_setAsOutputPin(GPIO_PORT_P1, GPIO_PIN0);
-    MAP_GPIO_setOutputLowOnPin(GPIO_PORT_P1, GPIO_PIN0);
+    /* P1.0 as output (LED) */
+    hal_gpio_output(HAL_PORT_P1, HAL_PIN0);
+    hal_gpio_low(HAL_PORT_P1, HAL_PIN0);
     //Set RGB led pins as output
-    MAP_GPIO_setAsOutputPin(GPIO_PORT_P2, GPIO_PIN0);
-    MAP_GPIO_setAsOutputPin(GPIO_PORT_P2, GPIO_PIN1);
-    MAP_GPIO_setAsOutputPin(GPIO_PORT_P2, GPIO_PIN2);
-
-    /* Setting DCO to 24MHz (upping Vcore) */
-    FlashCtl_setWaitState(FLASH_BANK0, 1);
-    FlashCtl_setWaitState(FLASH_BANK1, 1);
-    MAP_PCM_setCoreVoltageLevel(PCM_VCORE1);
-    CS_setDCOCenteredFrequency(CS_DCO_FREQUENCY_24);
-
-    /* Configuring UART Module */
-    MAP_UART_initModule(EUSCI_A2_BASE, &uartConfig);
-
-    /* Enable UART module */
-    MAP_UART_enableModule(EUSCI_A2_BASE);
-
-    /* Enabling interrupts */
-    MAP_UART_enableInterrupt(EUSCI_A2_BASE, EUSCI_A_UART_RECEIVE_INTERRUPT);
-    MAP_Interrupt_enableInterrupt(INT_EUSCIA2);
-    MAP_Interrupt_enableSleepOnIsrExit();
-    MAP_UART_transmitData(EUSCI_A2_BASE, 's');
-    while(1)
-    {
-        for(int i = 0; i < 256; ++i){
-            MAP_UART_transmitData(EUSCI_A2_BASE, data[i]);
-        }
+    hal_gpio_output(HAL_PORT_P2, HAL_PIN0);
+    hal_gpio_output(HAL_PORT_P2, HAL_PIN1);
+    hal_gpio_output(HAL_PORT_P2, HAL_PIN2);
+
+#ifdef __MSP432P401R__
+#if RAMFUNC_ENABLE
+    /* The first registration copies the vector table to .vtable in SRAM and
+     * moves VTOR there; handlers can be swapped at run time from now on */
+    MAP_Interrupt_registerInterrupt(INT_EUSCIA2, EUSCIA2_IRQHandler);
+#endif
+
+    /* Software UART bit timing must not wait behind the eUSCI ISR */
+    irq_priority_init();
+#endif
+
+#if UART_LISTEN
+    uart_listen_init();
+    sched_setIdleHook(uart_listen_sleep);
+#elif defined(__MSP432P401R__)
+    if(!gpio_uart_msp432_init(&swUart, GPIO_PORT_P6, GPIO_PIN0,
+                              GPIO_PORT_P6, GPIO_PIN1, UART_BAUD)){
+        MAP_GPIO_setOutputHighOnPin(GPIO_PORT_P1, GPIO_PIN0);
+    }
+
+    gpio_uart_mc_init(&mcUart);
+    for(int ch = 0; ch < MC_CHANNELS; ++ch){
+        gpio_uart_mc_msp432_addChannel(&mcUart, GPIO_PORT_P4, GPIO_PIN0 << (2 * ch),
+                                       GPIO_PORT_P4, GPIO_PIN1 << (2 * ch));
+    }
+    if(!gpio_uart_mc_msp432_start(9600)){
+        MAP_GPIO_setOutputHighOnPin(GPIO_PORT_P1, GPIO_PIN0);
+    }
+#if EDGE_UART_BAUD
+    if(!edge_uart_msp432_start(&edgeUart, EDGE_UART_BAUD, edge_ready)){
+        MAP_GPIO_setOutputHighOnPin(GPIO_PORT_P1, GPIO_PIN0);
+    }
+#endif
+#if PATTERN_UART_BAUD
+    pattern_uart_init(&patternUart);
+    for(int line = 0; line < PATTERN_LINES; ++line){
+        pattern_uart_addLine(&patternUart, patternPins[line]);
+    }
+    if(!pattern_uart_msp432_start(&patternUart, GPIO_PORT_P3, PATTERN_UART_BAUD)){
+        MAP_GPIO_setOutputHighOnPin(GPIO_PORT_P1, GPIO_PIN0);
+    }
+#endif
+#endif
+
+#if UART_BENCH
+    /* The runs sleep between bytes: a 1 ms SysTick bounds each wait so that
+     * a lost byte ends in a timeout rather than a hang */
+#ifdef __MSP432P401R__
+    MAP_SysTick_setPeriod(SystemCoreClock / 1000);
+    MAP_SysTick_enableInterrupt();
+    MAP_SysTick_enableModule();
+#endif
+    hal_sleepOnExit(false);
+    uart_bench_suite(benchDrivers, sizeof(benchDrivers) / sizeof(benchDrivers[0]),
+                     bench_report);
+#ifdef __MSP432P401R__
+    MAP_SysTick_disableModule();
+    gpio_uart_msp432_init(&swUart, GPIO_PORT_P6, GPIO_PIN0,
+                          GPIO_PORT_P6, GPIO_PIN1, UART_BAUD);
+#endif
+    echo_start();
+#endif
 
-        MAP_Interrupt_enableSleepOnIsrExit();
-        MAP_PCM_gotoLPM0InterruptSafe();
+#if defined(__MSP432P401R__) && !UART_LISTEN
+    gpio_uart_putc(&swUart, 's');
+    for(int ch = 0; ch < MC_CHANNELS; ++ch){
+        gpio_uart_mc_putc(&mcUart, ch, 's');
     }
+#if PATTERN_UART_BAUD
+    for(int line = 0; line < PATTERN_LINES; ++line){
+        pattern_uart_msp432_write(line, &TXData, 1);
+    }
+#endif
+#endif
+
+    /* Everything from here on runs from events; LPM0 in between */
+    sched_run();
 }
-uint_fast16_t i = 0;
-/* EUSCI A0 UART ISR - Echos data back to PC host */
-void EUSCIA2_IRQHandler(void)
+
+#ifdef __MSP432P401R__
+/* Timer_A1 CCR1..6 ISR - software UART bit timing */
+RAMFUNC void TA1_N_IRQHandler(void)
 {
-    uint32_t status = MAP_UART_getEnabledInterruptStatus(EUSCI_A2_BASE);
+    CYCLE_STATS_ISR_ENTER(SWUART_TIMER);
+
+    /* Ticks since the TX compare matched, when it is the one pending */
+    CYCLE_STATS_LATENCY(SWUART_TIMER,
+            GPIO_UART_MSP432_CCR_DUE(GPIO_UART_TX_CCR) ?
+            (uint16_t)(GPIO_UART_TIMER->R -
+                       GPIO_UART_TIMER->CCR[GPIO_UART_TX_CCR]) * CYCLES_PER_TICK : 0);
 
-    if(status & EUSCI_A_UART_RECEIVE_INTERRUPT_FLAG){
-        RXData = MAP_UART_receiveData(EUSCI_A2_BASE);
-        if(i < 256){
-            data[i++] = RXData;
-        }else{
-            MAP_Interrupt_disableSleepOnIsrExit();
+    GPIO_UART_MSP432_TIMER_ISR(&swUart);
+
+#if !UART_BENCH
+    /* The byte is checked in PendSV, off the bit-timing level */
+    if(swUart.rxFull){
+        sched_post(EVENT_SWUART_RX);
+    }
+#endif
+
+    CYCLE_STATS_ISR_EXIT(SWUART_TIMER);
+}
+
+/* Timer_A2 CCR0 ISR - multi-channel software UART tick */
+RAMFUNC void TA2_0_IRQHandler(void)
+{
+    CYCLE_STATS_ISR_ENTER(MC_TICK);
+
+    /* Up mode: the count restarted from 0 at the CCR0 match */
+    CYCLE_STATS_LATENCY(MC_TICK, GPIO_UART_MC_TIMER->R * CYCLES_PER_TICK);
+
+    gpio_uart_mc_tick(&mcUart);
+
+    for(int ch = 0; ch < MC_CHANNELS; ++ch){
+        if(mcUart.rxFull[ch]){
+            sched_post(EVENT_SWUART_RX);
+            break;
         }
     }
 
+    CYCLE_STATS_ISR_EXIT(MC_TICK);
+}
+
+/* Port 6 ISR - software UART start bit */
+RAMFUNC void PORT6_IRQHandler(void)
+{
+    CYCLE_STATS_ISR_ENTER(SWUART_EDGE);
+
+    if(P6->IFG & BIT1){
+        gpio_uart_rxEdgeIsr(&swUart);
+    }
+
+    CYCLE_STATS_ISR_EXIT(SWUART_EDGE);
 }
+#endif